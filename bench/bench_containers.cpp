@@ -0,0 +1,773 @@
+// Compares my_vector / my_segmented_vector / my_soa_vector / my_bitvector / my_array against std::vector /
+// std::array.
+// Usage: bench_containers [--format csv|json] [--filter push_back] [--max-size 1000000]
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "bench_utils.h"
+#include "my_aligned_array.h"
+#include "my_allocators.h"
+#include "my_array.h"
+#include "my_bitvector.h"
+#include "my_compressed_vector.h"
+#include "my_expr.h"
+#include "my_flat_set.h"
+#include "my_segmented_vector.h"
+#include "my_simd.h"
+#include "my_soa_vector.h"
+#include "my_vector.h"
+
+struct blob256 {
+    uint64_t key;
+    char payload[248];
+
+    bool operator<(const blob256& other) const { return key < other.key; }
+};
+
+template <typename T>
+T make_value(size_t i);
+
+template <>
+int make_value<int>(size_t i) {
+    return static_cast<int>(i * 2654435761u);
+}
+
+template <>
+std::string make_value<std::string>(size_t i) {
+    // longer than the small string buffer, so every element owns a heap block
+    return "element-" + std::to_string(i * 2654435761u) + "-payload";
+}
+
+template <>
+blob256 make_value<blob256>(size_t i) {
+    blob256 value;
+    value.key = i * 2654435761u;
+    std::memset(value.payload, static_cast<int>(i & 0xff), sizeof(value.payload));
+    return value;
+}
+
+inline size_t touch(int value) { return static_cast<size_t>(value); }
+inline size_t touch(const std::string& value) { return value.size(); }
+inline size_t touch(const blob256& value) { return value.key; }
+
+template <typename T>
+std::vector<T> make_source(size_t size) {
+    std::vector<T> values;
+    values.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        values.push_back(make_value<T>(i));
+    }
+    return values;
+}
+
+template <typename Vec>
+void bench_vector(bench_report& report, const bench_config& config, const std::string& container,
+                  const std::string& element) {
+    using T = typename Vec::value_type;
+
+    for (size_t size = 10; size <= config.max_size; size *= 10) {
+        if (!config.accepts(size, sizeof(T))) continue;
+
+        const size_t reps = config.reps_for(size);
+        const std::vector<T> source = make_source<T>(size);
+        auto run = [&](const std::string& operation, auto&& sample) {
+            if (config.accepts(container + "/" + element + "/" + operation)) {
+                report.add(container, element, operation, size, measure(reps, sample));
+            }
+        };
+
+        run("push_back", [&] {
+            Vec vec;
+            return time_ns([&] {
+                for (size_t i = 0; i < size; ++i) {
+                    vec.push_back(source[i]);
+                }
+            });
+        });
+
+        run("emplace_back", [&] {
+            Vec vec;
+            return time_ns([&] {
+                for (size_t i = 0; i < size; ++i) {
+                    vec.emplace_back(source[i]);
+                }
+            });
+        });
+
+        // the slowest single push_back, where a reallocation stalls
+        run("push_back_worst", [&] {
+            Vec vec;
+            long long worst = 0;
+            for (size_t i = 0; i < size; ++i) {
+                worst = std::max(worst, time_ns([&] { vec.push_back(source[i]); }));
+            }
+            return worst;
+        });
+
+        run("reserve_push_back", [&] {
+            Vec vec;
+            return time_ns([&] {
+                vec.reserve(size);
+                for (size_t i = 0; i < size; ++i) {
+                    vec.push_back(source[i]);
+                }
+            });
+        });
+
+        if constexpr (requires(Vec& vec) { vec.push_back_unchecked(source[0]); }) {
+            run("reserve_push_back_unchecked", [&] {
+                Vec vec;
+                return time_ns([&] {
+                    vec.reserve(size);
+                    for (size_t i = 0; i < size; ++i) {
+                        vec.push_back_unchecked(source[i]);
+                    }
+                });
+            });
+        }
+
+        if constexpr (requires(Vec& vec) { vec.append_range(source); }) {
+            run("append_range", [&] {
+                Vec vec;
+                return time_ns([&] { vec.append_range(source); });
+            });
+        } else if constexpr (requires(Vec& vec) { vec.insert(vec.end(), source.begin(), source.end()); }) {
+            run("append_range", [&] {
+                Vec vec;
+                return time_ns([&] { vec.insert(vec.end(), source.begin(), source.end()); });
+            });
+        }
+
+        const Vec filled(source.begin(), source.end());
+
+        // the results outlive the timed part, which leaves their destruction out
+        run("copy", [&] {
+            std::unique_ptr<Vec> copy;
+            const long long ns = time_ns([&] { copy = std::make_unique<Vec>(filled); });
+            do_not_optimize(copy->size());
+            return ns;
+        });
+
+        run("move", [&] {
+            Vec from(filled);
+            std::unique_ptr<Vec> to;
+            const long long ns = time_ns([&] { to = std::make_unique<Vec>(std::move(from)); });
+            do_not_optimize(to->size());
+            return ns;
+        });
+
+        run("iterate", [&] {
+            size_t sum = 0;
+            const long long ns = time_ns([&] {
+                for (const T& value : filled) {
+                    sum += touch(value);
+                }
+            });
+            do_not_optimize(sum);
+            return ns;
+        });
+
+        run("sort", [&] {
+            Vec vec(filled);
+            return time_ns([&] { std::sort(vec.begin(), vec.end()); });
+        });
+
+        Vec work(filled);
+        const T extra = make_value<T>(size);
+        const std::pair<const char*, size_t> positions[] = {{"front", 0}, {"middle", size / 2}, {"back", size}};
+        for (const auto& [where, index] : positions) {
+            run(std::string("insert_") + where, [&] {
+                const long long ns = time_ns([&] { work.insert(work.begin() + index, extra); });
+                work.erase(work.begin() + index);
+                return ns;
+            });
+
+            run(std::string("erase_") + where, [&] {
+                work.insert(work.begin() + index, extra);
+                return time_ns([&] { work.erase(work.begin() + index); });
+            });
+        }
+    }
+}
+
+// my_simd kernels at every supported instruction set against the std algorithms,
+// the last element differs so equal/less/find scan the whole range
+template <typename T>
+void bench_simd(bench_report& report, const bench_config& config, const std::string& element) {
+    const std::pair<const char*, my_simd_level> levels[] = {{"my_simd/scalar", my_simd_level::scalar},
+                                                            {"my_simd/sse2", my_simd_level::sse2},
+                                                            {"my_simd/avx2", my_simd_level::avx2},
+                                                            {"my_simd/avx512", my_simd_level::avx512}};
+
+    for (size_t size = 10; size <= config.max_size; size *= 10) {
+        if (!config.accepts(size, 2 * sizeof(T))) continue;
+
+        const size_t reps = config.reps_for(size);
+        std::vector<T> a(size);
+        for (size_t i = 0; i < size; ++i) {
+            a[i] = static_cast<T>(i % 100);
+        }
+        std::vector<T> b(a);
+        b.back() = T(100);
+
+        auto run = [&](const std::string& container, const std::string& operation, auto&& f) {
+            if (config.accepts(container + "/" + element + "/" + operation)) {
+                report.add(container, element, operation, size, measure(reps, [&] {
+                    return time_ns([&] { do_not_optimize(f()); });
+                }));
+            }
+        };
+
+        run("std", "equal", [&] { return std::equal(a.begin(), a.end(), b.begin()); });
+        run("std", "less", [&] { return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end()); });
+        run("std", "find", [&] { return std::find(a.begin(), a.end(), T(100)) - a.begin(); });
+        run("std", "count", [&] { return std::count(a.begin(), a.end(), T(7)); });
+        run("std", "min", [&] { return *std::min_element(a.begin(), a.end()); });
+        run("std", "sum", [&] { return std::accumulate(a.begin(), a.end(), my_simd::sum_t<T>()); });
+        run("std", "dot", [&] { return std::inner_product(a.begin(), a.end(), b.begin(), my_simd::sum_t<T>()); });
+
+        for (const auto& [container, level] : levels) {
+            if (level > my_simd::supported_level()) continue;
+            my_simd::set_level(level);
+
+            run(container, "equal", [&] { return my_simd::equal(a, b); });
+            run(container, "less", [&] { return my_simd::less(a, b); });
+            run(container, "find", [&] { return my_simd::find(a, T(100)) - a.begin(); });
+            run(container, "count", [&] { return my_simd::count(a, T(7)); });
+            run(container, "min", [&] { return my_simd::min(a); });
+            run(container, "sum", [&] { return my_simd::sum(a); });
+            run(container, "dot", [&] { return my_simd::dot(a, b); });
+        }
+        my_simd::set_level(my_simd::supported_level());
+    }
+}
+
+struct trade {
+    int id;
+    long long timestamp;
+    double price;
+    int qty;
+};
+
+// filling and scanning one field of records, stored as rows (my_vector) and as columns (my_soa_vector)
+void bench_soa(bench_report& report, const bench_config& config) {
+    for (size_t size = 10; size <= config.max_size; size *= 10) {
+        if (!config.accepts(size, sizeof(trade))) continue;
+
+        const size_t reps = config.reps_for(size);
+        auto run = [&](const std::string& container, const std::string& operation, auto&& sample) {
+            if (config.accepts(container + "/trade/" + operation)) {
+                report.add(container, "trade", operation, size, measure(reps, sample));
+            }
+        };
+
+        my_vector<trade> rows;
+        my_soa_vector<int, long long, double, int> columns;
+        for (size_t i = 0; i < size; ++i) {
+            const int id = static_cast<int>(i);
+            rows.push_back({id, 1000LL * id, id * 0.25, id % 100});
+            columns.emplace_back(id, 1000LL * id, id * 0.25, id % 100);
+        }
+
+        run("my_vector", "push_back", [&] {
+            my_vector<trade> vec;
+            return time_ns([&] {
+                for (size_t i = 0; i < size; ++i) {
+                    vec.push_back(rows[i]);
+                }
+            });
+        });
+
+        run("my_soa_vector", "push_back", [&] {
+            my_soa_vector<int, long long, double, int> vec;
+            return time_ns([&] {
+                for (size_t i = 0; i < size; ++i) {
+                    const trade& row = rows[i];
+                    vec.emplace_back(row.id, row.timestamp, row.price, row.qty);
+                }
+            });
+        });
+
+        run("my_vector", "sum_price", [&] {
+            double sum = 0;
+            const long long ns = time_ns([&] {
+                for (const trade& row : rows) {
+                    sum += row.price;
+                }
+            });
+            do_not_optimize(sum);
+            return ns;
+        });
+
+        run("my_soa_vector", "sum_price", [&] {
+            double sum = 0;
+            const long long ns = time_ns([&] {
+                for (double price : columns.column<2>()) {
+                    sum += price;
+                }
+            });
+            do_not_optimize(sum);
+            return ns;
+        });
+    }
+}
+
+// bulk queries over packed bits against std::vector<bool>; size counts bits
+void bench_bitvector(bench_report& report, const bench_config& config) {
+    for (size_t size = 1000; size <= config.max_size * 64; size *= 10) {
+        if (!config.accepts(size / 64, sizeof(uint64_t))) continue;
+
+        const size_t reps = config.reps_for(size / 64);
+        auto run = [&](const std::string& container, const std::string& operation, auto&& sample) {
+            if (config.accepts(container + "/bool/" + operation)) {
+                report.add(container, "bool", operation, size, measure(reps, sample));
+            }
+        };
+
+        std::vector<bool> std_a(size);
+        std::vector<bool> std_b(size);
+        my_bitvector<> a(size);
+        my_bitvector<> b(size);
+        for (size_t i = 0; i < size; ++i) {
+            std_a[i] = i % 3 == 0;
+            std_b[i] = i % 5 == 0;
+            a[i] = std_a[i];
+            b[i] = std_b[i];
+        }
+
+        run("std::vector<bool>", "count", [&] {
+            size_t count = 0;
+            const long long ns = time_ns([&] { count = std::count(std_a.begin(), std_a.end(), true); });
+            do_not_optimize(count);
+            return ns;
+        });
+
+        run("my_bitvector", "count", [&] {
+            size_t count = 0;
+            const long long ns = time_ns([&] { count = a.count(); });
+            do_not_optimize(count);
+            return ns;
+        });
+
+        run("std::vector<bool>", "and", [&] {
+            std::vector<bool> result(size);
+            return time_ns([&] {
+                std::transform(std_a.begin(), std_a.end(), std_b.begin(), result.begin(), std::logical_and<>());
+            });
+        });
+
+        run("my_bitvector", "and", [&] {
+            my_bitvector<> result(a);
+            return time_ns([&] { result &= b; });
+        });
+
+        // the only set bit is the last one
+        std::vector<bool> std_last(size);
+        std_last.back() = true;
+        my_bitvector<> last(size);
+        last.set(size - 1);
+
+        run("std::vector<bool>", "find_first", [&] {
+            size_t pos = 0;
+            const long long ns = time_ns([&] {
+                pos = std::find(std_last.begin(), std_last.end(), true) - std_last.begin();
+            });
+            do_not_optimize(pos);
+            return ns;
+        });
+
+        run("my_bitvector", "find_first", [&] {
+            size_t pos = 0;
+            const long long ns = time_ns([&] { pos = last.find_first(); });
+            do_not_optimize(pos);
+            return ns;
+        });
+    }
+}
+
+void bench_flat_set(bench_report& report, const bench_config& config) {
+    for (size_t size = 1000; size <= config.max_size; size *= 10) {
+        if (!config.accepts(size, sizeof(int))) continue;
+
+        const size_t reps = config.reps_for(size);
+        auto run = [&](const std::string& container, const std::string& operation, auto&& sample) {
+            if (config.accepts(container + "/int/" + operation)) {
+                report.add(container, "int", operation, size, measure(reps, sample));
+            }
+        };
+
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(size) * 4);
+        std::vector<int> keys(size);
+        for (int& key : keys) key = dist(rng);
+        std::vector<int> probes(size);
+        for (int& probe : probes) probe = dist(rng);
+
+        run("std::set", "build", [&] {
+            return time_ns([&] {
+                std::set<int> set(keys.begin(), keys.end());
+                do_not_optimize(set);
+            });
+        });
+
+        run("my_flat_set", "build", [&] {
+            return time_ns([&] {
+                my_flat_set<int> set(keys.begin(), keys.end());
+                do_not_optimize(set);
+            });
+        });
+
+        // inserting one key at a time, what insert_range avoids
+        run("my_flat_set", "build_one_by_one", [&] {
+            return time_ns([&] {
+                my_flat_set<int> set;
+                for (int key : keys) set.insert(key);
+                do_not_optimize(set);
+            });
+        });
+
+        const std::set<int> std_set(keys.begin(), keys.end());
+        const my_flat_set<int> flat_set(keys.begin(), keys.end());
+
+        run("std::set", "find", [&] {
+            size_t found = 0;
+            const long long ns = time_ns([&] {
+                for (int probe : probes) found += std_set.count(probe);
+            });
+            do_not_optimize(found);
+            return ns;
+        });
+
+        run("my_flat_set", "find", [&] {
+            size_t found = 0;
+            const long long ns = time_ns([&] {
+                for (int probe : probes) found += flat_set.count(probe);
+            });
+            do_not_optimize(found);
+            return ns;
+        });
+    }
+}
+
+// dot products and a*b+c over many small float vectors, the layout of
+// geometry and feature data; my_array relies on the auto-vectorizer
+template <size_t N>
+void bench_small_vectors(bench_report& report, const bench_config& config) {
+    for (size_t count = 10'000; count <= config.max_size; count *= 10) {
+        if (!config.accepts(count, 3 * N * sizeof(float))) continue;
+
+        const size_t reps = config.reps_for(count * N);
+        const std::string element = "float" + std::to_string(N);
+        auto run = [&](const std::string& container, const std::string& operation, auto&& sample) {
+            if (config.accepts(container + "/" + element + "/" + operation)) {
+                report.add(container, element, operation, count, measure(reps, sample));
+            }
+        };
+
+        auto bench_layout = [&](auto tag, const std::string& container, auto&& dot, auto&& fma) {
+            using Arr = decltype(tag);
+            my_vector<Arr> a(count);
+            my_vector<Arr> b(count);
+            my_vector<Arr> out(count);
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t j = 0; j < N; ++j) {
+                    a[i][j] = static_cast<float>((i + j) % 13);
+                    b[i][j] = static_cast<float>((i * j) % 7);
+                }
+            }
+
+            run(container, "dot", [&] {
+                float total = 0;
+                const long long ns = time_ns([&] {
+                    for (size_t i = 0; i < count; ++i) total += dot(a[i], b[i]);
+                });
+                do_not_optimize(total);
+                return ns;
+            });
+
+            run(container, "fma", [&] {
+                return time_ns([&] {
+                    for (size_t i = 0; i < count; ++i) out[i] = fma(a[i], b[i], out[i]);
+                });
+            });
+        };
+
+        bench_layout(my_array<float, N>(), "my_array",
+                     [](const my_array<float, N>& x, const my_array<float, N>& y) {
+                         float sum = 0;
+                         for (size_t j = 0; j < N; ++j) sum += x[j] * y[j];
+                         return sum;
+                     },
+                     [](const my_array<float, N>& x, const my_array<float, N>& y, const my_array<float, N>& z) {
+                         my_array<float, N> result;
+                         for (size_t j = 0; j < N; ++j) result[j] = x[j] * y[j] + z[j];
+                         return result;
+                     });
+        bench_layout(my_aligned_array<float, N>(), "my_aligned_array",
+                     [](const my_aligned_array<float, N>& x, const my_aligned_array<float, N>& y) { return x.dot(y); },
+                     [](const my_aligned_array<float, N>& x, const my_aligned_array<float, N>& y,
+                        const my_aligned_array<float, N>& z) { return fma(x, y, z); });
+    }
+}
+
+// a = b * c + d and sum(b * c): a temporary vector per operator, a hand-written
+// loop and the fused my_expr evaluation
+void bench_expr(bench_report& report, const bench_config& config) {
+    for (size_t size = 1000; size <= config.max_size; size *= 10) {
+        if (!config.accepts(size, 4 * sizeof(double))) continue;
+
+        const size_t reps = config.reps_for(size);
+        auto run = [&](const std::string& container, const std::string& operation, auto&& sample) {
+            if (config.accepts(container + "/double/" + operation)) {
+                report.add(container, "double", operation, size, measure(reps, sample));
+            }
+        };
+
+        my_vector<double> b(size);
+        my_vector<double> c(size);
+        my_vector<double> d(size);
+        for (size_t i = 0; i < size; ++i) {
+            b[i] = static_cast<double>(i % 100);
+            c[i] = static_cast<double>(i % 7) * 0.5;
+            d[i] = 1.0;
+        }
+        my_vector<double> a(size);
+
+        run("temporaries", "b*c+d", [&] {
+            return time_ns([&] {
+                my_vector<double> product(size);
+                std::transform(b.begin(), b.end(), c.begin(), product.begin(), std::multiplies<>());
+                my_vector<double> result(size);
+                std::transform(product.begin(), product.end(), d.begin(), result.begin(), std::plus<>());
+                a = std::move(result);
+            });
+        });
+
+        run("hand_loop", "b*c+d", [&] {
+            return time_ns([&] {
+                for (size_t i = 0; i < size; ++i) a[i] = b[i] * c[i] + d[i];
+            });
+        });
+
+        run("my_expr", "b*c+d", [&] {
+            return time_ns([&] { a = b * c + d; });
+        });
+
+        run("temporaries", "sum(b*c)", [&] {
+            double total = 0;
+            const long long ns = time_ns([&] {
+                my_vector<double> product(size);
+                std::transform(b.begin(), b.end(), c.begin(), product.begin(), std::multiplies<>());
+                total = my_simd::sum(product);
+            });
+            do_not_optimize(total);
+            return ns;
+        });
+
+        run("my_expr", "sum(b*c)", [&] {
+            double total = 0;
+            const long long ns = time_ns([&] { total = my_expr::sum(b * c); });
+            do_not_optimize(total);
+            return ns;
+        });
+    }
+}
+
+// Sorted ids and timestamps with jitter, the columns my_compressed_vector is
+// meant for: compressing them, summing them, iterating and random reads.
+template <typename T>
+void bench_compressed(bench_report& report, const bench_config& config, const std::string& element) {
+    for (size_t size = 1000; size <= config.max_size; size *= 10) {
+        if (!config.accepts(size, sizeof(T))) continue;
+
+        const size_t reps = config.reps_for(size);
+        auto run = [&](const std::string& container, const std::string& operation, auto&& sample) {
+            if (config.accepts(container + "/" + element + "/" + operation)) {
+                report.add(container, element, operation, size, measure(reps, sample));
+            }
+        };
+
+        std::mt19937_64 rng(size);
+        my_vector<T> plain;
+        plain.reserve(size);
+        T value = static_cast<T>(1'600'000'000);
+        for (size_t i = 0; i < size; ++i) {
+            value = static_cast<T>(value + 1 + rng() % 16);
+            plain.push_back(value);
+        }
+        const my_compressed_vector<T> packed(plain);
+        my_vector<size_t> positions(1000);
+        for (size_t& pos : positions) pos = rng() % size;
+
+        run("my_compressed_vector", "build", [&] {
+            return time_ns([&] {
+                my_compressed_vector<T> built(plain);
+                do_not_optimize(built.memory_bytes());
+            });
+        });
+
+        run("my_vector", "sum", [&] {
+            unsigned long long total = 0;
+            const long long ns = time_ns([&] { total = my_simd::sum(plain); });
+            do_not_optimize(total);
+            return ns;
+        });
+
+        run("my_compressed_vector", "sum", [&] {
+            unsigned long long total = 0;
+            const long long ns = time_ns([&] { packed.for_each([&](T v) { total += v; }); });
+            do_not_optimize(total);
+            return ns;
+        });
+
+        run("my_compressed_vector", "iterate", [&] {
+            unsigned long long total = 0;
+            const long long ns = time_ns([&] {
+                for (T v : packed) total += v;
+            });
+            do_not_optimize(total);
+            return ns;
+        });
+
+        run("my_vector", "random_1000", [&] {
+            unsigned long long total = 0;
+            const long long ns = time_ns([&] {
+                for (size_t pos : positions) total += plain[pos];
+            });
+            do_not_optimize(total);
+            return ns;
+        });
+
+        run("my_compressed_vector", "random_1000", [&] {
+            unsigned long long total = 0;
+            const long long ns = time_ns([&] {
+                for (size_t pos : positions) total += packed[pos];
+            });
+            do_not_optimize(total);
+            return ns;
+        });
+    }
+}
+
+template <typename Arr, size_t N>
+void bench_array_size(bench_report& report, const bench_config& config, const std::string& container,
+                      const std::string& element) {
+    using T = std::remove_reference_t<decltype(std::declval<Arr&>()[0])>;
+
+    const size_t reps = config.reps * 10;
+    auto run = [&](const std::string& operation, auto&& sample) {
+        if (config.accepts(container + "/" + element + "/" + operation)) {
+            report.add(container, element, operation, N, measure(reps, sample));
+        }
+    };
+
+    // heap-allocated, my_array<blob256, 4096> does not fit on every stack
+    auto filled = std::make_unique<Arr>();
+    for (size_t i = 0; i < N; ++i) {
+        (*filled)[i] = make_value<T>(i);
+    }
+    const T value = make_value<T>(N);
+
+    run("fill", [&] {
+        auto arr = std::make_unique<Arr>();
+        return time_ns([&] { arr->fill(value); });
+    });
+
+    run("copy", [&] {
+        auto arr = std::make_unique<Arr>();
+        return time_ns([&] { *arr = *filled; });
+    });
+
+    run("swap", [&] {
+        auto arr = std::make_unique<Arr>(*filled);
+        auto other = std::make_unique<Arr>();
+        return time_ns([&] { arr->swap(*other); });
+    });
+
+    run("iterate", [&] {
+        size_t sum = 0;
+        const long long ns = time_ns([&] {
+            for (const T& item : *filled) {
+                sum += touch(item);
+            }
+        });
+        do_not_optimize(sum);
+        return ns;
+    });
+
+    run("sort", [&] {
+        auto arr = std::make_unique<Arr>(*filled);
+        return time_ns([&] { std::sort(arr->begin(), arr->end()); });
+    });
+}
+
+template <typename T>
+void bench_arrays(bench_report& report, const bench_config& config, const std::string& element) {
+    bench_array_size<my_array<T, 16>, 16>(report, config, "my_array", element);
+    bench_array_size<std::array<T, 16>, 16>(report, config, "std::array", element);
+    bench_array_size<my_array<T, 256>, 256>(report, config, "my_array", element);
+    bench_array_size<std::array<T, 256>, 256>(report, config, "std::array", element);
+    bench_array_size<my_array<T, 4096>, 4096>(report, config, "my_array", element);
+    bench_array_size<std::array<T, 4096>, 4096>(report, config, "std::array", element);
+}
+
+int main(int argc, char* argv[]) {
+    bench_config config;
+    try {
+        if (!config.parse(argc, argv)) {
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    bench_report report(config.format);
+
+    bench_vector<my_vector<int>>(report, config, "my_vector", "int");
+    bench_vector<std::vector<int>>(report, config, "std::vector", "int");
+    bench_vector<my_vector<int, my_malloc_allocator<int>, my_growth_size_class>>(
+        report, config, "my_vector/realloc", "int");
+    bench_vector<my_segmented_vector<int>>(report, config, "my_segmented_vector", "int");
+    bench_vector<my_vector<std::string>>(report, config, "my_vector", "string");
+    bench_vector<std::vector<std::string>>(report, config, "std::vector", "string");
+    bench_vector<my_segmented_vector<std::string>>(report, config, "my_segmented_vector", "string");
+    bench_vector<my_vector<blob256>>(report, config, "my_vector", "blob256");
+    bench_vector<std::vector<blob256>>(report, config, "std::vector", "blob256");
+    bench_vector<my_vector<blob256, my_malloc_allocator<blob256>, my_growth_size_class>>(
+        report, config, "my_vector/realloc", "blob256");
+    bench_vector<my_segmented_vector<blob256>>(report, config, "my_segmented_vector", "blob256");
+
+    bench_soa(report, config);
+    bench_bitvector(report, config);
+    bench_flat_set(report, config);
+
+    bench_expr(report, config);
+
+    bench_compressed<uint32_t>(report, config, "uint32_t");
+    bench_compressed<uint64_t>(report, config, "uint64_t");
+
+    bench_simd<int>(report, config, "int");
+    bench_simd<float>(report, config, "float");
+
+    bench_arrays<int>(report, config, "int");
+    bench_arrays<std::string>(report, config, "string");
+    bench_arrays<blob256>(report, config, "blob256");
+
+    bench_small_vectors<4>(report, config);
+    bench_small_vectors<8>(report, config);
+    bench_small_vectors<16>(report, config);
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Scaling of the my_parallel algorithms from 1 to N threads against the
+// sequential std algorithms, and of building a large vector on N threads.
+// Usage: bench_parallel [--threads 8] [--format csv|json] [--filter sort] [--max-size 10000000]
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "bench_utils.h"
+#include "my_parallel.h"
+#include "my_vector.h"
+
+template <typename T>
+my_vector<T> make_random(size_t size) {
+    std::mt19937_64 rng(size);
+    my_vector<T> values;
+    values.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        values.push_back(static_cast<T>(rng() % 1'000'000'000));
+    }
+    return values;
+}
+
+template <typename T>
+void bench_element(bench_report& report, const bench_config& config, const my_vector<size_t>& thread_counts,
+                   const std::string& element) {
+    for (size_t size = 100'000; size <= config.max_size; size *= 10) {
+        if (!config.accepts(size, 2 * sizeof(T))) continue;
+
+        const size_t reps = config.reps_for(size);
+        const my_vector<T> source = make_random<T>(size);
+        my_vector<T> work(size);
+        my_vector<double> out(size);
+
+        auto run = [&](const std::string& container, const std::string& operation, auto&& f) {
+            if (config.accepts(container + "/" + element + "/" + operation)) {
+                report.add(container, element, operation, size, measure(reps, [&] {
+                    std::copy(source.begin(), source.end(), work.begin());
+                    return time_ns(f);
+                }));
+            }
+        };
+
+        auto heavy = [](T x) { return std::sqrt(static_cast<double>(x)) * 1.5 + 1.0; };
+
+        run("std", "sort", [&] { std::sort(work.begin(), work.end()); });
+        run("std", "transform", [&] { std::transform(work.begin(), work.end(), out.begin(), heavy); });
+        run("std", "reduce", [&] { do_not_optimize(std::accumulate(work.begin(), work.end(), 0.0)); });
+        run("std", "for_each", [&] { std::for_each(work.begin(), work.end(), [](T& x) { x = x / 3 + 1; }); });
+
+        for (size_t threads : thread_counts) {
+            my_thread_pool pool(threads - 1);
+            const std::string container = "my_parallel/" + std::to_string(threads) + "t";
+
+            run(container, "sort", [&] { my_parallel::sort(work, std::less<>{}, 0, pool); });
+            run(container, "transform", [&] { my_parallel::transform(work, out.begin(), heavy, 0, pool); });
+            run(container, "reduce", [&] { do_not_optimize(my_parallel::reduce(work, 0.0, std::plus<>{}, 0, pool)); });
+            run(container, "for_each", [&] {
+                my_parallel::for_each(work, [](T& x) { x = x / 3 + 1; }, 0, pool);
+            });
+        }
+    }
+}
+
+// Building a fresh vector of doubles, whose pages the builder touches first:
+// filled by the calling thread, left uninitialized, and filled in parts on
+// threads of their own, unpinned and pinned to the NUMA nodes.
+void bench_construct(bench_report& report, const bench_config& config, const my_vector<size_t>& thread_counts) {
+    for (size_t size = 100'000; size <= config.max_size; size *= 10) {
+        if (!config.accepts(size, sizeof(double))) continue;
+
+        const size_t reps = config.reps_for(size);
+        auto run = [&](const std::string& container, const std::string& operation, auto&& f) {
+            if (config.accepts(container + "/double/" + operation)) {
+                report.add(container, "double", operation, size, measure(reps, [&] { return time_ns(f); }));
+            }
+        };
+
+        run("my_vector", "construct_fill", [&] {
+            my_vector<double> vec(size, 1.0);
+            do_not_optimize(vec.data());
+        });
+        run("my_vector", "construct_for_overwrite", [&] {
+            my_vector<double> vec(size, my_for_overwrite);
+            do_not_optimize(vec.data());
+        });
+
+        for (size_t threads : thread_counts) {
+            const std::string container = "my_parallel/" + std::to_string(threads) + "t";
+            run(container, "construct_fill", [&] {
+                my_vector<double> vec;
+                my_parallel::resize(vec, size, 1.0, {threads, false});
+                do_not_optimize(vec.data());
+            });
+            run(container, "construct_fill_pinned", [&] {
+                my_vector<double> vec;
+                my_parallel::resize(vec, size, 1.0, {threads, true});
+                do_not_optimize(vec.data());
+            });
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    namespace po = boost::program_options;
+
+    bench_config config;
+    config.max_size = 10'000'000;
+    size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    po::options_description extra("Parallel options");
+    extra.add_options()
+        ("threads", po::value(&max_threads)->default_value(max_threads), "largest thread count, counts double from 1");
+
+    try {
+        if (!config.parse(argc, argv, extra)) {
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    // 1, 2, 4, ... and max_threads itself
+    my_vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    bench_report report(config.format);
+
+    bench_element<int>(report, config, thread_counts, "int");
+    bench_element<double>(report, config, thread_counts, "double");
+    bench_construct(report, config, thread_counts);
+
+    return 0;
+}
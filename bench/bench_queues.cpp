@@ -0,0 +1,195 @@
+// Throughput and latency of my_spsc_queue and my_mpmc_queue against a bounded
+// std::deque behind a mutex.
+// Usage: bench_queues [--threads 4] [--format csv|json] [--filter mpmc] [--max-size 1000000]
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "bench_utils.h"
+#include "my_concurrent_queue.h"
+#include "my_vector.h"
+
+// the baseline: the same interface over a locked std::deque
+template <typename T>
+class mutex_queue {
+private:
+    std::mutex mutex_;
+    std::deque<T> items_;
+    size_t capacity_;
+
+public:
+    explicit mutex_queue(size_t capacity) : capacity_(capacity) {}
+
+    bool try_push(const T& value) { return try_push_n(&value, 1) == 1; }
+    bool try_pop(T& out) { return try_pop_n(&out, 1) == 1; }
+
+    size_t try_push_n(const T* first, size_t n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        n = std::min(n, capacity_ - items_.size());
+        items_.insert(items_.end(), first, first + n);
+        return n;
+    }
+
+    size_t try_pop_n(T* out, size_t n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        n = std::min(n, items_.size());
+        std::move(items_.begin(), items_.begin() + n, out);
+        items_.erase(items_.begin(), items_.begin() + n);
+        return n;
+    }
+};
+
+constexpr size_t queue_capacity = 1024;
+
+// Passes items values from producers to consumers threads, batch at a time;
+// a thread that finds the queue full or empty yields, which matters when
+// there are fewer cores than threads.
+template <typename Queue>
+void transfer(Queue& queue, size_t items, size_t producers, size_t consumers, size_t batch) {
+    std::atomic<size_t> popped{0};
+    my_vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            my_vector<long long> values(batch);
+            const size_t count = items / producers + (p < items % producers ? 1 : 0);
+            for (size_t sent = 0; sent < count;) {
+                const size_t n = std::min(batch, count - sent);
+                for (size_t i = 0; i < n; ++i) values[i] = static_cast<long long>(sent + i);
+                const size_t pushed = batch == 1 ? queue.try_push(values[0]) : queue.try_push_n(values.data(), n);
+                sent += pushed;
+                if (pushed == 0) std::this_thread::yield();
+            }
+        });
+    }
+    for (size_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            my_vector<long long> values(batch);
+            long long sum = 0;
+            while (popped.load(std::memory_order_relaxed) < items) {
+                const size_t n = batch == 1 ? queue.try_pop(values[0]) : queue.try_pop_n(values.data(), batch);
+                for (size_t i = 0; i < n; ++i) sum += values[i];
+                popped.fetch_add(n, std::memory_order_relaxed);
+                if (n == 0) std::this_thread::yield();
+            }
+            do_not_optimize(sum);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// rounds of one value sent to an echo thread and back
+template <typename Queue>
+long long ping_pong(Queue& there, Queue& back, size_t rounds) {
+    std::thread echo([&] {
+        long long value = 0;
+        for (size_t i = 0; i < rounds; ++i) {
+            while (!there.try_pop(value)) std::this_thread::yield();
+            while (!back.try_push(value)) std::this_thread::yield();
+        }
+    });
+    const long long ns = time_ns([&] {
+        long long value = 0;
+        for (size_t i = 0; i < rounds; ++i) {
+            while (!there.try_push(static_cast<long long>(i))) std::this_thread::yield();
+            while (!back.try_pop(value)) std::this_thread::yield();
+        }
+    });
+    echo.join();
+    return ns;
+}
+
+void bench_throughput(bench_report& report, const bench_config& config, const my_vector<size_t>& thread_counts) {
+    for (size_t items = 100'000; items <= config.max_size; items *= 10) {
+        if (!config.accepts(items, sizeof(long long))) continue;
+
+        const size_t reps = config.reps_for(items);
+        auto run = [&](const std::string& container, const std::string& operation, auto&& make_queue,
+                       size_t threads, size_t batch) {
+            if (config.accepts(container + "/long long/" + operation)) {
+                report.add(container, "long long", operation, items, measure(reps, [&] {
+                    auto queue = make_queue();
+                    return time_ns([&] { transfer(*queue, items, threads, threads, batch); });
+                }));
+            }
+        };
+
+        auto mutex = [] { return std::make_unique<mutex_queue<long long>>(queue_capacity); };
+        auto spsc = [] { return std::make_unique<my_spsc_queue<long long, queue_capacity>>(); };
+        auto mpmc = [] { return std::make_unique<my_mpmc_queue<long long, queue_capacity>>(); };
+
+        for (size_t batch : {1, 64}) {
+            const std::string suffix = batch == 1 ? "" : "_batch" + std::to_string(batch);
+            run("mutex+std::deque", "transfer_1p1c" + suffix, mutex, 1, batch);
+            run("my_spsc_queue", "transfer_1p1c" + suffix, spsc, 1, batch);
+            for (size_t threads : thread_counts) {
+                const std::string operation = "transfer_" + std::to_string(threads) + "p" +
+                                              std::to_string(threads) + "c" + suffix;
+                if (threads > 1) {
+                    run("mutex+std::deque", operation, mutex, threads, batch);
+                }
+                run("my_mpmc_queue", operation, mpmc, threads, batch);
+            }
+        }
+    }
+}
+
+void bench_latency(bench_report& report, const bench_config& config) {
+    const size_t rounds = std::min<size_t>(config.max_size, 10'000);
+    auto run = [&](const std::string& container, auto&& make_queue) {
+        if (config.accepts(container + "/long long/round_trip")) {
+            report.add(container, "long long", "round_trip", rounds, measure(config.reps, [&] {
+                auto there = make_queue();
+                auto back = make_queue();
+                return ping_pong(*there, *back, rounds);
+            }));
+        }
+    };
+
+    run("mutex+std::deque", [] { return std::make_unique<mutex_queue<long long>>(queue_capacity); });
+    run("my_spsc_queue", [] { return std::make_unique<my_spsc_queue<long long, queue_capacity>>(); });
+    run("my_mpmc_queue", [] { return std::make_unique<my_mpmc_queue<long long, queue_capacity>>(); });
+}
+
+int main(int argc, char* argv[]) {
+    namespace po = boost::program_options;
+
+    bench_config config;
+    config.max_size = 1'000'000;
+    size_t max_threads = std::max(std::thread::hardware_concurrency() / 2, 1u);
+
+    po::options_description extra("Queue options");
+    extra.add_options()
+        ("threads", po::value(&max_threads)->default_value(max_threads),
+         "largest count of producers, and of consumers, counts double from 1");
+
+    try {
+        if (!config.parse(argc, argv, extra)) {
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    // 1, 2, 4, ... and max_threads itself
+    my_vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    bench_report report(config.format);
+
+    bench_throughput(report, config, thread_counts);
+    bench_latency(report, config);
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "timer.h"
+
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// times a single call of f in nanoseconds
+template <typename F>
+inline long long time_ns(F&& f) {
+    const auto start = get_current_time_fenced();
+    f();
+    const auto finish = get_current_time_fenced();
+    return to_ns(finish - start);
+}
+
+struct bench_stats {
+    size_t reps;
+    long long min_ns;
+    long long median_ns;
+    long long p99_ns;
+};
+
+// sample() is called reps times and returns the duration of one repetition in ns;
+// one extra warm-up call is discarded, it pays for cold caches and for the
+// allocator adapting to the working set (e.g. glibc raising its mmap threshold)
+template <typename Sample>
+inline bench_stats measure(size_t reps, Sample&& sample) {
+    sample();
+
+    std::vector<long long> samples;
+    samples.reserve(reps);
+    for (size_t i = 0; i < reps; ++i) {
+        samples.push_back(sample());
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const size_t p99_rank = (samples.size() * 99 + 99) / 100; // nearest rank, 1-based
+    return {reps, samples.front(), samples[samples.size() / 2], samples[p99_rank - 1]};
+}
+
+struct bench_config {
+    std::string format = "csv";
+    std::string filter;
+    size_t reps = 15;
+    size_t min_reps = 3;
+    size_t max_size = 100'000'000;
+    size_t max_bytes = size_t(512) << 20;
+
+    // parses the common options plus the bench-specific ones in extra;
+    // returns false if the program should exit (--help)
+    bool parse(int argc, char* argv[], const boost::program_options::options_description& extra = {}) {
+        namespace po = boost::program_options;
+
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "show help message")
+            ("format", po::value(&format)->default_value(format), "output format: csv or json")
+            ("filter", po::value(&filter), "run only cases whose name contains this substring")
+            ("reps", po::value(&reps)->default_value(reps), "repetitions per case")
+            ("min-reps", po::value(&min_reps)->default_value(min_reps), "repetitions kept for the largest sizes")
+            ("max-size", po::value(&max_size)->default_value(max_size), "largest element count")
+            ("max-bytes", po::value(&max_bytes)->default_value(max_bytes), "skip sizes whose payload exceeds this");
+        desc.add(extra);
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << '\n';
+            return false;
+        }
+        if (format != "csv" && format != "json") {
+            throw po::validation_error(po::validation_error::invalid_option_value, "format", format);
+        }
+        return true;
+    }
+
+    bool accepts(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    bool accepts(size_t size, size_t element_bytes) const {
+        return size <= max_size && size * element_bytes <= max_bytes;
+    }
+
+    // keeps the total work per case roughly constant for large sizes
+    size_t reps_for(size_t size) const {
+        return std::max(min_reps, std::min(reps, size_t(100'000'000) / std::max<size_t>(size, 1)));
+    }
+};
+
+// prints one row per case as CSV, or a JSON array of objects
+class bench_report {
+private:
+    std::string format_;
+    bool first_ = true;
+
+public:
+    explicit bench_report(std::string format) : format_(std::move(format)) {
+        if (format_ == "csv") {
+            std::cout << "container,element,operation,size,reps,min_ns,median_ns,p99_ns\n";
+        } else {
+            std::cout << "[";
+        }
+    }
+
+    ~bench_report() {
+        if (format_ == "json") {
+            std::cout << "\n]\n";
+        }
+    }
+
+    bench_report(const bench_report&) = delete;
+    bench_report& operator=(const bench_report&) = delete;
+
+    void add(const std::string& container, const std::string& element, const std::string& operation,
+             size_t size, const bench_stats& stats) {
+        if (format_ == "csv") {
+            std::cout << container << ',' << element << ',' << operation << ',' << size << ','
+                      << stats.reps << ',' << stats.min_ns << ',' << stats.median_ns << ','
+                      << stats.p99_ns << '\n';
+        } else {
+            std::cout << (first_ ? "\n" : ",\n")
+                      << "  {\"container\": \"" << container << "\", \"element\": \"" << element
+                      << "\", \"operation\": \"" << operation << "\", \"size\": " << size
+                      << ", \"reps\": " << stats.reps << ", \"min_ns\": " << stats.min_ns
+                      << ", \"median_ns\": " << stats.median_ns << ", \"p99_ns\": " << stats.p99_ns << "}";
+        }
+        std::cout.flush();
+        first_ = false;
+    }
+};
+
+#endif // BENCH_UTILS_H
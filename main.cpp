@@ -3,12 +3,145 @@
 
 #include <iostream>
 #include <array>
+#include <atomic>
 #include <vector>
 #include <algorithm>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <assert.h>
 
+#include "my_aligned_array.h"
+#include "my_allocators.h"
 #include "my_array.h"
+#include "my_bitvector.h"
+#include "my_compressed_vector.h"
+#include "my_concurrent_queue.h"
+#include "my_concurrent_vector.h"
+#include "my_expr.h"
+#include "my_flat_map.h"
+#include "my_flat_set.h"
+#include "my_mapped_vector.h"
+#include "my_mmap_allocator.h"
+#include "my_parallel.h"
+#include "my_ring_buffer.h"
+#include "my_segmented_vector.h"
+#include "my_simd.h"
+#include "my_snapshot.h"
+#include "my_soa_vector.h"
+#include "my_telemetry.h"
 #include "my_vector.h"
+#include "my_small_vector.h"
+
+struct no_default_ctor {
+    int value;
+    explicit no_default_ctor(int v) : value(v) {}
+};
+
+struct live_counter {
+    static inline int alive = 0;
+    int value;
+
+    live_counter(int v = 0) : value(v) { ++alive; }
+    live_counter(const live_counter& other) : value(other.value) { ++alive; }
+    live_counter& operator=(const live_counter&) = default;
+    ~live_counter() { --alive; }
+};
+
+// live_counter for several threads; copies throw once copy_budget runs out
+struct shared_counter {
+    static inline std::atomic<int> alive{0};
+    static inline std::atomic<int> copy_budget{0};
+    char payload[64] = {};
+
+    shared_counter() { ++alive; }
+    shared_counter(const shared_counter&) {
+        if (copy_budget.fetch_sub(1) <= 0) throw std::runtime_error("copy budget exhausted");
+        ++alive;
+    }
+    shared_counter& operator=(const shared_counter&) = default;
+    ~shared_counter() { --alive; }
+};
+
+struct boxed_int {
+    std::unique_ptr<int> ptr;
+    explicit boxed_int(int v) : ptr(std::make_unique<int>(v)) {}
+};
+
+template <>
+struct is_trivially_relocatable<boxed_int> : std::true_type {};
+
+// a number that cannot be negative, built from expression elements
+struct non_negative {
+    static inline int alive = 0;
+    double value;
+
+    non_negative(double v) : value(v) {
+        if (v < 0) throw std::domain_error("negative");
+        ++alive;
+    }
+    non_negative(const non_negative& other) : value(other.value) { ++alive; }
+    non_negative& operator=(const non_negative&) = default;
+    ~non_negative() { --alive; }
+};
+
+struct telemetry_probe {
+    long long a, b;
+};
+
+// constant-evaluated uses of my_vector and my_array, checked with static_assert in main
+consteval int vector_workout() {
+    my_vector<int> v;
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(i);
+    }
+    v.insert(v.begin() + 10, -1);
+    v.emplace(v.begin(), -2);
+    v.erase(v.begin() + 50, v.begin() + 60);
+    v.resize(95, 7);
+    v.shrink_to_fit();
+    const int values[] = {1, 2, 3};
+    v.insert(v.begin() + 1, std::begin(values), std::end(values));
+
+    my_vector<int> copy = v;
+    copy.pop_back();
+    if (copy == v || !(copy < v) || v.at(14) != -1 || v.capacity() < v.size()) {
+        return -1;
+    }
+    my_vector<int> moved = std::move(copy);
+    std::sort(moved.begin(), moved.end());
+    return moved.front() + moved.back() + static_cast<int>(moved.size() + copy.size());
+}
+
+consteval size_t string_workout() {
+    my_vector<std::string> words = {"constant", "evaluation"};
+    words.insert(words.begin() + 1, "time");
+    words.emplace_back(words.front());
+    words.erase(words.begin());
+    words.append_range(my_vector<std::string>(2, "x"));
+    size_t letters = 0;
+    for (const std::string& word : words) {
+        letters += word.size();
+    }
+    return letters * 10 + words.size();
+}
+
+constexpr my_array<unsigned, 16> make_popcounts() {
+    my_array<unsigned, 16> table{};
+    for (unsigned i = 1; i < 16; ++i) {
+        table[i] = table[i / 2] + i % 2;
+    }
+    return table;
+}
+
+constexpr my_array<unsigned, 16> popcounts = make_popcounts();
 
 int main() {
     std::cout << "my_array tests\n";
@@ -87,6 +220,82 @@ int main() {
         std::cout << "algorithm test passed!\n";
     }
 
+    std::cout << "my_aligned_array tests\n";
+    {
+        static_assert(alignof(my_aligned_array<float, 4>) == 16 && alignof(my_aligned_array<float, 8>) == 32);
+        static_assert(alignof(my_aligned_array<float, 16>) == 64 && alignof(my_aligned_array<double, 32>) == 64);
+        static_assert(alignof(my_aligned_array<float, 3>) == 8 && sizeof(my_aligned_array<float, 16>) == 64);
+        static_assert(alignof(my_aligned_array<float, 4, 64>) == 64);
+
+        // every operation against a plain loop, for full registers and a scalar tail
+        auto check = [](auto tag) {
+            using Arr = decltype(tag);
+            using T = typename Arr::value_type;
+            constexpr size_t n = Arr().size();
+            Arr a;
+            Arr b;
+            Arr c;
+            for (size_t i = 0; i < n; ++i) {
+                a[i] = static_cast<T>(i % 7) - 3;
+                b[i] = static_cast<T>(i * 5 % 11) + 1;
+                c[i] = static_cast<T>(i);
+            }
+            assert(reinterpret_cast<uintptr_t>(a.data()) % Arr::alignment == 0);
+
+            const Arr sum = a + b;
+            const Arr difference = a - b;
+            const Arr product = a * b;
+            const Arr quotient = a / b;
+            const Arr scaled = T(2) * a + T(1);
+            const Arr fused = fma(a, b, c);
+            const Arr lower = min(a, b);
+            const Arr upper = max(a, b);
+            T dot = 0;
+            T total = 0;
+            for (size_t i = 0; i < n; ++i) {
+                assert(sum[i] == a[i] + b[i] && difference[i] == a[i] - b[i]);
+                assert(product[i] == a[i] * b[i] && quotient[i] == a[i] / b[i]);
+                assert(scaled[i] == T(2) * a[i] + T(1) && fused[i] == a[i] * b[i] + c[i]);
+                assert(lower[i] == std::min(a[i], b[i]) && upper[i] == std::max(a[i], b[i]));
+                dot += a[i] * b[i];
+                total += a[i];
+            }
+            assert(a.dot(b) == dot && a.sum() == total);
+            assert(a.min() == *std::min_element(a.begin(), a.end()) && b.max() == *std::max_element(b.begin(), b.end()));
+
+            Arr d = a;
+            d += b;
+            d -= b;
+            d *= T(3);
+            d /= T(3);
+            assert(d == a && -(-a) == a);
+            d.swap(c);
+            assert(c == a && d[n - 1] == static_cast<T>(n - 1));
+        };
+        check(my_aligned_array<float, 4>());
+        check(my_aligned_array<float, 8>());
+        check(my_aligned_array<float, 16>());
+        check(my_aligned_array<float, 7>());
+        check(my_aligned_array<double, 5>());
+        check(my_aligned_array<int, 32>());
+        check(my_aligned_array<short, 12>());
+        check(my_aligned_array<float, 4, 64>());
+        std::cout << "arithmetic and reductions test passed!\n";
+
+        const my_aligned_array<float, 4> v = {3, 4};
+        assert(v.norm() == 5.0f && v[2] == 0 && v.at(3) == 0);
+        bool threw = false;
+        try {
+            v.at(4);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+        constexpr my_aligned_array<int, 4> compile_time = my_aligned_array<int, 4>{1, 2, 3, 4} * 2 + 1;
+        static_assert(compile_time.sum() == 24 && compile_time.max() == 9 && compile_time.dot(compile_time) == 164);
+        std::cout << "norm, bounds and constexpr test passed!\n";
+    }
+
     std::cout << "my_vector tests\n";
     {
         my_vector<int> vec1;
@@ -183,6 +392,1338 @@ int main() {
         std::cout << "algorithm test passed!\n";
     }
 
+    {
+        my_vector<no_default_ctor> vec;
+        vec.reserve(8);
+        vec.emplace_back(1);
+        vec.push_back(no_default_ctor(2));
+        vec.emplace(vec.begin(), 0);
+        assert(vec.size() == 3 && vec[0].value == 0 && vec[2].value == 2);
+        std::cout << "non-default-constructible type test passed!\n";
+    }
+
+    {
+        {
+            my_vector<live_counter> vec;
+            vec.reserve(100);
+            assert(live_counter::alive == 0);
+
+            vec.emplace_back(1);
+            vec.emplace_back(2);
+            vec.shrink_to_fit();
+            assert(live_counter::alive == 2);
+
+            vec.insert(vec.begin() + 1, vec[1]); // self-reference
+            assert(live_counter::alive == 3 && vec[1].value == 2);
+
+            vec.erase(vec.begin());
+            assert(live_counter::alive == 2);
+        }
+        assert(live_counter::alive == 0);
+        std::cout << "raw storage lifetime test passed!\n";
+    }
+
+    {
+        static_assert(is_trivially_relocatable_v<int> && !is_trivially_relocatable_v<std::string>);
+
+        my_vector<boxed_int> vec;
+        for (int i = 0; i < 10; ++i) {
+            vec.emplace_back(i);
+        }
+        vec.emplace(vec.begin(), -1);
+        boxed_int extra[] = {boxed_int(100), boxed_int(101)};
+        vec.insert(vec.begin() + 5, std::make_move_iterator(extra), std::make_move_iterator(extra + 2));
+        vec.erase(vec.begin() + 1, vec.begin() + 3);
+        vec.shrink_to_fit();
+
+        assert(vec.size() == 11 && *vec[0].ptr == -1 && *vec[1].ptr == 2);
+        assert(*vec[3].ptr == 100 && *vec[4].ptr == 101 && *vec.back().ptr == 9);
+        std::cout << "trivial relocation test passed!\n";
+    }
+
+    {
+        // istream_iterator can be read only once
+        std::istringstream numbers("1 2 3 4 5");
+        my_vector<int> vec(std::istream_iterator<int>(numbers), std::istream_iterator<int>{});
+        assert(vec.size() == 5 && vec[4] == 5);
+
+        std::istringstream more("7 8");
+        vec.insert_range(vec.begin() + 1, std::ranges::subrange(std::istream_iterator<int>(more),
+                                                                std::istream_iterator<int>{}));
+        assert(vec.size() == 7 && vec[1] == 7 && vec[2] == 8 && vec[3] == 2);
+
+        vec.assign_range(std::views::iota(0, 100));
+        assert(vec.size() == 100 && vec.capacity() == 100 && vec[99] == 99);
+        vec.append_range(std::views::iota(100, 150) | std::views::transform([](int x) { return -x; }));
+        assert(vec.size() == 150 && vec[149] == -149 && vec.capacity() == 200);
+
+        vec.reserve(vec.size() + 50);
+        for (int i = 0; i < 50; ++i) {
+            vec.push_back_unchecked(i);
+        }
+        assert(vec.size() == 200 && vec.back() == 49);
+
+        const std::list<std::string> words = {"ucu", "apps"};
+        my_vector<std::string> strs = {"pok", "acs", "os"};
+        strs.insert_range(strs.begin() + 1, words);
+        strs.reserve(strs.size() + 1);
+        strs.emplace_back_unchecked("cs");
+        assert(strs.size() == 6 && strs[1] == "ucu" && strs[3] == "acs" && strs.back() == "cs");
+        std::cout << "range insertion test passed!\n";
+    }
+
+    {
+        my_vector<int> nums(100);
+        std::iota(nums.begin(), nums.end(), 0);
+        assert(erase_if(nums, [](int x) { return x % 3 == 0; }) == 34 && nums.size() == 66);
+        assert(nums[0] == 1 && nums[1] == 2 && nums[2] == 4 && nums.back() == 98);
+        assert(erase(nums, 4) == 1 && erase(nums, 3) == 0 && nums[2] == 5);
+
+        const my_vector<size_t> positions = {0, 2, 2, 10, 64};
+        assert(nums.erase_indices(positions) == 4 && nums.size() == 61);
+        assert(nums[0] == 2 && nums[1] == 7 && nums[8] == 19 && nums.back() == 97);
+        bool threw = false;
+        try {
+            nums.erase_indices(std::vector<int>{5, 3});
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw && nums.size() == 61 && nums.erase_indices(std::vector<int>{}) == 0);
+
+        assert(*nums.unstable_erase(nums.begin()) == 97 && nums.size() == 60 && nums[1] == 7);
+        assert(nums.unstable_erase(nums.end() - 1) == nums.end());
+
+        const int alive = live_counter::alive;
+        my_vector<live_counter> counters;
+        my_vector<boxed_int> boxes;
+        for (int i = 0; i < 20; ++i) {
+            counters.emplace_back(i);
+            boxes.emplace_back(i);
+        }
+        assert(counters.erase_indices(std::array{1, 5, 19}) == 3 && live_counter::alive == alive + 17);
+        assert(boxes.erase_indices(std::array{0, 5, 6}) == 3 && *boxes[0].ptr == 1 && *boxes[4].ptr == 7);
+        assert(counters[1].value == 2 && counters[4].value == 6 && counters.back().value == 18);
+        erase_if(counters, [](const live_counter& c) { return c.value > 10; });
+        counters.unstable_erase(counters.begin() + 2);
+        assert(counters.size() == 8 && counters[2].value == 10 && live_counter::alive == alive + 8);
+        std::cout << "batch erase test passed!\n";
+    }
+
+    std::cout << "my_small_vector tests\n";
+    {
+        my_small_vector<int, 4> vec = {1, 2, 3};
+        assert(vec.is_inline() && vec.capacity() == 4);
+
+        vec.push_back(4);
+        assert(vec.is_inline());
+        vec.emplace_back(5);
+        assert(!vec.is_inline() && vec.size() == 5 && vec[4] == 5);
+
+        vec.erase(vec.begin(), vec.begin() + 2);
+        vec.shrink_to_fit();
+        assert(vec.is_inline() && vec.size() == 3 && vec[0] == 3 && vec[2] == 5);
+
+        vec.insert(vec.begin() + 1, 314);
+        assert(vec[1] == 314 && vec.size() == 4);
+        std::cout << "inline storage and spill test passed!\n";
+    }
+
+    {
+        my_small_vector<std::string, 2> small = {"pok"};
+        my_small_vector<std::string, 2> big = {"acs", "os", "apps"};
+
+        small.swap(big);
+        assert(small.size() == 3 && small[2] == "apps" && big.size() == 1 && big[0] == "pok");
+
+        my_small_vector<std::string, 2> moved(std::move(small));
+        assert(moved.size() == 3 && small.is_empty() && small.is_inline());
+
+        my_small_vector<std::string, 2> copy = big;
+        big = std::move(moved);
+        assert((copy == my_small_vector<std::string, 2>{"pok"}) && big.size() == 3 && big[0] == "acs");
+
+        // moves only steal buffers between allocators that can free them
+        static_assert(std::is_nothrow_move_assignable_v<my_small_vector<std::string, 2>>);
+        static_assert(!std::is_nothrow_move_assignable_v<pmr::my_small_vector<std::string, 2>>);
+
+        // a throwing copy assignment leaves the target as it was
+        my_small_vector<shared_counter, 2> source(3);
+        my_small_vector<shared_counter, 2> target(1);
+        shared_counter::copy_budget = 1;
+        bool threw = false;
+        try {
+            target = source;
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        shared_counter::copy_budget = 0;
+        assert(threw && target.size() == 1 && source.size() == 3);
+        std::cout << "copy/move/swap test passed!\n";
+    }
+
+    {
+        my_small_vector<int, 8, std::allocator<int>, my_growth_one_and_half> vec = {1, 2, 3};
+        vec.insert(vec.begin() + 1, vec.begin(), vec.begin() + 2); // in place, from itself
+        assert((vec == my_small_vector<int, 8, std::allocator<int>, my_growth_one_and_half>{1, 1, 2, 2, 3}));
+        vec.insert(vec.end(), vec.begin(), vec.end()); // spills, from itself
+        assert(vec.size() == 10 && vec.capacity() == 12 && vec[5] == 1 && vec[9] == 3);
+        std::cout << "self insertion and growth policy test passed!\n";
+    }
+
+    {
+        // istream_iterator can be read only once
+        std::istringstream numbers("1 2 3 4 5 6");
+        my_small_vector<int, 4> vec(std::istream_iterator<int>(numbers), std::istream_iterator<int>{});
+        assert((vec == my_small_vector<int, 4>{1, 2, 3, 4, 5, 6}) && !vec.is_inline());
+
+        std::istringstream more("7 8");
+        vec.insert(vec.begin() + 1, std::istream_iterator<int>(more), std::istream_iterator<int>{});
+        assert(vec.size() == 8 && vec[1] == 7 && vec[2] == 8 && vec[3] == 2 && vec[7] == 6);
+
+        vec.append_range(std::views::iota(9, 12));
+        vec.insert_range(vec.begin(), std::views::iota(0, 1));
+        assert(vec.size() == 12 && vec[0] == 0 && vec[11] == 11);
+        std::cout << "input range insertion test passed!\n";
+    }
+
+    std::cout << "allocator tests\n";
+    {
+        my_arena arena(256);
+        for (int batch = 0; batch < 3; ++batch) {
+            for (int i = 0; i < 100; ++i) {
+                my_vector<int, my_arena_allocator<int>> vec{my_arena_allocator<int>(arena)};
+                for (int j = 0; j < i; ++j) {
+                    vec.push_back(j);
+                }
+                assert(vec.size() == static_cast<size_t>(i) && (i == 0 || vec.back() == i - 1));
+            }
+            arena.reset();
+        }
+        std::cout << "arena allocator test passed!\n";
+    }
+
+    {
+        my_pool pool;
+        my_vector<my_vector<int, my_pool_allocator<int>>, my_pool_allocator<my_vector<int, my_pool_allocator<int>>>>
+            nested{my_pool_allocator<int>(pool)};
+        for (int i = 0; i < 50; ++i) {
+            nested.emplace_back(static_cast<size_t>(i), i, my_pool_allocator<int>(pool));
+        }
+        assert(nested.size() == 50 && nested[49].size() == 49 && nested[49][0] == 49);
+        std::cout << "pool allocator test passed!\n";
+    }
+
+    {
+        my_arena arena;
+        pmr::my_vector<std::pmr::string> vec(&arena);
+        vec.emplace_back("a string long enough to skip the small string buffer");
+        vec.push_back(vec[0]);
+        assert(vec.get_allocator().resource() == &arena);
+        assert(vec[1].get_allocator().resource() == &arena);
+
+        pmr::my_small_vector<int, 2> small(&arena);
+        small = {1, 2, 3};
+        assert(!small.is_inline() && small.get_allocator().resource() == &arena);
+        std::cout << "pmr test passed!\n";
+    }
+
+    std::cout << "growth policy tests\n";
+    {
+        static_assert(my_growth_double::next_capacity(8, 9, 4) == 16);
+        static_assert(my_growth_one_and_half::next_capacity(8, 9, 4) == 12);
+        static_assert(my_good_malloc_size(100) == 112 && my_good_malloc_size(300) == 320);
+        static_assert(my_growth_size_class::next_capacity(100, 101, 4) == 160);
+
+        my_vector<int, std::allocator<int>, my_growth_one_and_half> vec;
+        for (int i = 0; i < 20; ++i) {
+            vec.push_back(i);
+        }
+        assert(vec.size() == 20 && vec.capacity() < 40 && vec[19] == 19);
+        std::cout << "growth policy test passed!\n";
+    }
+
+    {
+        my_vector<int, my_malloc_allocator<int>, my_growth_size_class> vec;
+        for (int i = 0; i < 100000; ++i) {
+            vec.push_back(vec.is_empty() ? 0 : vec.back() + 1); // self-reference across realloc
+        }
+        assert(vec.size() == 100000 && vec[99999] == 99999 && vec.capacity() >= vec.size());
+
+        const int head[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        vec.insert(vec.end(), head, head + 10);
+        vec.resize(200000, 7);
+        vec.shrink_to_fit();
+        assert(vec[100005] == 5 && vec.back() == 7 && vec.capacity() >= 200000);
+
+        vec.resize(1000);
+        vec.shrink_to_fit();
+        vec.insert(vec.end(), vec.begin(), vec.end()); // self-insert across realloc
+        vec.insert(vec.begin() + 1, vec.begin(), vec.begin() + 3);
+        assert(vec.size() == 2003 && vec[1] == 0 && vec[3] == 2 && vec[4] == 1 && vec[1003 + 999] == 999);
+        std::cout << "realloc growth test passed!\n";
+    }
+
+    {
+        my_mmap_options options;
+        options.threshold = 64 * 1024;
+        my_vector<float, my_mmap_allocator<float>> vec{my_mmap_allocator<float>(options)};
+
+        for (int i = 0; i < 1000000; ++i) {
+            vec.push_back(static_cast<float>(i));
+        }
+        assert(vec.size() == 1000000 && vec[999999] == 999999.0f);
+
+        const size_t capacity = vec.capacity();
+        vec.clear();
+        assert(vec.capacity() == capacity);
+        vec.resize(100, 1.0f);
+        vec.shrink_to_fit();
+        assert(vec.size() == 100 && vec.back() == 1.0f);
+
+        options.threshold = 0;
+        my_vector<std::string, my_mmap_allocator<std::string>> strings{my_mmap_allocator<std::string>(options)};
+        strings.resize(5000, "pok");
+        strings.clear();
+        strings.push_back("acs");
+        assert(strings.size() == 1 && strings[0] == "acs");
+
+        // MAP_HUGETLB blocks are trimmed, resized, released and unmapped in
+        // whole huge pages; without a reserved pool they use normal pages
+        const auto free_huge_pages = [] {
+            std::ifstream meminfo("/proc/meminfo");
+            std::string line;
+            while (std::getline(meminfo, line)) {
+                if (line.starts_with("HugePages_Free:")) {
+                    return std::stol(line.substr(15));
+                }
+            }
+            return 0L;
+        };
+        const long huge_pages_before = free_huge_pages();
+        {
+            struct triple {
+                int64_t a, b, c;
+            };
+            options.threshold = 64 * 1024;
+            options.explicit_huge_pages = true;
+            my_vector<triple, my_mmap_allocator<triple>> triples{my_mmap_allocator<triple>(options)};
+            triples.resize(100000, triple{1, 2, 3});
+            triples.resize(200000, triple{4, 5, 6});
+            assert(triples[99999].c == 3 && triples.back().a == 4);
+            triples.clear();
+            triples.resize(10, triple{7, 8, 9});
+            triples.shrink_to_fit();
+            assert(triples.size() == 10 && triples[9].b == 8);
+        }
+        assert(free_huge_pages() == huge_pages_before);
+        std::cout << "mmap allocator test passed!\n";
+    }
+
+    {
+        my_vector<double> buffer(1000, my_for_overwrite);
+        assert(buffer.size() == 1000);
+        std::iota(buffer.begin(), buffer.end(), 0.0);
+        buffer.resize_default_init(2000);
+        assert(buffer.size() == 2000 && buffer[999] == 999.0);
+        buffer.resize_default_init(10);
+        assert(buffer.size() == 10 && buffer[9] == 9.0);
+
+        // class types are default-constructed as usual
+        my_vector<std::string> names(3, my_for_overwrite);
+        assert(names.size() == 3 && names[2].empty());
+
+        // and through the allocator, which hands a pmr resource down to them
+        std::pmr::monotonic_buffer_resource arena;
+        pmr::my_vector<std::pmr::string> arena_names(2, my_for_overwrite, &arena);
+        arena_names.resize_default_init(4);
+        assert(arena_names.size() == 4 && arena_names[3].get_allocator().resource() == &arena);
+        std::cout << "for_overwrite and default-init resize test passed!\n";
+    }
+
+    std::cout << "my_mapped_vector tests\n";
+    {
+        struct record {
+            uint64_t id;
+            double price;
+        };
+        const std::string path = (std::filesystem::temp_directory_path() / "my_mapped_vector_test.bin").string();
+        std::filesystem::remove(path);
+
+        {
+            my_mapped_vector<record> vec(path);
+            assert(vec.is_empty());
+            for (uint64_t i = 0; i < 10000; ++i) {
+                vec.push_back({i, i * 0.5});
+            }
+            vec.shrink_to_fit();
+            vec.sync();
+        }
+
+        {
+            my_mapped_vector<record> vec(path);
+            assert(vec.size() == 10000 && vec[9999].id == 9999 && vec[10].price == 5.0);
+            vec.emplace_back(record{10000, 1.0});
+            assert(vec.back().id == 10000);
+        }
+
+        try {
+            my_mapped_vector<int> wrong(path);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+
+        // a grow cut short between ftruncate and the header update
+        const auto file_bytes = std::filesystem::file_size(path);
+        std::filesystem::resize_file(path, file_bytes + 10 * sizeof(record) + 3);
+        {
+            my_mapped_vector<record> vec(path);
+            assert(vec.size() == 10001 && vec.capacity() == (file_bytes + 10 * sizeof(record) + 3 - 64) / sizeof(record));
+            assert(vec.back().id == 10000);
+            bool threw = false;
+            try {
+                vec.reserve(std::numeric_limits<size_t>::max() / 8);
+            } catch (const std::length_error&) {
+                threw = true;
+            }
+            assert(threw && vec.size() == 10001);
+        }
+
+        std::filesystem::remove(path);
+        std::cout << "persistence test passed!\n";
+    }
+
+    std::cout << "my_simd tests\n";
+    {
+        const my_simd_level levels[] = {my_simd_level::scalar, my_simd_level::sse2, my_simd_level::avx2,
+                                        my_simd_level::avx512};
+        const my_simd_level supported = my_simd::set_level(my_simd::supported_level());
+
+        // sizes around the vector widths and the unrolled block of four vectors
+        for (size_t size : {0, 1, 7, 15, 16, 17, 63, 64, 65, 127, 300, 1000}) {
+            my_vector<int8_t> bytes;
+            my_vector<int> ints;
+            my_vector<double> doubles;
+            for (size_t i = 0; i < size; ++i) {
+                bytes.push_back(static_cast<int8_t>(i % 7) - 3);
+                ints.push_back(static_cast<int>(i * 37 % 101));
+                doubles.push_back(static_cast<double>(i % 11));
+            }
+
+            for (my_simd_level level : levels) {
+                my_simd::set_level(level);
+
+                my_vector<int> other(ints);
+                assert(other == ints && !(other < ints));
+                if (size > 0) {
+                    ++other[size / 2];
+                    assert(other != ints && ints < other);
+                    assert(my_simd::mismatch(ints.data(), other.data(), size) == size / 2);
+                }
+
+                assert(my_simd::find(ints, 100) == std::find(ints.begin(), ints.end(), 100));
+                assert(my_simd::count(bytes, int8_t(-3)) ==
+                       static_cast<size_t>(std::count(bytes.begin(), bytes.end(), -3)));
+                assert(my_simd::count(doubles, 4.0) ==
+                       static_cast<size_t>(std::count(doubles.begin(), doubles.end(), 4.0)));
+
+                long long sum = 0;
+                long long dot = 0;
+                for (size_t i = 0; i < size; ++i) {
+                    sum += bytes[i];
+                    dot += static_cast<long long>(ints[i]) * ints[i];
+                }
+                assert(my_simd::sum(bytes) == sum && my_simd::dot(ints, ints) == dot);
+                assert(my_simd::sum(doubles) == std::accumulate(doubles.begin(), doubles.end(), 0.0));
+
+                size_t bits = 0;
+                for (int value : ints) {
+                    bits += static_cast<size_t>(std::popcount(static_cast<unsigned>(value)));
+                }
+                my_vector<int> masked(size);
+                my_simd::bit_and(ints.data(), other.data(), masked.data(), size);
+                assert(my_simd::popcount(ints.data(), size) == bits && (size == 0 || masked[0] == ints[0]));
+                assert(my_simd::find_nonzero(ints.data(), size) ==
+                       static_cast<size_t>(std::find_if(ints.begin(), ints.end(), [](int x) { return x != 0; }) -
+                                           ints.begin()));
+
+                if (size > 0) {
+                    assert(my_simd::min(ints) == *std::min_element(ints.begin(), ints.end()));
+                    assert(my_simd::max(bytes) == *std::max_element(bytes.begin(), bytes.end()));
+                    assert(my_simd::max(doubles) == *std::max_element(doubles.begin(), doubles.end()));
+                }
+            }
+        }
+        my_simd::set_level(supported);
+        std::cout << "kernels test passed!\n";
+
+        // 8-bit lane counters are flushed before they overflow
+        my_vector<uint8_t> many(100000, 200);
+        assert(my_simd::count(many, uint8_t(200)) == 100000 && my_simd::sum(many) == 20000000);
+
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        my_vector<double> with_nan = {nan, 2.0, -1.0, nan, 5.0};
+        assert(with_nan != with_nan);
+        assert(my_simd::find(with_nan, nan) == with_nan.end());
+        assert(my_simd::min(with_nan) == -1.0 && my_simd::max(with_nan) == 5.0);
+
+        try {
+            my_simd::min(my_vector<int>());
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        std::cout << "floating point and edge cases test passed!\n";
+
+        my_array<int, 3> arr1 = {1, 2, 3};
+        my_array<int, 3> arr2 = {1, 2, 4};
+        assert(arr1 != arr2 && arr1 < arr2 && (arr1 <=> arr1) == 0);
+        assert(my_simd::sum(arr2) == 7 && my_simd::count(arr2, 2) == 1);
+
+        my_array<float, 2> floats1 = {1.0f, static_cast<float>(nan)};
+        my_array<float, 2> floats2 = floats1;
+        assert(floats1 != floats2 && (floats1 <=> floats2) == std::partial_ordering::unordered);
+
+        my_small_vector<short, 4> small = {3, 1, 2};
+        assert(small == (my_small_vector<short, 4>{3, 1, 2}) && my_simd::min(small) == 1);
+        std::cout << "containers test passed!\n";
+    }
+
+    std::cout << "my_expr tests\n";
+    {
+        my_vector<double> b = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+        my_vector<double> c = {2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2};
+        const my_vector<double> d(11, 0.5);
+
+        my_vector<double> a = b * c + d;
+        assert(a.size() == 11 && a[0] == 2.5 && a[10] == 22.5);
+        a = (a - d) / c - b;
+        assert(std::all_of(a.begin(), a.end(), [](double x) { return x == 0; }));
+        a = 2.0 * b - 1.0;
+        a = -a * 3.0 + a;
+        assert(a[0] == -2 && a[1] == -6);
+
+        // the destination among the operands, and a temporary taken over
+        b = b * b + my_vector<double>(11, 1.0);
+        assert(b[2] == 10 && b[10] == 122);
+        a = my_expr::sqrt(b - 1.0) + my_expr::abs(-c) * my_expr::exp(d - 0.5) + my_expr::log(c / 2.0);
+        assert(a[2] == 3 + 2 && a[10] == 11 + 2);
+
+        // a shorter or longer destination is resized
+        my_vector<double> small(3, 7.0);
+        small = c * 4.0;
+        assert(small.size() == 11 && small[10] == 8);
+        small = my_vector<double>();
+        small = b * 0.0;
+        assert(small.size() == 11);
+        std::cout << "fused assignment test passed!\n";
+
+        assert(my_expr::sum(c * d) == 11 && my_expr::sum(b) == 506 + 11);
+        assert(my_expr::min(b - 5.0) == -3 && my_expr::max(-b) == -2);
+        const my_vector<int> ints = {-3, 1, 4, -1, 5};
+        assert(my_expr::sum(ints * ints) == 52 && my_expr::max(my_expr::abs(ints)) == 5);
+        const my_vector<float> with_nan = {3, std::numeric_limits<float>::quiet_NaN(), 1};
+        assert(my_expr::min(with_nan * 2.0f) == 2 && my_expr::max(with_nan + 1.0f) == 4);
+        const my_vector<double> mixed = ints * 0.5;
+        assert(mixed[0] == -1.5 && mixed[4] == 2.5);
+        std::cout << "reductions and mixed types test passed!\n";
+
+        bool threw = false;
+        try {
+            a = b + my_vector<double>(3);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw && a.size() == 11);
+        threw = false;
+        try {
+            my_expr::min(my_vector<double>() * 2.0);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+
+        // a throwing element keeps the ones built before it, and no others
+        const my_vector<double> signs = {1, 2, 3, -1, 5};
+        threw = false;
+        try {
+            my_vector<non_negative> built(signs * 2.0);
+        } catch (const std::domain_error&) {
+            threw = true;
+        }
+        assert(threw && non_negative::alive == 0);
+        my_vector<non_negative> kept(d * 2.0);
+        threw = false;
+        try {
+            kept = signs - 1.0;
+        } catch (const std::domain_error&) {
+            threw = true;
+        }
+        assert(threw && kept.size() == 3 && kept[2].value == 2 && non_negative::alive == 3);
+        std::cout << "errors test passed!\n";
+    }
+
+    std::cout << "my_compressed_vector tests\n";
+    {
+        // sorted ids, small values with a few outliers, random 64-bit values and a tail
+        my_vector<uint32_t> ids;
+        for (uint32_t i = 0; i < 1000; ++i) ids.push_back(1'000'000 + i * 3 + (i % 7 == 0 ? 1 : 0));
+        my_compressed_vector<uint32_t> packed(ids);
+        assert(packed.size() == 1000 && packed.block_count() == 1000 / 128);
+        assert(packed.to_vector() == ids && packed[0] == 1'000'001 && packed.at(999) == ids[999]);
+        for (size_t i = 0; i < ids.size(); i += 37) assert(packed[i] == ids[i]);
+        assert(std::equal(packed.begin(), packed.end(), ids.begin()));
+        assert(packed.memory_bytes() * 4 < ids.size() * sizeof(uint32_t));
+
+        my_vector<uint64_t> mixed;
+        uint64_t state = 42;
+        for (size_t i = 0; i < 600; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            mixed.push_back(i < 256 ? (i % 50 == 0 ? state : i % 5) : i < 384 ? state : ~uint64_t(0) - i);
+        }
+        my_compressed_vector<uint64_t> wide(mixed);
+        assert(wide.to_vector() == mixed && wide.at(300) == mixed[300] && wide[599] == mixed[599]);
+        assert(wide.block_encoding(0) == my_compressed_vector<uint64_t>::encoding::delta_varint);
+        assert(wide.block_encoding(2) == my_compressed_vector<uint64_t>::encoding::frame_of_reference);
+        assert(wide.block_encoding(3) == my_compressed_vector<uint64_t>::encoding::delta);
+
+        bool threw = false;
+        try {
+            wide.at(600);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+        std::cout << "encodings and random access test passed!\n";
+
+        my_compressed_vector<int64_t> signed_values = {-5, 3, std::numeric_limits<int64_t>::min(),
+                                                       std::numeric_limits<int64_t>::max(), 0};
+        my_vector<int64_t> expected = {-5, 3, std::numeric_limits<int64_t>::min(),
+                                       std::numeric_limits<int64_t>::max(), 0};
+        for (int64_t i = 0; i < 300; ++i) {
+            signed_values.push_back(i % 2 ? -i : i * 1000);
+            expected.push_back(i % 2 ? -i : i * 1000);
+        }
+        assert(signed_values.to_vector() == expected && signed_values.block_count() == 2);
+        int64_t total = 0;
+        signed_values.for_each([&](int64_t v) { total += v % 1'000'000'000'000; });
+        assert(total == std::accumulate(expected.begin(), expected.end(), int64_t(0),
+                                        [](int64_t sum, int64_t v) { return sum + v % 1'000'000'000'000; }));
+        assert(signed_values == my_compressed_vector<int64_t>(expected));
+
+        my_compressed_vector<uint16_t> constant;
+        constant.append_range(my_vector<uint16_t>(256, 7));
+        assert(constant.memory_bytes() < 64 && constant[200] == 7);
+        constant.clear();
+        assert(constant.is_empty() && constant.begin() == constant.end());
+        std::cout << "append and iteration test passed!\n";
+    }
+
+    std::cout << "my_parallel tests\n";
+    {
+        // more workers than cores, and a pool without workers where the caller runs everything
+        for (size_t workers : {0, 3}) {
+            my_thread_pool pool(workers);
+
+            my_vector<int> vec;
+            for (int i = 0; i < 100000; ++i) {
+                vec.push_back(i * 7919 % 100003);
+            }
+            my_vector<int> sorted(vec);
+            std::sort(sorted.begin(), sorted.end());
+
+            my_vector<int> copy(vec);
+            my_parallel::sort(copy, std::less<>{}, 1000, pool);
+            assert(copy == sorted);
+
+            my_vector<long long> doubled(vec.size());
+            my_parallel::transform(vec, doubled.begin(), [](int x) { return 2LL * x; }, 1000, pool);
+            assert(doubled[500] == 2LL * vec[500] && doubled.back() == 2LL * vec.back());
+
+            const long long sum = my_parallel::reduce(vec, 0LL, std::plus<>{}, 1000, pool);
+            assert(sum == std::accumulate(vec.begin(), vec.end(), 0LL));
+
+            my_parallel::for_each(vec, [](int& x) { x = -x; }, 1000, pool);
+            assert(vec[1] == -7919);
+        }
+        std::cout << "sort/transform/reduce/for_each test passed!\n";
+
+        my_vector<std::string> words = {"pok", "acs", "os", "ucu", "apps", "cs"};
+        my_parallel::sort(words, std::greater<>{}, 1);
+        assert(words[0] == "ucu" && words.back() == "acs");
+
+        my_array<int, 64> arr;
+        for (size_t i = 0; i < arr.size(); ++i) {
+            arr[i] = static_cast<int>(arr.size() - i);
+        }
+        my_parallel::sort(arr, std::less<>{}, 4);
+        assert(std::is_sorted(arr.begin(), arr.end()));
+        std::cout << "complex types and my_array test passed!\n";
+
+        try {
+            my_vector<int> vec(1000, 1);
+            my_parallel::for_each(vec, [](int& x) {
+                if (x == 1) throw std::runtime_error("failed task");
+            }, 10);
+            assert(false);
+        } catch (const std::runtime_error&) {
+            std::cout << "exception test passed!\n";
+        }
+
+        for (bool pin : {false, true}) {
+            const my_parallel::first_touch options{4, pin};
+            my_vector<double> zeros;
+            my_parallel::resize(zeros, 300000, options);
+            assert(zeros.size() == 300000 && std::all_of(zeros.begin(), zeros.end(), [](double x) { return x == 0; }));
+            my_parallel::resize(zeros, 400000, 2.5, options);
+            assert(zeros[299999] == 0 && zeros[300000] == 2.5 && zeros.back() == 2.5);
+            my_parallel::resize(zeros, 5, 1.0);
+            assert(zeros.size() == 5);
+
+            my_vector<long long> raw;
+            my_parallel::resize_default_init(raw, 500000, options);
+            my_parallel::for_each(raw, [](long long& x) { x = 1; });
+            assert(std::accumulate(raw.begin(), raw.end(), 0LL) == 500000);
+
+            my_vector<std::string> words;
+            my_parallel::resize(words, 100000, "first touch", options);
+            assert(words.size() == 100000 && words[54321] == "first touch");
+        }
+
+        // a copy failing in one part: the other parts are destroyed, the vector is unchanged
+        {
+            const shared_counter prototype;
+            my_vector<shared_counter> counters;
+            shared_counter::copy_budget = 150000;
+            bool threw = false;
+            try {
+                my_parallel::resize(counters, 200000, prototype, {4, false});
+            } catch (const std::runtime_error&) {
+                threw = true;
+            }
+            assert(threw && counters.is_empty() && shared_counter::alive == 1);
+        }
+        std::cout << "parallel resize test passed!\n";
+    }
+
+    std::cout << "my_concurrent_vector tests\n";
+    {
+        my_concurrent_vector<int> vec;
+        const int* first = &vec.push_back(-1);
+
+        my_vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&vec, t] {
+                for (int i = 0; i < 10000; ++i) {
+                    if (i % 100 == 0) {
+                        const size_t index = vec.grow_by(3, t);
+                        assert(vec[index + 2] == t);
+                    } else {
+                        vec.emplace_back(t);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        assert(vec.size() == 1 + 4 * (9900 + 100 * 3));
+        assert(&vec[0] == first && *first == -1);
+        assert(std::count(vec.begin(), vec.end(), 3) == 9900 + 100 * 3);
+        assert(vec.capacity() >= vec.size());
+        std::cout << "concurrent append test passed!\n";
+
+        my_concurrent_vector<std::string> words;
+        words.reserve(1000);
+        const size_t cap = words.capacity();
+        for (int i = 0; i < 1000; ++i) {
+            words.push_back(std::to_string(i));
+        }
+        assert(words.capacity() == cap && words.at(999) == "999");
+        std::sort(words.begin(), words.end());
+        assert(words[0] == "0" && words[1] == "1" && words[2] == "10");
+        try {
+            words.at(1000);
+            assert(false);
+        } catch (const std::out_of_range&) {}
+        std::cout << "reserve, iterator and at test passed!\n";
+
+        struct throws_on_negative {
+            live_counter counter;
+            explicit throws_on_negative(int v) : counter(v) {
+                if (v < 0) throw std::runtime_error("negative");
+            }
+        };
+        const int alive = live_counter::alive;
+        {
+            my_concurrent_vector<throws_on_negative> vals;
+            vals.emplace_back(1);
+            try {
+                vals.emplace_back(-1);
+                assert(false);
+            } catch (const std::runtime_error&) {}
+            vals.emplace_back(2);
+            assert(vals.size() == 3 && vals[2].counter.value == 2);
+            assert(live_counter::alive == alive + 2);
+
+            // the thrown append left a hole that readers skip
+            assert(vals.has_holes() && vals.is_hole(1) && !vals.is_hole(0) && !vals.is_hole(2));
+            int sum = 0;
+            for (size_t i = 0; i < vals.size(); ++i) {
+                if (!vals.is_hole(i)) {
+                    sum += vals[i].counter.value;
+                }
+            }
+            assert(sum == 3);
+        }
+        assert(live_counter::alive == alive);
+
+        my_concurrent_vector<int> ints;
+        ints.grow_by(3, 7);
+        assert(!ints.has_holes() && !ints.is_hole(1));
+        std::cout << "exception test passed!\n";
+    }
+
+    std::cout << "my_segmented_vector tests\n";
+    {
+        my_segmented_vector<int> vec;
+        vec.push_back(1);
+        const int* first = &vec.front();
+        for (int i = 2; i <= 10000; ++i) {
+            vec.push_back(i);
+            vec.push_front(-i);
+        }
+        assert(vec.size() == 19999 && &vec[9999] == first && *first == 1);
+        assert(vec.front() == -10000 && vec.back() == 10000 && vec.at(10000) == 2);
+        assert(vec.end() - vec.begin() == 19999 && *(vec.begin() + 5000) == vec[5000]);
+        assert(std::is_sorted(vec.begin() + 10000, vec.end()));
+        std::sort(vec.begin(), vec.end());
+        assert(std::is_sorted(vec.begin(), vec.end()) && vec[0] == -10000);
+
+        vec.pop_front();
+        vec.pop_back();
+        assert(vec.front() == -9999 && vec.back() == 9999);
+        std::cout << "push/pop at both ends and iterator test passed!\n";
+
+        my_segmented_vector<std::string> words = {"ucu", "apps", "cs"};
+        words.insert(words.begin() + 1, "pok");
+        words.insert(words.end() - 1, "os");
+        words.erase(words.begin());
+        assert(words.size() == 4 && words[0] == "pok" && words[2] == "os" && words.back() == "cs");
+
+        my_segmented_vector<std::string> copy(words);
+        assert(copy == words);
+        my_segmented_vector<std::string> moved(std::move(copy));
+        assert(moved == words && copy.is_empty());
+        moved.resize(100, "x");
+        assert(moved.size() == 100 && moved > words);
+        moved.clear();
+        moved.shrink_to_fit();
+        assert(moved.is_empty() && moved.capacity() == 0);
+        std::cout << "insert/erase and copy/move test passed!\n";
+
+        const int alive = live_counter::alive;
+        {
+            my_segmented_vector<live_counter> counters(1000);
+            for (int i = 0; i < 3000; ++i) {
+                counters.emplace_back(i);
+                counters.pop_front();
+            }
+            assert(live_counter::alive == alive + 1000);
+            counters.erase(counters.begin() + 10, counters.end() - 10);
+            assert(counters.size() == 20 && live_counter::alive == alive + 20);
+        }
+        assert(live_counter::alive == alive);
+        std::cout << "object lifetime test passed!\n";
+    }
+
+    std::cout << "my_soa_vector tests\n";
+    {
+        // id, timestamp, price, qty
+        my_soa_vector<int, long long, double, int> trades;
+        for (int i = 0; i < 1000; ++i) {
+            const int id = i * 7919 % 1000;
+            trades.emplace_back(id, 1000LL * id, id * 0.5, id % 10);
+        }
+        trades.push_back({1000, 1000000LL, 500.0, 0});
+        assert(trades.size() == 1001 && trades.capacity() >= 1001);
+
+        const std::span<const double> prices = std::as_const(trades).column<2>();
+        assert(prices.size() == 1001 && prices[1] == 7919 % 1000 * 0.5);
+        assert(std::accumulate(prices.begin(), prices.end(), 0.0) == 0.5 * 1000 * 1001 / 2);
+        std::cout << "push_back and column test passed!\n";
+
+        std::sort(trades.begin(), trades.end(), [](const auto& a, const auto& b) { return get<2>(a) > get<2>(b); });
+        for (size_t i = 0; i < trades.size(); ++i) {
+            const auto [id, timestamp, price, qty] = trades[i];
+            assert(id == 1000 - static_cast<int>(i) && timestamp == 1000LL * id && price == id * 0.5);
+        }
+
+        trades[0] = std::make_tuple(-1, 0LL, 0.0, 0);
+        assert(trades.front() == std::make_tuple(-1, 0LL, 0.0, 0));
+        trades.erase(trades.begin(), trades.begin() + 1);
+        assert(get<0>(trades.front()) == 999);
+        std::reverse(trades.begin(), trades.end());
+        assert(std::is_sorted(trades.begin(), trades.end()));
+        std::cout << "row proxy and sort test passed!\n";
+
+        my_soa_vector<std::string, live_counter> named;
+        const int alive = live_counter::alive;
+        for (int i = 0; i < 100; ++i) {
+            named.emplace_back(std::to_string(i), i);
+        }
+        named.emplace_back(get<0>(named[0]), get<1>(named[0]));
+        my_soa_vector<std::string, live_counter> copy(named);
+        assert(copy.size() == 101 && get<0>(copy.back()) == "0" && get<1>(copy[5]).value == 5);
+        named.resize(10);
+        named.shrink_to_fit();
+        assert(named.capacity() == 10 && live_counter::alive == alive + 111);
+        copy = std::move(named);
+        assert(named.is_empty() && live_counter::alive == alive + 10);
+        copy.clear();
+        assert(live_counter::alive == alive);
+
+        // a copy that throws part way destroys the rows it built and frees its columns
+        my_soa_vector<std::string, shared_counter> rows(3);
+        const int counters_alive = shared_counter::alive;
+        shared_counter::copy_budget = 1;
+        bool threw = false;
+        try {
+            my_soa_vector<std::string, shared_counter> broken(rows);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        shared_counter::copy_budget = 0;
+        assert(threw && shared_counter::alive == counters_alive);
+        std::cout << "complex types test passed!\n";
+    }
+
+    std::cout << "my_bitvector tests\n";
+    {
+        const my_simd_level supported = my_simd::supported_level();
+        for (size_t size : {0, 1, 63, 64, 65, 1000, 5000}) {
+            std::vector<bool> a_ref(size);
+            std::vector<bool> b_ref(size);
+            my_bitvector<> a(size);
+            my_bitvector<> b;
+            for (size_t i = 0; i < size; ++i) {
+                a_ref[i] = i % 3 == 0 || i % 7 == 1;
+                b_ref[i] = i * 31 % 17 < 5;
+                a[i] = a_ref[i];
+                b.push_back(b_ref[i]);
+            }
+            assert(a.size() == size && b.size() == size && std::equal(a.begin(), a.end(), a_ref.begin()));
+
+            for (my_simd_level level = my_simd_level::scalar; level <= supported;
+                 level = static_cast<my_simd_level>(static_cast<int>(level) + 1)) {
+                my_simd::set_level(level);
+                assert(a.count() == static_cast<size_t>(std::count(a_ref.begin(), a_ref.end(), true)));
+
+                const my_bitvector<> both = a & b;
+                const my_bitvector<> either = a | b;
+                const my_bitvector<> one = a ^ b;
+                const my_bitvector<> neither = ~either;
+                for (size_t i = 0; i < size; ++i) {
+                    assert(both[i] == (a_ref[i] && b_ref[i]) && either[i] == (a_ref[i] || b_ref[i]));
+                    assert(one[i] == (a_ref[i] != b_ref[i]) && neither[i] == !(a_ref[i] || b_ref[i]));
+                }
+                assert(either.count() + neither.count() == size && (~neither) == either);
+
+                size_t found = 0;
+                for (size_t i = both.find_first(); i < size; i = both.find_next(i + 1)) {
+                    assert(both[i]);
+                    ++found;
+                }
+                assert(found == both.count());
+            }
+            my_simd::set_level(supported);
+        }
+        std::cout << "count, find and bitwise test passed!\n";
+
+        my_bitvector<> bits(200);
+        bits.set(3, 130);
+        assert(bits.count() == 127 && bits.find_first() == 3 && !bits[2] && bits[129] && !bits[130]);
+        bits.flip(100, 200);
+        assert(bits.count() == 97 + 70 && bits.find_next(100) == 130);
+        bits.reset(0, 200);
+        assert(bits.none() && bits.find_first() == 200);
+        bits.set(64, 64);
+        bits.set(5);
+        bits.flip(6);
+        assert(bits.count() == 2 && bits.test(5) && bits.at(6));
+        bits.set();
+        assert(bits.all() && bits.count() == 200);
+        bits.resize(70);
+        bits.resize(130, false);
+        assert(bits.count() == 70 && bits.words().size() == 3);
+        bits.pop_back();
+        bits.resize(300, true);
+        assert(bits.count() == 70 + 300 - 129 && bits.find_next(70) == 129);
+        std::cout << "range and resize test passed!\n";
+
+        my_bitvector<> flags = {true, false, true, true};
+        std::sort(flags.begin(), flags.end());
+        assert(flags == my_bitvector<>({false, true, true, true}));
+        swap(flags[0], flags[3]);
+        flags[1] = flags[0];
+        assert(flags == my_bitvector<>({true, true, true, false}));
+        my_bitvector<> moved = std::move(flags);
+        assert(flags.is_empty() && moved.size() == 4 && moved.front() && !moved.back());
+        bool threw = false;
+        try {
+            moved &= my_bitvector<>(5);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+        std::cout << "proxy and errors test passed!\n";
+    }
+
+    std::cout << "my_flat_set tests\n";
+    {
+        my_flat_set<int> set = {5, 1, 4, 1, 3, 5};
+        assert(set.size() == 4 && std::is_sorted(set.begin(), set.end()));
+        assert(set.contains(4) && !set.contains(2) && set.count(1) == 1 && set.find(2) == set.end());
+        assert(*set.lower_bound(2) == 3 && *set.upper_bound(3) == 4 && set.upper_bound(5) == set.end());
+        assert(set.insert(2).second && !set.insert(2).second && set.size() == 5);
+
+        for (size_t n : {0, 1, 2, 3, 7, 8, 9, 100}) {
+            my_vector<int> sorted;
+            for (size_t i = 0; i < n; ++i) {
+                sorted.push_back(static_cast<int>(i) * 2);
+            }
+            my_flat_set<int> evens(my_sorted_unique, sorted);
+            for (int key = -1; key <= static_cast<int>(n) * 2; ++key) {
+                assert(evens.lower_bound(key) == std::lower_bound(evens.begin(), evens.end(), key));
+                assert(evens.upper_bound(key) == std::upper_bound(evens.begin(), evens.end(), key));
+            }
+        }
+
+        my_vector<int> batch;
+        std::vector<int> reference(set.begin(), set.end());
+        for (int i = 0; i < 1000; ++i) {
+            batch.push_back(i * 7919 % 503);
+            reference.push_back(i * 7919 % 503);
+        }
+        set.insert_range(batch);
+        std::sort(reference.begin(), reference.end());
+        reference.erase(std::unique(reference.begin(), reference.end()), reference.end());
+        assert(std::equal(set.begin(), set.end(), reference.begin(), reference.end()));
+
+        set.insert_range(my_sorted_unique, std::vector<int>{-3, 2, 1000});
+        assert(set.size() == reference.size() + 2 && set.keys().front() == -3 && set.keys().back() == 1000);
+        assert(set.erase(1000) == 1 && set.erase(1000) == 0 && *set.erase(set.begin()) == 0);
+        const my_vector<int> keys = std::move(set).extract();
+        assert(set.is_empty() && keys.size() == reference.size());
+        std::cout << "lookup and bulk insertion test passed!\n";
+
+        my_flat_set<std::string, std::greater<>> words = {"b", "c", "a", "c"};
+        assert(words.size() == 3 && words.keys().front() == "c" && *words.lower_bound("b") == "b");
+        std::cout << "custom comparison test passed!\n";
+    }
+
+    std::cout << "my_flat_map tests\n";
+    {
+        my_flat_map<int, std::string> map = {{3, "three"}, {1, "one"}, {2, "two"}, {1, "uno"}};
+        assert(map.size() == 3 && map.at(1) == "one" && map.keys()[2] == 3 && map.values()[2] == "three");
+        assert(map.find(4) == map.end() && map.find(2)->second == "two" && (*map.lower_bound(0)).first == 1);
+        map[4] = "four";
+        map[2] += "!";
+        assert(map.size() == 4 && map.at(2) == "two!" && map.upper_bound(3).key() == 4);
+        assert(!map.try_emplace(4, "vier").second && map.insert_or_assign(4, "vier").first.value() == "vier");
+        assert(map.emplace(0, "zero").second && map.begin()->second == "zero");
+        bool threw = false;
+        try {
+            map.at(9);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+
+        std::vector<std::pair<int, std::string>> entries;
+        for (int i = 0; i < 500; ++i) {
+            entries.emplace_back(i * 37 % 101, std::to_string(i));
+        }
+        map.insert_range(entries);
+        assert(map.size() == 101 && std::is_sorted(map.keys().begin(), map.keys().end()));
+        // existing keys keep their values; new ones get the first in the range
+        assert(map.at(2) == "two!" && map.at(37) == "1" && map.at(100) == "30");
+        assert(entries.front().second == "0");
+
+        size_t visited = 0;
+        for (auto [key, value] : map) {
+            assert(map.at(key) == value);
+            ++visited;
+        }
+        assert(visited == map.size() && map.end() - map.begin() == 101);
+        assert(map.erase(50) == 1 && !map.contains(50) && map.erase(map.begin())->first == 1);
+        std::cout << "lookup and bulk insertion test passed!\n";
+
+        my_vector<int> keys = {1, 2, 3};
+        my_vector<double> values = {0.5, 1.5, 2.5};
+        my_flat_map<int, double> sorted(my_sorted_unique, std::move(keys), std::move(values));
+        assert(sorted.size() == 3 && sorted.at(3) == 2.5);
+        auto [key_column, value_column] = std::move(sorted).extract();
+        assert(key_column.size() == 3 && value_column[1] == 1.5 && sorted.is_empty());
+        threw = false;
+        try {
+            my_flat_map<int, double> broken(my_vector<int>{1, 2}, my_vector<double>{1.0});
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+        std::cout << "sorted unique and columns test passed!\n";
+
+        my_flat_map<int, shared_counter> counters;
+        counters.reserve(6); // nothing below grows, so only the range's values are copied
+        for (int key : {1, 5, 9}) {
+            counters.try_emplace(key);
+        }
+        std::vector<std::pair<int, shared_counter>> more(3);
+        more[0].first = 0, more[1].first = 3, more[2].first = 7;
+        shared_counter::copy_budget = 1; // the second value copy throws
+        threw = false;
+        try {
+            counters.insert_range(more);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        shared_counter::copy_budget = 0;
+        assert(threw && counters.size() == 3 && counters.contains(5) && !counters.contains(0));
+        assert(std::is_sorted(counters.keys().begin(), counters.keys().end()) && counters.values().size() == 3);
+        std::cout << "throwing insertion test passed!\n";
+    }
+
+    std::cout << "constexpr tests\n";
+    {
+        static_assert(vector_workout() == -2 + 99 + 97);
+        static_assert(string_workout() == (4 + 10 + 8 + 1 + 1) * 10 + 5);
+        static_assert(my_vector<int>{1, 2, 3}.size() == 3);
+        std::cout << "constexpr my_vector test passed!\n";
+
+        static_assert(popcounts[7] == 3 && popcounts.at(15) == 4 && popcounts.back() == 4);
+        static_assert([] {
+            my_array<int, 4> a{1, 2};
+            my_array<int, 4> b;
+            b.fill(9);
+            a.swap(b);
+            return a[0] == 9 && b[1] == 2 && b[3] == 0 && b < a && std::accumulate(a.begin(), a.end(), 0) == 36;
+        }());
+        std::cout << "constexpr my_array test passed!\n";
+    }
+
+    std::cout << "my_ring_buffer tests\n";
+    {
+        my_ring_buffer<int, 4> ring;
+        assert(ring.capacity() == 4 && ring.is_empty());
+        for (int i = 0; i < 4; ++i) {
+            assert(ring.try_push(i));
+        }
+        assert(ring.is_full() && !ring.try_push(4) && ring.front() == 0 && ring.back() == 3);
+        int value = -1;
+        assert(ring.try_pop(value) && value == 0 && ring.try_push(4) && ring.at(3) == 4);
+        ring.push_overwrite(5);
+        assert(ring.size() == 4 && ring.front() == 2 && ring[3] == 5);
+        bool threw = false;
+        try {
+            ring.at(4);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+
+        my_ring_buffer<std::string> strings(5);
+        assert(strings.capacity() == 8);
+        const std::vector<std::string> words = {"a", "b", "c", "d", "e", "f"};
+        for (int lap = 0; lap < 3; ++lap) {
+            assert(strings.try_push_n(words.begin(), words.size()) == 6 && strings.size() == 6);
+            std::vector<std::string> out(8);
+            assert(strings.try_pop_n(out.begin(), 8) == 6 && out[5] == "f" && strings.is_empty());
+        }
+        threw = false;
+        try {
+            my_ring_buffer<int> none(0);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+        std::cout << "fixed and runtime capacity test passed!\n";
+    }
+
+    std::cout << "my_concurrent_queue tests\n";
+    {
+        constexpr long long items = 100'000;
+
+        my_spsc_queue<long long, 256> spsc;
+        std::thread producer([&] {
+            long long batch[7];
+            for (long long next = 0; next < items;) {
+                const size_t n = static_cast<size_t>(std::min<long long>(7, items - next));
+                std::iota(batch, batch + n, next);
+                const size_t pushed = spsc.try_push_n(batch, n);
+                next += static_cast<long long>(pushed);
+                if (pushed == 0) std::this_thread::yield();
+            }
+        });
+        long long expected = 0;
+        long long batch[5];
+        while (expected < items) {
+            const size_t n = expected % 2 == 0 ? spsc.try_pop_n(batch, 5) : spsc.try_pop(batch[0]);
+            for (size_t i = 0; i < n; ++i) {
+                assert(batch[i] == expected++);
+            }
+            if (n == 0) std::this_thread::yield();
+        }
+        producer.join();
+        assert(spsc.size_approx() == 0 && !spsc.try_pop(batch[0]));
+        std::cout << "spsc order test passed!\n";
+
+        my_mpmc_queue<long long> mpmc(100);
+        assert(mpmc.capacity() == 128);
+        constexpr int producers = 3;
+        constexpr int consumers = 3;
+        std::atomic<long long> sum{0};
+        std::atomic<long long> popped{0};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (long long i = p; i < items;) {
+                    long long batch[3];
+                    size_t n = 0;
+                    for (long long j = i; j < items && n < 3; j += producers) batch[n++] = j;
+                    const size_t pushed = p == 0 ? mpmc.try_push(batch[0]) : mpmc.try_push_n(batch, n);
+                    i += static_cast<long long>(pushed) * producers;
+                    if (pushed == 0) std::this_thread::yield();
+                }
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&, c] {
+                long long batch[4];
+                while (popped.load() < items) {
+                    const size_t n = c == 0 ? mpmc.try_pop(batch[0]) : mpmc.try_pop_n(batch, 4);
+                    for (size_t i = 0; i < n; ++i) sum += batch[i];
+                    popped += static_cast<long long>(n);
+                    if (n == 0) std::this_thread::yield();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        assert(popped == items && sum == items * (items - 1) / 2 && mpmc.size_approx() == 0);
+        std::cout << "mpmc sum test passed!\n";
+    }
+
+    std::cout << "my_snapshot tests\n";
+    {
+        my_vector<std::string> words = {"a", "b", "c"};
+        const std::string* elements = words.data();
+        my_snapshot<std::string> first(std::move(words));
+        assert(first.data() == elements && first.size() == 3 && first.at(2) == "c");
+        my_snapshot<std::string> copy = first;
+        assert(copy.shares_with(first) && copy.use_count() == 2 && copy == first);
+        assert(my_snapshot<std::string>().is_empty() && my_snapshot<std::string>().begin() == nullptr);
+        std::cout << "move in and share test passed!\n";
+
+        my_snapshot_builder<std::string> builder(first);
+        assert(builder.is_shared());
+        builder.edit().push_back("d");
+        assert(builder.view().data() != elements && first.size() == 3 && builder.view().size() == 4);
+        const std::string* edited = builder.view().data();
+        builder.edit()[0] = "z";
+        assert(builder.view().data() == edited && !builder.is_shared());
+
+        my_snapshot<std::string> second = builder.snapshot();
+        assert(builder.is_shared() && second[0] == "z" && second.size() == 4);
+        builder.edit().pop_back();
+        assert(second.size() == 4 && builder.view().size() == 3 && !(second == first));
+        my_vector<std::string> taken = builder.take();
+        assert(taken.size() == 3 && taken[0] == "z" && builder.view().is_empty());
+        std::cout << "copy on write builder test passed!\n";
+
+        my_atomic_snapshot<int> latest(my_snapshot<int>(my_vector<int>(1000, 0)));
+        std::atomic<bool> done{false};
+        std::atomic<int> torn{0};
+        my_vector<std::thread> readers;
+        for (int t = 0; t < 3; ++t) {
+            readers.emplace_back([&] {
+                while (!done.load()) {
+                    const my_snapshot<int> version = latest.acquire();
+                    // every version holds one value throughout
+                    if (std::count(version.begin(), version.end(), version.front()) != 1000) {
+                        torn.fetch_add(1);
+                    }
+                }
+            });
+        }
+        my_snapshot_builder<int> writer(latest.acquire());
+        for (int version = 1; version <= 200; ++version) {
+            my_vector<int>& values = writer.edit();
+            std::fill(values.begin(), values.end(), version);
+            latest.publish(writer.snapshot());
+        }
+        done.store(true);
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        assert(torn.load() == 0 && latest.acquire().front() == 200);
+        assert(latest.exchange(my_snapshot<int>()).size() == 1000 && latest.acquire().is_empty());
+        std::cout << "publish and acquire test passed!\n";
+    }
+
+    std::cout << "my_telemetry tests\n";
+#ifdef MY_VECTOR_TELEMETRY
+    {
+        struct event_counter : my_telemetry::hook {
+            int events[3] = {};
+            void on_event(my_telemetry::event kind, const my_telemetry::counters& type, size_t) noexcept override {
+                if (type.type() == my_telemetry::type_name<telemetry_probe>()) {
+                    ++events[static_cast<int>(kind)];
+                }
+            }
+        } counter;
+        my_telemetry::registry& registry = my_telemetry::registry::instance();
+        registry.set_hook(&counter);
+
+        my_telemetry::counters& probe = my_telemetry::counters_for<telemetry_probe>();
+        assert(&probe == &my_telemetry::counters_for<telemetry_probe>());
+        assert(probe.type() == "telemetry_probe" && probe.element_size() == 16);
+        {
+            my_vector<telemetry_probe> v;
+            for (int i = 0; i < 5; ++i) {
+                v.push_back({i, i});
+            }
+            v.shrink_to_fit();
+        }
+        registry.set_hook(nullptr);
+
+        const my_telemetry::stats s = probe.snapshot();
+        assert(s.allocations == 5 && s.deallocations == 5 && s.reallocations == 4);
+        assert(s.bytes_allocated == (1 + 2 + 4 + 8 + 5) * 16 && s.bytes_relocated == (1 + 2 + 4 + 5) * 16);
+        assert(s.live_bytes == 0 && s.peak_live_bytes == (8 + 5) * 16 && s.peak_capacity == 8);
+        assert(s.wasted_bytes == 3 * 16);
+        assert(counter.events[0] == 5 && counter.events[1] == 5 && counter.events[2] == 4);
+        std::cout << "counters and hook test passed!\n";
+
+        size_t types = 0;
+        registry.for_each([&](const my_telemetry::stats& type) { types += type.type == "telemetry_probe"; });
+        assert(types == 1);
+        std::ostringstream json;
+        registry.write_json(json);
+        assert(json.str().find("{\"type\": \"telemetry_probe\", \"element_size\": 16, \"allocations\": 5,") !=
+               std::string::npos);
+        std::cout << "registry and json test passed!\n";
+    }
+#else
+    {
+        // only stand-ins are compiled, my_vector's hooks are discarded
+        static_assert(!my_telemetry::enabled && std::is_empty_v<my_telemetry::counters>);
+        my_vector<telemetry_probe> v(5);
+        assert(my_telemetry::stopwatch().elapsed_ns() == 0 && v.size() == 5);
+        std::cout << "disabled telemetry test passed!\n";
+    }
+#endif
+
     std::cout << "all tests passed!" << std::endl;
 
     return 0;
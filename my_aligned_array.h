@@ -0,0 +1,325 @@
+#ifndef MY_ALIGNED_ARRAY_H
+#define MY_ALIGNED_ARRAY_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include "my_simd.h"
+
+// The alignment of my_aligned_array<T, N> by default: the array's size in
+// bytes rounded down to a power of two, at most a 64-byte cache line, so
+// that 4 floats sit in one 16-byte register, 8 in a 32-byte one and 16 in a
+// 64-byte one, and no element straddles a line.
+template <typename T, size_t N>
+inline constexpr size_t my_simd_alignment =
+    std::max(alignof(T), std::min<size_t>(64, std::bit_floor(N * sizeof(T))));
+
+#if defined(__GNUC__)
+// the vector width the compiler was told to target, e.g. with -mavx2 or
+// -march=native; wider operations would be split anyway
+#if defined(__AVX512F__)
+inline constexpr size_t my_native_register_bytes = 64;
+#elif defined(__AVX__)
+inline constexpr size_t my_native_register_bytes = 32;
+#else
+inline constexpr size_t my_native_register_bytes = 16;
+#endif
+
+// a vector register of Bytes bytes of T, for the arithmetic types of my_simd
+template <typename T, size_t Bytes, bool = my_simd::is_vectorizable_v<T>>
+struct my_simd_register {
+    using type = void;
+};
+
+template <typename T, size_t Bytes>
+struct my_simd_register<T, Bytes, true> {
+    typedef T type __attribute__((vector_size(Bytes), may_alias));
+};
+#endif
+
+// Fixed-size array of numbers aligned for SIMD, with element-wise arithmetic
+// and reductions for small geometry and feature vectors. For the arithmetic
+// types of my_simd the operations work on whole vector registers, as wide as
+// the alignment, the array and the compile target allow, all fixed at compile
+// time: with GCC or Clang vector extensions the loops over the registers are
+// fully unrolled and need no auto-vectorization. Build with -march=native or
+// -mavx2 to get 32- and 64-byte registers. The elements past the last full
+// register, and everything in constant evaluation, go one by one.
+//
+// Arithmetic follows the element type, e.g. integer division by zero is
+// undefined; min and max pick like std::min and std::max, and the
+// reductions combine the elements in an unspecified order.
+template <typename T, size_t N, size_t Align = my_simd_alignment<T, N>>
+class alignas(Align) my_aligned_array {
+    static_assert(N > 0, "my_aligned_array: N must be positive");
+    static_assert(std::has_single_bit(Align) && Align >= alignof(T),
+                  "my_aligned_array: Align must be a power of two no less than alignof(T)");
+
+private:
+    T data_[N];
+
+#if defined(__GNUC__)
+    // the widest register the compile target has, no wider than the alignment or the array
+    static constexpr size_t register_bytes =
+        std::min({Align, std::bit_floor(N * sizeof(T)), my_native_register_bytes});
+    static constexpr size_t lanes = my_simd::is_vectorizable_v<T> ? register_bytes / sizeof(T) : 1;
+
+    using register_type = typename my_simd_register<T, lanes * sizeof(T)>::type;
+
+    // the idx-th register-sized block of elements
+    auto& reg(size_t idx) noexcept { return reinterpret_cast<register_type*>(data_)[idx]; }
+    auto& reg(size_t idx) const noexcept { return reinterpret_cast<const register_type*>(data_)[idx]; }
+#else
+    static constexpr size_t lanes = 1;
+#endif
+
+    static constexpr bool vectorized = lanes > 1;
+    static constexpr size_t registers = N / lanes;
+
+    // the index of the first element left for the scalar loop
+    static constexpr size_t scalar_begin(bool in_registers) noexcept {
+        return in_registers ? registers * lanes : 0;
+    }
+
+    template <typename Op>
+    static constexpr my_aligned_array zip(const my_aligned_array& a, const my_aligned_array& b, Op op) {
+        my_aligned_array result;
+        const bool in_registers = vectorized && !std::is_constant_evaluated();
+#if defined(__GNUC__)
+        if constexpr (vectorized) {
+            if (in_registers) {
+                for (size_t r = 0; r < registers; ++r) {
+                    result.reg(r) = op(a.reg(r), b.reg(r));
+                }
+            }
+        }
+#endif
+        for (size_t i = scalar_begin(in_registers); i < N; ++i) {
+            result.data_[i] = op(a.data_[i], b.data_[i]);
+        }
+        return result;
+    }
+
+    template <typename Op>
+    static constexpr my_aligned_array map(const my_aligned_array& a, Op op) {
+        my_aligned_array result;
+        const bool in_registers = vectorized && !std::is_constant_evaluated();
+#if defined(__GNUC__)
+        if constexpr (vectorized) {
+            if (in_registers) {
+                for (size_t r = 0; r < registers; ++r) {
+                    result.reg(r) = op(a.reg(r));
+                }
+            }
+        }
+#endif
+        for (size_t i = scalar_begin(in_registers); i < N; ++i) {
+            result.data_[i] = op(a.data_[i]);
+        }
+        return result;
+    }
+
+#if defined(__GNUC__)
+    // combines the halves of a register until one lane is left, log2(lanes)
+    // shuffles instead of a pass over the lanes through memory
+    template <size_t Bytes, typename Op>
+    static T fold(const typename my_simd_register<T, Bytes>::type& v, Op op) noexcept {
+        if constexpr (Bytes == sizeof(T)) {
+            return v[0];
+        } else {
+            typename my_simd_register<T, Bytes / 2>::type low;
+            typename my_simd_register<T, Bytes / 2>::type high;
+            std::memcpy(&low, &v, Bytes / 2);
+            std::memcpy(&high, reinterpret_cast<const char*>(&v) + Bytes / 2, Bytes / 2);
+            return fold<Bytes / 2>(op(low, high), op);
+        }
+    }
+#endif
+
+    // folds the registers lane-wise, then the lanes and the scalar tail
+    template <typename Op>
+    constexpr T reduce(Op op) const {
+        T result = data_[0];
+        size_t i = 1;
+#if defined(__GNUC__)
+        if constexpr (vectorized) {
+            if (!std::is_constant_evaluated()) {
+                register_type acc = reg(0);
+                for (size_t r = 1; r < registers; ++r) {
+                    acc = op(acc, reg(r));
+                }
+                result = fold<lanes * sizeof(T)>(acc, op);
+                i = registers * lanes;
+            }
+        }
+#endif
+        for (; i < N; ++i) {
+            result = op(result, data_[i]);
+        }
+        return result;
+    }
+
+    static constexpr auto plus = [](auto x, auto y) { return x + y; };
+    static constexpr auto minus = [](auto x, auto y) { return x - y; };
+    static constexpr auto times = [](auto x, auto y) { return x * y; };
+    static constexpr auto divides = [](auto x, auto y) { return x / y; };
+    static constexpr auto lesser = [](auto x, auto y) { return y < x ? y : x; };
+    static constexpr auto greater = [](auto x, auto y) { return x < y ? y : x; };
+
+public:
+    using value_type = T;
+
+    static constexpr size_t alignment = Align;
+
+    constexpr my_aligned_array() = default;
+
+    // elements past the end of the list are value-initialized
+    constexpr my_aligned_array(std::initializer_list<T> ilist) : my_aligned_array(ilist.begin(), ilist.end()) {}
+
+    template <typename InIt>
+    constexpr my_aligned_array(InIt first, InIt last) {
+        size_t i = 0;
+        for (auto it = first; i < N && it != last; ++i, ++it) {
+            data_[i] = *it;
+        }
+        for (; i < N; ++i) {
+            data_[i] = T();
+        }
+    }
+
+    constexpr bool operator==(const my_aligned_array& other) const {
+        if constexpr (my_simd::is_vectorizable_v<T>) {
+            return my_simd::equal(data_, other.data_, N);
+        } else {
+            return std::equal(data_, data_ + N, other.data_);
+        }
+    }
+
+    // access without bounds checking
+    constexpr T& operator[](size_t idx) { return data_[idx]; }
+    constexpr const T& operator[](size_t idx) const { return data_[idx]; }
+
+    constexpr T& at(size_t idx) {
+        if (idx >= N) {
+            throw std::out_of_range("my_aligned_array::at: index out of range");
+        }
+        return data_[idx];
+    }
+
+    constexpr const T& at(size_t idx) const {
+        if (idx >= N) {
+            throw std::out_of_range("my_aligned_array::at: index out of range");
+        }
+        return data_[idx];
+    }
+
+    constexpr T* begin() { return data_; }
+    constexpr T* end() { return data_ + N; }
+    constexpr const T* begin() const { return data_; }
+    constexpr const T* end() const { return data_ + N; }
+    constexpr const T* cbegin() const { return data_; }
+    constexpr const T* cend() const { return data_ + N; }
+
+    constexpr size_t size() const { return N; }
+    constexpr T* data() { return data_; }
+    constexpr const T* data() const { return data_; }
+
+    constexpr void fill(const T& value) { std::fill(begin(), end(), value); }
+
+    constexpr void swap(my_aligned_array& other) noexcept(std::is_nothrow_swappable_v<T>) {
+        std::swap_ranges(data_, data_ + N, other.data_);
+    }
+
+    friend constexpr void swap(my_aligned_array& lhs, my_aligned_array& rhs) noexcept(std::is_nothrow_swappable_v<T>) {
+        lhs.swap(rhs);
+    }
+
+    // element-wise arithmetic, with another array or with one number for all
+
+    friend constexpr my_aligned_array operator+(const my_aligned_array& a, const my_aligned_array& b) {
+        return zip(a, b, plus);
+    }
+    friend constexpr my_aligned_array operator-(const my_aligned_array& a, const my_aligned_array& b) {
+        return zip(a, b, minus);
+    }
+    friend constexpr my_aligned_array operator*(const my_aligned_array& a, const my_aligned_array& b) {
+        return zip(a, b, times);
+    }
+    friend constexpr my_aligned_array operator/(const my_aligned_array& a, const my_aligned_array& b) {
+        return zip(a, b, divides);
+    }
+
+    friend constexpr my_aligned_array operator+(const my_aligned_array& a, T s) {
+        return map(a, [s](auto x) { return x + s; });
+    }
+    friend constexpr my_aligned_array operator-(const my_aligned_array& a, T s) {
+        return map(a, [s](auto x) { return x - s; });
+    }
+    friend constexpr my_aligned_array operator*(const my_aligned_array& a, T s) {
+        return map(a, [s](auto x) { return x * s; });
+    }
+    friend constexpr my_aligned_array operator*(T s, const my_aligned_array& a) { return a * s; }
+    friend constexpr my_aligned_array operator/(const my_aligned_array& a, T s) {
+        return map(a, [s](auto x) { return x / s; });
+    }
+
+    friend constexpr my_aligned_array operator-(const my_aligned_array& a) {
+        return map(a, [](auto x) { return -x; });
+    }
+
+    constexpr my_aligned_array& operator+=(const my_aligned_array& other) { return *this = *this + other; }
+    constexpr my_aligned_array& operator-=(const my_aligned_array& other) { return *this = *this - other; }
+    constexpr my_aligned_array& operator*=(const my_aligned_array& other) { return *this = *this * other; }
+    constexpr my_aligned_array& operator/=(const my_aligned_array& other) { return *this = *this / other; }
+    constexpr my_aligned_array& operator*=(T s) { return *this = *this * s; }
+    constexpr my_aligned_array& operator/=(T s) { return *this = *this / s; }
+
+    // a * b + c element by element, fused into one instruction where the
+    // target has FMA and floating-point contraction is on, GCC's default
+    friend constexpr my_aligned_array fma(const my_aligned_array& a, const my_aligned_array& b,
+                                          const my_aligned_array& c) {
+        my_aligned_array result;
+        const bool in_registers = vectorized && !std::is_constant_evaluated();
+#if defined(__GNUC__)
+        if constexpr (vectorized) {
+            if (in_registers) {
+                for (size_t r = 0; r < registers; ++r) {
+                    result.reg(r) = a.reg(r) * b.reg(r) + c.reg(r);
+                }
+            }
+        }
+#endif
+        for (size_t i = scalar_begin(in_registers); i < N; ++i) {
+            result.data_[i] = a.data_[i] * b.data_[i] + c.data_[i];
+        }
+        return result;
+    }
+
+    friend constexpr my_aligned_array min(const my_aligned_array& a, const my_aligned_array& b) {
+        return zip(a, b, lesser);
+    }
+
+    friend constexpr my_aligned_array max(const my_aligned_array& a, const my_aligned_array& b) {
+        return zip(a, b, greater);
+    }
+
+    // the reductions
+
+    constexpr T sum() const { return reduce(plus); }
+    constexpr T min() const { return reduce(lesser); }
+    constexpr T max() const { return reduce(greater); }
+
+    constexpr T dot(const my_aligned_array& other) const { return (*this * other).sum(); }
+
+    // the Euclidean length
+    T norm() const requires std::is_floating_point_v<T> { return std::sqrt(dot(*this)); }
+};
+
+#endif // MY_ALIGNED_ARRAY_H
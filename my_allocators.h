@@ -0,0 +1,347 @@
+#ifndef MY_ALLOCATORS_H
+#define MY_ALLOCATORS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Bump-pointer arena. deallocate is a no-op, all memory handed out since the
+// last reset is reclaimed at once by reset() in O(1). Chunks obtained from the
+// upstream resource are kept for reuse until release() or destruction.
+class my_arena final : public std::pmr::memory_resource {
+private:
+    struct chunk {
+        chunk* next;
+        size_t size;
+    };
+
+    std::pmr::memory_resource* upstream_;
+    size_t next_chunk_size_;
+    chunk* chunks_;     // chunks in use, the current one first
+    chunk* spare_;      // chunks kept by reset()
+    std::byte* cur_;
+    std::byte* end_;
+
+    static constexpr size_t header_size = (sizeof(chunk) + alignof(std::max_align_t) - 1) &
+                                          ~(alignof(std::max_align_t) - 1);
+
+    void add_chunk(size_t min_bytes, size_t alignment) {
+        const size_t needed = header_size + min_bytes + alignment;
+
+        chunk** prev = &spare_;
+        for (chunk* c = spare_; c; prev = &c->next, c = c->next) {
+            if (c->size >= needed) {
+                *prev = c->next;
+                use_chunk(c);
+                return;
+            }
+        }
+
+        const size_t size = std::max(needed, next_chunk_size_);
+        auto* c = static_cast<chunk*>(upstream_->allocate(size, alignof(std::max_align_t)));
+        c->size = size;
+        next_chunk_size_ = size * 2;
+        use_chunk(c);
+    }
+
+    void use_chunk(chunk* c) noexcept {
+        c->next = chunks_;
+        chunks_ = c;
+        cur_ = reinterpret_cast<std::byte*>(c) + header_size;
+        end_ = reinterpret_cast<std::byte*>(c) + c->size;
+    }
+
+    static void free_list(std::pmr::memory_resource* upstream, chunk* c) noexcept {
+        while (c) {
+            chunk* next = c->next;
+            upstream->deallocate(c, c->size, alignof(std::max_align_t));
+            c = next;
+        }
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        auto aligned = (reinterpret_cast<uintptr_t>(cur_) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+        if (!cur_ || aligned + bytes > reinterpret_cast<uintptr_t>(end_)) {
+            add_chunk(bytes, alignment);
+            aligned = (reinterpret_cast<uintptr_t>(cur_) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+        }
+
+        cur_ = reinterpret_cast<std::byte*>(aligned + bytes);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit my_arena(size_t initial_chunk_size = 64 * 1024,
+                      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream), next_chunk_size_(std::max(initial_chunk_size, header_size + 1)),
+          chunks_(nullptr), spare_(nullptr), cur_(nullptr), end_(nullptr) {}
+
+    my_arena(const my_arena&) = delete;
+    my_arena& operator=(const my_arena&) = delete;
+
+    ~my_arena() override {
+        release();
+    }
+
+    // invalidates everything allocated so far, keeps the chunks for reuse
+    void reset() noexcept {
+        if (!chunks_) return;
+
+        chunk* last = chunks_;
+        while (last->next) {
+            last = last->next;
+        }
+        last->next = spare_;
+        spare_ = chunks_;
+        chunks_ = nullptr;
+        cur_ = nullptr;
+        end_ = nullptr;
+    }
+
+    // invalidates everything allocated so far and returns the chunks upstream
+    void release() noexcept {
+        free_list(upstream_, chunks_);
+        free_list(upstream_, spare_);
+        chunks_ = nullptr;
+        spare_ = nullptr;
+        cur_ = nullptr;
+        end_ = nullptr;
+    }
+};
+
+// Size-class pool: blocks up to max_block_size bytes are rounded up to a
+// power of two and recycled through per-class free lists, so repeated
+// allocate/deallocate of similar sizes never reaches the upstream resource.
+// Larger blocks go straight to upstream. Slabs for the classes are carved
+// from an internal my_arena and are returned all at once by release().
+class my_pool final : public std::pmr::memory_resource {
+public:
+    static constexpr size_t min_block_size = 16;
+    static constexpr size_t max_block_size = 64 * 1024;
+    static constexpr size_t max_block_alignment = 4096;
+
+private:
+    static constexpr size_t class_count = 13; // 16 B .. 64 KiB
+
+    struct free_block {
+        free_block* next;
+    };
+
+    std::pmr::memory_resource* upstream_;
+    my_arena slabs_;
+    free_block* free_[class_count] = {};
+
+    static size_t class_index(size_t bytes) noexcept {
+        size_t index = 0;
+        for (size_t size = min_block_size; size < bytes; size *= 2) {
+            ++index;
+        }
+        return index;
+    }
+
+    static size_t class_size(size_t index) noexcept {
+        return min_block_size << index;
+    }
+
+    void refill(size_t index) {
+        const size_t block = class_size(index);
+        const size_t count = std::max<size_t>(1, 16 * 1024 / block);
+        auto* slab = static_cast<std::byte*>(slabs_.allocate(block * count, std::min(block, max_block_alignment)));
+
+        for (size_t i = count; i-- > 0;) {
+            auto* b = reinterpret_cast<free_block*>(slab + i * block);
+            b->next = free_[index];
+            free_[index] = b;
+        }
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        const size_t size = std::max(bytes, alignment);
+        if (size > max_block_size || alignment > max_block_alignment) {
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        const size_t index = class_index(size);
+        if (!free_[index]) {
+            refill(index);
+        }
+
+        free_block* b = free_[index];
+        free_[index] = b->next;
+        return b;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        const size_t size = std::max(bytes, alignment);
+        if (size > max_block_size || alignment > max_block_alignment) {
+            upstream_->deallocate(ptr, bytes, alignment);
+            return;
+        }
+
+        const size_t index = class_index(size);
+        auto* b = static_cast<free_block*>(ptr);
+        b->next = free_[index];
+        free_[index] = b;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit my_pool(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream), slabs_(64 * 1024, upstream) {}
+
+    my_pool(const my_pool&) = delete;
+    my_pool& operator=(const my_pool&) = delete;
+
+    // drops every pooled block at once; blocks larger than max_block_size
+    // must have been deallocated individually
+    void release() noexcept {
+        slabs_.release();
+        std::fill(free_, free_ + class_count, nullptr);
+    }
+};
+
+// Allocator handing out memory from a resource such as my_arena or my_pool.
+// Both are final, so calls through Resource* are devirtualized, unlike with
+// std::pmr::polymorphic_allocator.
+template <typename T, typename Resource>
+class my_resource_allocator {
+private:
+    template <typename U, typename R>
+    friend class my_resource_allocator;
+
+    Resource* resource_;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    my_resource_allocator(Resource& resource) noexcept : resource_(&resource) {}
+
+    template <typename U>
+    my_resource_allocator(const my_resource_allocator<U, Resource>& other) noexcept
+        : resource_(other.resource_) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(resource_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+        resource_->deallocate(ptr, count * sizeof(T), alignof(T));
+    }
+
+    Resource* resource() const noexcept { return resource_; }
+
+    template <typename U>
+    bool operator==(const my_resource_allocator<U, Resource>& other) const noexcept {
+        return resource_ == other.resource_;
+    }
+};
+
+template <typename T>
+using my_arena_allocator = my_resource_allocator<T, my_arena>;
+
+template <typename T>
+using my_pool_allocator = my_resource_allocator<T, my_pool>;
+
+template <typename T>
+struct my_allocation_result {
+    T* ptr;
+    size_t count;
+};
+
+// malloc/realloc/free based allocator. allocate_at_least reports the real
+// usable size of the block (malloc_usable_size on glibc), and reallocate lets
+// realloc extend a block in place, or move large mmap-backed blocks with
+// mremap instead of copying them.
+template <typename T>
+class my_malloc_allocator {
+private:
+    static constexpr bool over_aligned = alignof(T) > alignof(std::max_align_t);
+
+    static size_t usable_count(void* ptr, size_t count) noexcept {
+#if defined(__GLIBC__)
+        return std::max(count, malloc_usable_size(ptr) / sizeof(T));
+#else
+        (void)ptr;
+        return count;
+#endif
+    }
+
+    static void check_length(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+    }
+
+public:
+    using value_type = T;
+
+    my_malloc_allocator() noexcept = default;
+
+    template <typename U>
+    my_malloc_allocator(const my_malloc_allocator<U>&) noexcept {}
+
+    T* allocate(size_t count) {
+        return allocate_at_least(count).ptr;
+    }
+
+    my_allocation_result<T> allocate_at_least(size_t count) {
+        check_length(count);
+        void* ptr;
+        if constexpr (over_aligned) {
+            const size_t bytes = (count * sizeof(T) + alignof(T) - 1) & ~(alignof(T) - 1);
+            ptr = std::aligned_alloc(alignof(T), bytes);
+        } else {
+            ptr = std::malloc(count * sizeof(T));
+        }
+
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return {static_cast<T*>(ptr), usable_count(ptr, count)};
+    }
+
+    // moves the bytes of the block along if it cannot grow in place, so T
+    // must be trivially relocatable; realloc has no aligned counterpart
+    my_allocation_result<T> reallocate(T* ptr, size_t, size_t new_count) requires(!over_aligned) {
+        check_length(new_count);
+        void* result = std::realloc(ptr, std::max<size_t>(new_count, 1) * sizeof(T));
+        if (!result) {
+            throw std::bad_alloc();
+        }
+        return {static_cast<T*>(result), usable_count(result, new_count)};
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        std::free(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const my_malloc_allocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+#endif // MY_ALLOCATORS_H
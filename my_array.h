@@ -6,6 +6,11 @@
 #include <iterator>
 #include <stdexcept>
 #include <algorithm>
+#include <compare>
+#include <initializer_list>
+#include <type_traits>
+
+#include "my_simd.h"
 
 template <typename T, size_t N>
 class my_array {
@@ -13,58 +18,73 @@ private:
     T data_[N];
 public:
     constexpr my_array() = default;
-    my_array(std::initializer_list<T> ilist) {
-        auto it = ilist.begin();
-        for (size_t i = 0; i < N && it != ilist.end(); ++i, ++it) {
-            data_[i] = *it;
-        }
-    };
+    // elements past the end of the list are value-initialized, as in std::array
+    constexpr my_array(std::initializer_list<T> ilist) : my_array(ilist.begin(), ilist.end()) {}
 
     template<typename InIt>
-    my_array(InIt first, InIt last) {
-        auto it = first;
-        for (size_t i = 0; i < N && it != last; ++i, ++it) {
+    constexpr my_array(InIt first, InIt last) {
+        size_t i = 0;
+        for (auto it = first; i < N && it != last; ++i, ++it) {
             data_[i] = *it;
         }
+        for (; i < N; ++i) {
+            data_[i] = T();
+        }
     }
 
     constexpr my_array(const my_array& other) = default;
     constexpr ~my_array() = default;
 
-    my_array& operator=(const my_array& other) = default;
-    auto operator<=>(const my_array&) const = default;
+    constexpr my_array& operator=(const my_array& other) = default;
+
+    constexpr bool operator==(const my_array& other) const {
+        if constexpr (my_simd::is_vectorizable_v<T>) {
+            return my_simd::equal(data_, other.data_, N);
+        } else {
+            return std::equal(data_, data_ + N, other.data_);
+        }
+    }
+
+    constexpr auto operator<=>(const my_array& other) const requires std::three_way_comparable<T> {
+        if constexpr (my_simd::is_vectorizable_v<T>) {
+            const size_t i = my_simd::mismatch(data_, other.data_, N);
+            return i == N ? std::compare_three_way_result_t<T>::equivalent : data_[i] <=> other.data_[i];
+        } else {
+            return std::lexicographical_compare_three_way(data_, data_ + N, other.data_, other.data_ + N);
+        }
+    }
 
     // access without bounds checking
-    T& operator[](size_t idx) { return data_[idx]; }
-    const T& operator[](size_t idx) const { return data_[idx]; }
+    constexpr T& operator[](size_t idx) { return data_[idx]; }
+    constexpr const T& operator[](size_t idx) const { return data_[idx]; }
 
-    T* begin() { return data_; }
-    T* end() { return data_ + N; }
+    constexpr T* begin() { return data_; }
+    constexpr T* end() { return data_ + N; }
 
-    const T* begin() const { return data_; }
-    const T* end() const { return data_ + N; }
+    constexpr const T* begin() const { return data_; }
+    constexpr const T* end() const { return data_ + N; }
 
-    const T* cbegin() const { return data_; }
-    const T* cend() const { return data_ + N; }
+    constexpr const T* cbegin() const { return data_; }
+    constexpr const T* cend() const { return data_ + N; }
 
-    std::reverse_iterator<T*> rbegin() { return std::reverse_iterator<T*>(end()); }
-    std::reverse_iterator<T*> rend() { return std::reverse_iterator<T*>(begin()); }
+    constexpr std::reverse_iterator<T*> rbegin() { return std::reverse_iterator<T*>(end()); }
+    constexpr std::reverse_iterator<T*> rend() { return std::reverse_iterator<T*>(begin()); }
 
-    const std::reverse_iterator<const T*> rbegin() const { return std::reverse_iterator<const T*>(end()); }
-    const std::reverse_iterator<const T*> rend() const { return std::reverse_iterator<const T*>(begin()); }
+    constexpr const std::reverse_iterator<const T*> rbegin() const { return std::reverse_iterator<const T*>(end()); }
+    constexpr const std::reverse_iterator<const T*> rend() const { return std::reverse_iterator<const T*>(begin()); }
 
-    const std::reverse_iterator<const T*> crbegin() const { return std::reverse_iterator<const T*>(end()); }
-    const std::reverse_iterator<const T*> crend() const { return std::reverse_iterator<const T*>(begin()); }
+    constexpr const std::reverse_iterator<const T*> crbegin() const { return std::reverse_iterator<const T*>(end()); }
+    constexpr const std::reverse_iterator<const T*> crend() const { return std::reverse_iterator<const T*>(begin()); }
 
     // access with bounds checking
-    T& at(size_t idx) {
+    constexpr T& at(size_t idx) {
         if (idx >= N) {
             throw std::out_of_range("my_array::at: index out of range");
         }
         return data_[idx];
     };
 
-    const T& at(size_t idx) const {
+    constexpr const T& at(size_t idx) const {
         if (idx >= N) {
             throw std::out_of_range("my_array::at: index out of range");
         }
@@ -77,18 +97,17 @@ public:
     constexpr T* data() { return data_; }
     constexpr const T* data() const { return data_; }
 
-    T& front() { return data_[0]; }
-    const T& front() const { return data_[0]; }
+    constexpr T& front() { return data_[0]; }
+    constexpr const T& front() const { return data_[0]; }
 
-    T& back() { return data_[N-1]; }
-    const T& back() const { return data_[N-1]; }
+    constexpr T& back() { return data_[N-1]; }
+    constexpr const T& back() const { return data_[N-1]; }
 
-    void fill(const T& value) { std::fill(begin(), end(), value); }
+    constexpr void fill(const T& value) { std::fill(begin(), end(), value); }
 
-    void swap(my_array& other) noexcept {
-        for (size_t i = 0; i < N; i++) {
-            std::swap(data_[i], other.data_[i]);
-        }
+    // swap_ranges over the raw elements, which compilers vectorize for numbers
+    constexpr void swap(my_array& other) noexcept(std::is_nothrow_swappable_v<T>) {
+        std::swap_ranges(data_, data_ + N, other.data_);
     }
 };
 
@@ -0,0 +1,444 @@
+#ifndef MY_BITVECTOR_H
+#define MY_BITVECTOR_H
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "my_simd.h"
+#include "my_vector.h"
+
+// Vector of bools packed 64 to a word. operator[] and the iterators yield a
+// proxy for a single bit; the bulk operations work a word at a time and
+// count, find_first/find_next and &, |, ^, ~ between vectors run on the
+// my_simd kernels. The bits of the last word past size() are kept zero, so
+// whole words can be counted and compared.
+template <typename Allocator = std::allocator<bool>>
+class my_bitvector {
+public:
+    using word_type = uint64_t;
+    static constexpr size_t word_bits = 64;
+
+private:
+    using word_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<word_type>;
+
+    my_vector<word_type, word_allocator> words_;
+    size_t size_ = 0;
+
+    static constexpr size_t words_for(size_t bits) noexcept {
+        return (bits + word_bits - 1) / word_bits;
+    }
+
+    static constexpr word_type bit_mask(size_t pos) noexcept {
+        return word_type(1) << (pos % word_bits);
+    }
+
+    // bits [bit, word_bits) of a word
+    static constexpr word_type mask_from(size_t bit) noexcept {
+        return ~word_type(0) << bit;
+    }
+
+    // zeroes the bits of the last word past size_
+    void trim() noexcept {
+        if (size_ % word_bits) {
+            words_.back() &= ~mask_from(size_ % word_bits);
+        }
+    }
+
+    void check_range(size_t first, size_t last, const char* what) const {
+        if (first > last || last > size_) {
+            throw std::out_of_range(what);
+        }
+    }
+
+    void check_same_size(const my_bitvector& other, const char* what) const {
+        if (size_ != other.size_) {
+            throw std::invalid_argument(what);
+        }
+    }
+
+    // calls f(word, mask) for the words covering [first, last), mask selecting
+    // the bits of the word inside the range
+    template <typename F>
+    void for_range(size_t first, size_t last, F&& f) {
+        if (first == last) {
+            return;
+        }
+        size_t w = first / word_bits;
+        const size_t last_w = (last - 1) / word_bits;
+        const word_type head = mask_from(first % word_bits);
+        const word_type tail = ~word_type(0) >> (word_bits - 1 - (last - 1) % word_bits);
+        if (w == last_w) {
+            f(words_[w], head & tail);
+            return;
+        }
+        f(words_[w], head);
+        for (++w; w < last_w; ++w) {
+            f(words_[w], ~word_type(0));
+        }
+        f(words_[last_w], tail);
+    }
+
+public:
+    using value_type = bool;
+    using allocator_type = Allocator;
+
+    // proxy for one bit; assigning writes the bit, it never rebinds
+    class reference {
+    private:
+        friend class my_bitvector;
+
+        word_type* word_;
+        word_type mask_;
+
+        reference(word_type* word, word_type mask) noexcept : word_(word), mask_(mask) {}
+
+    public:
+        reference(const reference&) noexcept = default;
+
+        const reference& operator=(bool value) const noexcept {
+            if (value) {
+                *word_ |= mask_;
+            } else {
+                *word_ &= ~mask_;
+            }
+            return *this;
+        }
+
+        const reference& operator=(const reference& other) const noexcept {
+            return *this = static_cast<bool>(other);
+        }
+
+        operator bool() const noexcept { return (*word_ & mask_) != 0; }
+        bool operator~() const noexcept { return !static_cast<bool>(*this); }
+
+        void flip() const noexcept { *word_ ^= mask_; }
+
+        friend void swap(const reference& lhs, const reference& rhs) noexcept {
+            const bool value = lhs;
+            lhs = static_cast<bool>(rhs);
+            rhs = value;
+        }
+    };
+
+    using const_reference = bool;
+
+    template <bool Const>
+    class basic_iterator {
+    private:
+        friend class my_bitvector;
+
+        using word_ptr = std::conditional_t<Const, const word_type*, word_type*>;
+
+        word_ptr words_ = nullptr;
+        std::ptrdiff_t index_ = 0;
+
+        basic_iterator(word_ptr words, std::ptrdiff_t index) noexcept : words_(words), index_(index) {}
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = bool;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::conditional_t<Const, bool, typename my_bitvector::reference>;
+
+        basic_iterator() noexcept = default;
+
+        // iterator to const_iterator
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+            : words_(other.words_), index_(other.index_) {}
+
+        reference operator*() const noexcept {
+            const size_t pos = static_cast<size_t>(index_);
+            if constexpr (Const) {
+                return (words_[pos / word_bits] & bit_mask(pos)) != 0;
+            } else {
+                return reference(words_ + pos / word_bits, bit_mask(pos));
+            }
+        }
+
+        reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        basic_iterator& operator++() noexcept { ++index_; return *this; }
+        basic_iterator operator++(int) noexcept { basic_iterator old = *this; ++index_; return old; }
+        basic_iterator& operator--() noexcept { --index_; return *this; }
+        basic_iterator operator--(int) noexcept { basic_iterator old = *this; --index_; return old; }
+
+        basic_iterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+        basic_iterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+
+        friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept { return it -= n; }
+
+        friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            return lhs.index_ - rhs.index_;
+        }
+
+        friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend std::strong_ordering operator<=>(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+        template <bool>
+        friend class basic_iterator;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    my_bitvector() noexcept(noexcept(Allocator())) : my_bitvector(Allocator()) {}
+
+    explicit my_bitvector(const Allocator& alloc) noexcept : words_(word_allocator(alloc)) {}
+
+    explicit my_bitvector(size_t count, bool value = false, const Allocator& alloc = Allocator())
+        : my_bitvector(alloc) {
+        resize(count, value);
+    }
+
+    my_bitvector(std::initializer_list<bool> ilist, const Allocator& alloc = Allocator()) : my_bitvector(alloc) {
+        reserve(ilist.size());
+        for (bool value : ilist) {
+            push_back(value);
+        }
+    }
+
+    my_bitvector(const my_bitvector&) = default;
+
+    my_bitvector(my_bitvector&& other) noexcept
+        : words_(std::move(other.words_)), size_(std::exchange(other.size_, 0)) {}
+
+    my_bitvector& operator=(const my_bitvector&) = default;
+
+    my_bitvector& operator=(my_bitvector&& other) noexcept(std::is_nothrow_move_assignable_v<my_vector<word_type, word_allocator>>) {
+        if (this != &other) {
+            words_ = std::move(other.words_);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(words_.get_allocator()); }
+
+    reference operator[](size_t idx) noexcept { return reference(&words_[idx / word_bits], bit_mask(idx)); }
+    bool operator[](size_t idx) const noexcept { return test(idx); }
+
+    reference at(size_t idx) {
+        if (idx >= size_) {
+            throw std::out_of_range("my_bitvector::at: index out of range");
+        }
+        return (*this)[idx];
+    }
+
+    bool at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("my_bitvector::at: index out of range");
+        }
+        return test(idx);
+    }
+
+    bool test(size_t idx) const noexcept { return (words_[idx / word_bits] & bit_mask(idx)) != 0; }
+
+    reference front() noexcept { return (*this)[0]; }
+    bool front() const noexcept { return test(0); }
+
+    reference back() noexcept { return (*this)[size_ - 1]; }
+    bool back() const noexcept { return test(size_ - 1); }
+
+    iterator begin() noexcept { return iterator(words_.data(), 0); }
+    const_iterator begin() const noexcept { return const_iterator(words_.data(), 0); }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return iterator(words_.data(), static_cast<std::ptrdiff_t>(size_)); }
+    const_iterator end() const noexcept { return const_iterator(words_.data(), static_cast<std::ptrdiff_t>(size_)); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // the packed bits, word i holding bits [64 i, 64 i + 64) from the least
+    // significant bit up
+    std::span<const word_type> words() const noexcept { return {words_.data(), words_.size()}; }
+
+    bool is_empty() const noexcept { return size_ == 0; }
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return words_.capacity() * word_bits; }
+
+    void reserve(size_t new_cap) {
+        words_.reserve(words_for(new_cap));
+    }
+
+    void shrink_to_fit() {
+        words_.shrink_to_fit();
+    }
+
+    void clear() noexcept {
+        words_.clear();
+        size_ = 0;
+    }
+
+    void resize(size_t count, bool value = false) {
+        const size_t old_size = size_;
+        words_.resize(words_for(count), 0);
+        size_ = count;
+        if (count > old_size) {
+            if (value) {
+                set(old_size, count);
+            }
+        } else {
+            trim();
+        }
+    }
+
+    void push_back(bool value) {
+        if (size_ % word_bits == 0) {
+            words_.push_back(0);
+        }
+        if (value) {
+            words_.back() |= bit_mask(size_);
+        }
+        ++size_;
+    }
+
+    void pop_back() {
+        if (size_ > 0) {
+            --size_;
+            if (size_ % word_bits == 0) {
+                words_.pop_back();
+            } else {
+                trim();
+            }
+        }
+    }
+
+    void set(size_t idx) noexcept { words_[idx / word_bits] |= bit_mask(idx); }
+    void reset(size_t idx) noexcept { words_[idx / word_bits] &= ~bit_mask(idx); }
+    void flip(size_t idx) noexcept { words_[idx / word_bits] ^= bit_mask(idx); }
+
+    // [first, last) at once; throw std::out_of_range unless first <= last <= size()
+
+    void set(size_t first, size_t last, bool value = true) {
+        check_range(first, last, "my_bitvector::set: range out of bounds");
+        if (value) {
+            for_range(first, last, [](word_type& word, word_type mask) { word |= mask; });
+        } else {
+            reset(first, last);
+        }
+    }
+
+    void reset(size_t first, size_t last) {
+        check_range(first, last, "my_bitvector::reset: range out of bounds");
+        for_range(first, last, [](word_type& word, word_type mask) { word &= ~mask; });
+    }
+
+    void flip(size_t first, size_t last) {
+        check_range(first, last, "my_bitvector::flip: range out of bounds");
+        for_range(first, last, [](word_type& word, word_type mask) { word ^= mask; });
+    }
+
+    // all bits
+
+    void set() noexcept {
+        std::fill(words_.begin(), words_.end(), ~word_type(0));
+        trim();
+    }
+
+    void reset() noexcept {
+        std::fill(words_.begin(), words_.end(), word_type(0));
+    }
+
+    void flip() noexcept {
+        my_simd::bit_not(words_.data(), words_.data(), words_.size());
+        trim();
+    }
+
+    // number of set bits
+    size_t count() const noexcept { return my_simd::popcount(words_.data(), words_.size()); }
+
+    bool all() const noexcept { return count() == size_; }
+    bool any() const noexcept { return find_first() != size_; }
+    bool none() const noexcept { return !any(); }
+
+    // index of the first set bit, size() if there is none
+    size_t find_first() const noexcept { return find_next(0); }
+
+    // index of the first set bit at pos or after, size() if there is none
+    size_t find_next(size_t pos) const noexcept {
+        if (pos >= size_) {
+            return size_;
+        }
+        size_t w = pos / word_bits;
+        const word_type word = words_[w] & mask_from(pos % word_bits);
+        if (word) {
+            return w * word_bits + static_cast<size_t>(std::countr_zero(word));
+        }
+        ++w;
+        w += my_simd::find_nonzero(words_.data() + w, words_.size() - w);
+        if (w == words_.size()) {
+            return size_;
+        }
+        return w * word_bits + static_cast<size_t>(std::countr_zero(words_[w]));
+    }
+
+    // the bitwise operators throw std::invalid_argument if the sizes differ
+
+    my_bitvector& operator&=(const my_bitvector& other) {
+        check_same_size(other, "my_bitvector::operator&=: sizes differ");
+        my_simd::bit_and(words_.data(), other.words_.data(), words_.data(), words_.size());
+        return *this;
+    }
+
+    my_bitvector& operator|=(const my_bitvector& other) {
+        check_same_size(other, "my_bitvector::operator|=: sizes differ");
+        my_simd::bit_or(words_.data(), other.words_.data(), words_.data(), words_.size());
+        return *this;
+    }
+
+    my_bitvector& operator^=(const my_bitvector& other) {
+        check_same_size(other, "my_bitvector::operator^=: sizes differ");
+        my_simd::bit_xor(words_.data(), other.words_.data(), words_.data(), words_.size());
+        return *this;
+    }
+
+    my_bitvector operator~() const {
+        my_bitvector result(*this);
+        result.flip();
+        return result;
+    }
+
+    friend my_bitvector operator&(my_bitvector lhs, const my_bitvector& rhs) {
+        lhs &= rhs;
+        return lhs;
+    }
+    friend my_bitvector operator|(my_bitvector lhs, const my_bitvector& rhs) {
+        lhs |= rhs;
+        return lhs;
+    }
+    friend my_bitvector operator^(my_bitvector lhs, const my_bitvector& rhs) {
+        lhs ^= rhs;
+        return lhs;
+    }
+
+    void swap(my_bitvector& other) noexcept {
+        words_.swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    friend void swap(my_bitvector& lhs, my_bitvector& rhs) noexcept { lhs.swap(rhs); }
+
+    bool operator==(const my_bitvector& other) const {
+        return size_ == other.size_ && words_ == other.words_;
+    }
+};
+
+#endif // MY_BITVECTOR_H
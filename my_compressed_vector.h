@@ -0,0 +1,526 @@
+#ifndef MY_COMPRESSED_VECTOR_H
+#define MY_COMPRESSED_VECTOR_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "my_array.h"
+#include "my_simd.h"
+#include "my_vector.h"
+
+// Read-optimized vector of integers for ID and timestamp columns, kept
+// compressed in blocks of 128 values. Each block is stored in whichever of
+// three encodings is smallest for it:
+//
+//   frame_of_reference  value - min of the block, bit-packed at the width of
+//                       max - min; for small or clustered values
+//   delta               zigzag-encoded differences to the previous value,
+//                       bit-packed; for sorted and slowly changing values
+//   delta_varint        the same differences as LEB128 varints; for mostly
+//                       small differences with a few large ones
+//
+// A skip index with one entry per block locates a block in O(1). An element
+// of a frame-of-reference block is then read in O(1) as well, the others
+// decode their block up to it. Decoding works on 16-byte vectors: unpacking
+// is instantiated for every bit width and the delta encodings add up their
+// differences with an in-register prefix sum. Iterate with for_each or the
+// iterators, which decode a block at a time; values are appended to an
+// uncompressed tail that is encoded once it holds a full block.
+template <typename T>
+class my_compressed_vector {
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                  "my_compressed_vector: T must be an integer type");
+
+public:
+    static constexpr size_t block_size = 128;
+
+    enum class encoding : uint8_t { frame_of_reference, delta, delta_varint };
+
+private:
+    using U = std::make_unsigned_t<T>;
+    static constexpr size_t bits = std::numeric_limits<U>::digits;
+
+    // Bit-packed values are laid out vertically, as in SIMD-BP128: value i
+    // goes to lane i % lanes of a 16-byte vector, and each lane fills its own
+    // stream of U words with width bits per value. A block packs into width
+    // vectors exactly, and unpacking shifts and masks whole vectors.
+    static constexpr size_t vector_bytes = 16;
+    static constexpr size_t lanes = vector_bytes / sizeof(U);
+    using vec = my_simd::detail::vec_t<U, vector_bytes>;
+    using unaligned_vec = typename my_simd::detail::unaligned_vec<U, vector_bytes>::type;
+
+    struct block_info {
+        U base;          // the minimum, or the first value for the delta encodings
+        uint32_t offset; // of the encoded values in data_, relative to the block's offsets_high_ entry
+        uint8_t kind;
+        uint8_t width;   // bits per value when bit-packed
+    };
+
+    my_vector<block_info> index_;
+    my_vector<uint64_t> offsets_high_; // data_ offset of every 2^16th block, so block_info needs only 32 bits
+    my_vector<uint8_t> data_;
+    my_vector<T> tail_;
+    size_t size_ = 0;
+
+    static U zigzag(U delta) noexcept {
+        using S = std::make_signed_t<U>;
+        const S s = static_cast<S>(delta);
+        return static_cast<U>(static_cast<U>(s) << 1) ^ static_cast<U>(s < 0 ? ~U(0) : U(0));
+    }
+
+    static U unzigzag(U z) noexcept {
+        return static_cast<U>((z >> 1) ^ (U(0) - (z & 1)));
+    }
+
+    template <size_t W>
+    static constexpr U mask = W == bits ? U(~U(0)) : static_cast<U>((U(1) << W) - 1);
+
+    static U load_word(const uint8_t* in, size_t word, size_t lane) noexcept {
+        U value;
+        std::memcpy(&value, in + (word * lanes + lane) * sizeof(U), sizeof(U));
+        return value;
+    }
+
+    static void or_word(uint8_t* out, size_t word, size_t lane, U bits_to_set) noexcept {
+        const U value = static_cast<U>(load_word(out, word, lane) | bits_to_set);
+        std::memcpy(out + (word * lanes + lane) * sizeof(U), &value, sizeof(U));
+    }
+
+    // value idx of a block packed at width W
+    template <size_t W>
+    static U extract(const uint8_t* in, size_t idx) noexcept {
+        if constexpr (W == 0) {
+            return 0;
+        } else {
+            const size_t lane = idx % lanes;
+            const size_t pos = idx / lanes * W;
+            const size_t shift = pos % bits;
+            U value = static_cast<U>(load_word(in, pos / bits, lane) >> shift);
+            if (shift + W > bits) {
+                value |= static_cast<U>(load_word(in, pos / bits + 1, lane) << (bits - shift));
+            }
+            return static_cast<U>(value & mask<W>);
+        }
+    }
+
+    // the whole block, lanes values per step
+    template <size_t W>
+    static void unpack(const uint8_t* in, U* out) noexcept {
+        if constexpr (W == 0) {
+            std::fill(out, out + block_size, U(0));
+        } else {
+            const unaligned_vec* words = reinterpret_cast<const unaligned_vec*>(in);
+            for (size_t k = 0; k < block_size / lanes; ++k) {
+                const size_t pos = k * W;
+                const size_t shift = pos % bits;
+                vec value = words[pos / bits] >> shift;
+                if (shift + W > bits) {
+                    value |= words[pos / bits + 1] << (bits - shift);
+                }
+                value &= mask<W>;
+                std::memcpy(out + k * lanes, &value, vector_bytes);
+            }
+        }
+    }
+
+    using unpack_fn = void (*)(const uint8_t*, U*) noexcept;
+    using extract_fn = U (*)(const uint8_t*, size_t) noexcept;
+
+    template <size_t... W>
+    static constexpr my_array<unpack_fn, bits + 1> make_unpackers(std::index_sequence<W...>) {
+        return {&unpack<W>...};
+    }
+
+    template <size_t... W>
+    static constexpr my_array<extract_fn, bits + 1> make_extractors(std::index_sequence<W...>) {
+        return {&extract<W>...};
+    }
+
+    // one kernel per width, picked by the block's width
+    static unpack_fn unpacker(size_t width) noexcept {
+        static constexpr my_array<unpack_fn, bits + 1> table = make_unpackers(std::make_index_sequence<bits + 1>());
+        return table[width];
+    }
+
+    static extract_fn extractor(size_t width) noexcept {
+        static constexpr my_array<extract_fn, bits + 1> table = make_extractors(std::make_index_sequence<bits + 1>());
+        return table[width];
+    }
+
+    static size_t varint_bytes(U value) noexcept {
+        return std::max<size_t>(1, (std::bit_width(value) + 6) / 7);
+    }
+
+    static size_t packed_bytes(size_t width) noexcept {
+        return block_size / 8 * width;
+    }
+
+    const uint8_t* block_data(size_t block) const noexcept {
+        const uint64_t high = offsets_high_[block >> 16];
+        return data_.data() + high + index_[block].offset;
+    }
+
+    // appends the bytes of one block to data_, zeroed, and records its entry
+    uint8_t* add_block(U base, encoding kind, size_t width, size_t bytes) {
+        const size_t block = index_.size();
+        const size_t offset = data_.size();
+        const bool new_high = block % (size_t(1) << 16) == 0;
+        if (new_high) {
+            offsets_high_.push_back(offset);
+        }
+        // 2^16 blocks of at most block_size * 10 bytes stay below 2^32
+        const uint64_t relative = offset - offsets_high_.back();
+        try {
+            index_.push_back({base, static_cast<uint32_t>(relative), static_cast<uint8_t>(kind),
+                              static_cast<uint8_t>(width)});
+            try {
+                // resize allocates exactly, so grow geometrically here
+                const size_t needed = offset + bytes;
+                if (needed > data_.capacity()) {
+                    data_.reserve(std::max(needed, data_.capacity() * 2));
+                }
+                data_.resize(needed);
+            } catch (...) {
+                index_.pop_back();
+                throw;
+            }
+        } catch (...) {
+            if (new_high) offsets_high_.pop_back();
+            throw;
+        }
+        return data_.data() + offset;
+    }
+
+    static void pack(uint8_t* out, const U* values, size_t width) noexcept {
+        if (width == 0) {
+            return;
+        }
+        for (size_t i = 0; i < block_size; ++i) {
+            const size_t lane = i % lanes;
+            const size_t pos = i / lanes * width;
+            const size_t shift = pos % bits;
+            or_word(out, pos / bits, lane, static_cast<U>(values[i] << shift));
+            if (shift + width > bits) {
+                or_word(out, pos / bits + 1, lane, static_cast<U>(values[i] >> (bits - shift)));
+            }
+        }
+    }
+
+    // compresses block_size values in the smallest encoding
+    void encode_block(const T* values) {
+        U offsets[block_size];
+        U deltas[block_size];
+
+        U low = static_cast<U>(values[0]);
+        U high = low;
+        for (size_t i = 0; i < block_size; ++i) {
+            const T v = values[i];
+            if (v < static_cast<T>(low)) low = static_cast<U>(v);
+            if (v > static_cast<T>(high)) high = static_cast<U>(v);
+        }
+        U delta_max = 0;
+        size_t varint_size = 0;
+        deltas[0] = 0;
+        for (size_t i = 0; i < block_size; ++i) {
+            offsets[i] = static_cast<U>(static_cast<U>(values[i]) - low);
+            if (i > 0) {
+                deltas[i] = zigzag(static_cast<U>(static_cast<U>(values[i]) - static_cast<U>(values[i - 1])));
+            }
+            delta_max = std::max(delta_max, deltas[i]);
+            varint_size += varint_bytes(deltas[i]);
+        }
+
+        const size_t for_width = std::bit_width(static_cast<U>(high - low));
+        const size_t delta_width = std::bit_width(delta_max);
+        const size_t for_size = packed_bytes(for_width);
+        const size_t delta_size = packed_bytes(delta_width);
+
+        // frame of reference on ties, its elements are read in O(1)
+        if (for_size <= delta_size && for_size <= varint_size) {
+            pack(add_block(low, encoding::frame_of_reference, for_width, for_size), offsets, for_width);
+        } else if (delta_size <= varint_size) {
+            pack(add_block(static_cast<U>(values[0]), encoding::delta, delta_width, delta_size), deltas, delta_width);
+        } else {
+            uint8_t* out = add_block(static_cast<U>(values[0]), encoding::delta_varint, 0, varint_size);
+            for (size_t i = 0; i < block_size; ++i) {
+                U value = deltas[i];
+                while (value >= 0x80) {
+                    *out++ = static_cast<uint8_t>(value | 0x80);
+                    value >>= 7;
+                }
+                *out++ = static_cast<uint8_t>(value);
+            }
+        }
+    }
+
+    static U read_varint(const uint8_t*& in) noexcept {
+        U value = 0;
+        for (size_t shift = 0;; shift += 7) {
+            const uint8_t byte = *in++;
+            value |= static_cast<U>(static_cast<U>(byte & 0x7f) << shift);
+            if (byte < 0x80) return value;
+        }
+    }
+
+    // the zigzag differences of a delta block, the first of them 0
+    void unpack_deltas(const block_info& info, const uint8_t* in, U* deltas, size_t count) const noexcept {
+        if (static_cast<encoding>(info.kind) == encoding::delta) {
+            unpacker(info.width)(in, deltas);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                deltas[i] = read_varint(in);
+            }
+        }
+    }
+
+    // the lanes of x shifted up by K, zeros shifted in
+    template <size_t K, size_t... I>
+    static vec shift_lanes(vec x, std::index_sequence<I...>) noexcept {
+        return __builtin_shufflevector(vec{}, x, (I < K ? I : lanes + I - K)...);
+    }
+
+    template <size_t... I>
+    static vec broadcast_last(vec x, std::index_sequence<I...>) noexcept {
+        return __builtin_shufflevector(x, x, ((void)I, lanes - 1)...);
+    }
+
+    template <size_t... K>
+    static vec prefix_lanes(vec x, std::index_sequence<K...>) noexcept {
+        ((x += shift_lanes<(size_t(1) << K)>(x, std::make_index_sequence<lanes>())), ...);
+        return x;
+    }
+
+    // out[i] = base + the unzigzagged deltas[0..i], a vector at a time:
+    // log2(lanes) shifted adds within it, then the running total of the ones before
+    static void prefix_sum(const U* deltas, T* out, U base) noexcept {
+        vec carry = vec{} + base;
+        for (size_t i = 0; i < block_size; i += lanes) {
+            vec x;
+            std::memcpy(&x, deltas + i, vector_bytes);
+            x = (x >> 1) ^ (vec{} - (x & 1));
+            x = prefix_lanes(x, std::make_index_sequence<std::bit_width(lanes) - 1>()) + carry;
+            std::memcpy(out + i, &x, vector_bytes);
+            carry = broadcast_last(x, std::make_index_sequence<lanes>());
+        }
+    }
+
+    void decode_full_block(size_t block, T* out) const noexcept {
+        const block_info& info = index_[block];
+        const uint8_t* in = block_data(block);
+        U values[block_size];
+        if (static_cast<encoding>(info.kind) == encoding::frame_of_reference) {
+            unpacker(info.width)(in, values);
+            for (size_t i = 0; i < block_size; ++i) {
+                out[i] = static_cast<T>(static_cast<U>(values[i] + info.base));
+            }
+            return;
+        }
+        unpack_deltas(info, in, values, block_size);
+        prefix_sum(values, out, info.base);
+    }
+
+    T get(size_t idx) const noexcept {
+        const size_t block = idx / block_size;
+        if (block >= index_.size()) {
+            return tail_[idx - index_.size() * block_size];
+        }
+        const block_info& info = index_[block];
+        const uint8_t* in = block_data(block);
+        const size_t pos = idx % block_size;
+        if (static_cast<encoding>(info.kind) == encoding::frame_of_reference) {
+            return static_cast<T>(static_cast<U>(extractor(info.width)(in, pos) + info.base));
+        }
+        // the differences up to pos
+        U deltas[block_size];
+        unpack_deltas(info, in, deltas, pos + 1);
+        U running = info.base;
+        for (size_t i = 1; i <= pos; ++i) {
+            running = static_cast<U>(running + unzigzag(deltas[i]));
+        }
+        return static_cast<T>(running);
+    }
+
+public:
+    using value_type = T;
+
+    // Forward iterator yielding the values, with the decoded block inside:
+    // cheap to advance, about block_size values to copy.
+    class const_iterator {
+    private:
+        friend class my_compressed_vector;
+
+        const my_compressed_vector* owner_ = nullptr;
+        size_t index_ = 0;
+        my_array<T, block_size> block_;
+
+        const_iterator(const my_compressed_vector* owner, size_t index) noexcept : owner_(owner), index_(index) {
+            load();
+        }
+
+        void load() noexcept {
+            const size_t block = index_ / block_size;
+            if (block < owner_->index_.size()) {
+                owner_->decode_full_block(block, block_.data());
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = T;
+        using pointer = void;
+
+        const_iterator() noexcept = default;
+
+        T operator*() const noexcept {
+            const size_t block = index_ / block_size;
+            if (block < owner_->index_.size()) {
+                return block_[index_ % block_size];
+            }
+            return owner_->tail_[index_ - owner_->index_.size() * block_size];
+        }
+
+        const_iterator& operator++() noexcept {
+            if (++index_ % block_size == 0) {
+                load();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+            return a.index_ == b.index_;
+        }
+    };
+
+    using iterator = const_iterator;
+
+    my_compressed_vector() = default;
+
+    template <typename Allocator, typename GrowthPolicy>
+    explicit my_compressed_vector(const my_vector<T, Allocator, GrowthPolicy>& values) {
+        append_range(values);
+    }
+
+    my_compressed_vector(std::initializer_list<T> ilist) { append_range(ilist); }
+
+    size_t size() const noexcept { return size_; }
+    bool is_empty() const noexcept { return size_ == 0; }
+
+    // full blocks, the ones in the skip index; the last size() % block_size
+    // values are not compressed yet
+    size_t block_count() const noexcept { return index_.size(); }
+    encoding block_encoding(size_t block) const noexcept { return static_cast<encoding>(index_[block].kind); }
+
+    // the bytes of the compressed blocks, the skip index and the tail
+    size_t memory_bytes() const noexcept {
+        return data_.size() + index_.size() * sizeof(block_info) + offsets_high_.size() * sizeof(uint64_t) +
+               tail_.size() * sizeof(T);
+    }
+
+    // access without bounds checking
+    T operator[](size_t idx) const noexcept { return get(idx); }
+
+    T at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("my_compressed_vector::at: index out of range");
+        }
+        return get(idx);
+    }
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept {
+        const_iterator it;
+        it.owner_ = this;
+        it.index_ = size_;
+        return it;
+    }
+
+    // f(value) for every value in order, decoding a block at a time
+    template <typename F>
+    void for_each(F&& f) const {
+        T values[block_size];
+        for (size_t block = 0; block < index_.size(); ++block) {
+            decode_full_block(block, values);
+            for (size_t i = 0; i < block_size; ++i) {
+                f(values[i]);
+            }
+        }
+        for (const T& value : tail_) {
+            f(value);
+        }
+    }
+
+    void push_back(T value) {
+        if (tail_.size() + 1 == block_size) {
+            tail_.reserve(block_size);
+            tail_.push_back_unchecked(value);
+            try {
+                encode_block(tail_.data());
+            } catch (...) {
+                tail_.pop_back();
+                throw;
+            }
+            tail_.clear();
+        } else {
+            tail_.push_back(value);
+        }
+        ++size_;
+    }
+
+    template <std::ranges::input_range R>
+    void append_range(R&& range) {
+        for (auto&& value : range) {
+            push_back(static_cast<T>(value));
+        }
+    }
+
+    my_vector<T> to_vector() const {
+        my_vector<T> result(size_);
+        for (size_t block = 0; block < index_.size(); ++block) {
+            decode_full_block(block, result.data() + block * block_size);
+        }
+        std::copy(tail_.begin(), tail_.end(), result.begin() + index_.size() * block_size);
+        return result;
+    }
+
+    void clear() noexcept {
+        index_.clear();
+        offsets_high_.clear();
+        data_.clear();
+        tail_.clear();
+        size_ = 0;
+    }
+
+    void shrink_to_fit() {
+        index_.shrink_to_fit();
+        offsets_high_.shrink_to_fit();
+        data_.shrink_to_fit();
+        tail_.shrink_to_fit();
+    }
+
+    bool operator==(const my_compressed_vector& other) const {
+        if (size_ != other.size_) {
+            return false;
+        }
+        return std::equal(begin(), end(), other.begin());
+    }
+};
+
+#endif // MY_COMPRESSED_VECTOR_H
@@ -0,0 +1,297 @@
+#ifndef MY_CONCURRENT_QUEUE_H
+#define MY_CONCURRENT_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "my_ring_buffer.h"
+
+// Distance between data written by different threads. 64 bytes is the cache
+// line of x86-64 and most ARM cores; std::hardware_destructive_interference_size
+// is not used, GCC warns that it may differ between compiler flags.
+inline constexpr size_t my_cache_line_size = 64;
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread, on a power-of-two ring of slots. The head and the tail sit on
+// cache lines of their own, each next to the owner's cached copy of the other
+// index, so a push or a pop touches the other side's line only when the
+// queue looks full or empty. try_push_n/try_pop_n move a batch with a single
+// index update.
+template <typename T, size_t N = my_dynamic_capacity>
+class my_spsc_queue {
+    static_assert(N == my_dynamic_capacity || std::has_single_bit(N),
+                  "my_spsc_queue: the capacity must be a power of two");
+
+private:
+    my_ring_storage<T, N> slots_;
+    size_t mask_;
+
+    // the consumer's line
+    alignas(my_cache_line_size) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // the producer's line
+    alignas(my_cache_line_size) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+
+    // the free slots for the producer, at least wanted of them if possible
+    size_t free_slots(size_t tail, size_t wanted) {
+        size_t free = capacity() - (tail - cached_head_);
+        if (free < wanted) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free = capacity() - (tail - cached_head_);
+        }
+        return free;
+    }
+
+    // the filled slots for the consumer, likewise
+    size_t filled_slots(size_t head, size_t wanted) {
+        size_t filled = cached_tail_ - head;
+        if (filled < wanted) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            filled = cached_tail_ - head;
+        }
+        return filled;
+    }
+
+public:
+    using value_type = T;
+
+    my_spsc_queue() requires (N != my_dynamic_capacity) : mask_(N - 1) {}
+
+    // capacity is rounded up to a power of two
+    explicit my_spsc_queue(size_t capacity) requires (N == my_dynamic_capacity)
+        : slots_(my_ring_capacity(capacity)), mask_(slots_.size() - 1) {}
+
+    my_spsc_queue(const my_spsc_queue&) = delete;
+    my_spsc_queue& operator=(const my_spsc_queue&) = delete;
+
+    size_t capacity() const noexcept { return mask_ + 1; }
+
+    // exact only while neither side is active
+    size_t size_approx() const noexcept {
+        const size_t head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+    // producer side; false when full
+    template <typename U>
+    bool try_push(U&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (free_slots(tail, 1) == 0) {
+            return false;
+        }
+        slots_[tail & mask_] = std::forward<U>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: copies up to n elements from first, as many as fit, and
+    // returns how many; wrap std::make_move_iterator around first to move them.
+    template <typename InputIt>
+    size_t try_push_n(InputIt first, size_t n) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        n = std::min(n, free_slots(tail, n));
+        for (size_t i = 0; i < n; ++i, ++first) {
+            slots_[(tail + i) & mask_] = *first;
+        }
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // consumer side; false when empty
+    bool try_pop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (filled_slots(head, 1) == 0) {
+            return false;
+        }
+        out = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side: moves up to n elements to out and returns how many
+    template <typename OutputIt>
+    size_t try_pop_n(OutputIt out, size_t n) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        n = std::min(n, filled_slots(head, n));
+        for (size_t i = 0; i < n; ++i, ++out) {
+            *out = std::move(slots_[(head + i) & mask_]);
+        }
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+};
+
+// Bounded lock-free queue for any number of producers and consumers, after
+// Dmitry Vyukov's design: every slot carries a sequence number saying whose
+// turn it is, producers claim positions by advancing the tail and consumers by
+// advancing the head with a compare-exchange, and each then hands its slot on
+// by publishing the next sequence number. Claiming is lock-free, but a thread
+// stalled between claiming and publishing holds back the threads that reach
+// its slot one lap later.
+//
+// A slot cannot be given back once claimed, so moving into and out of slots
+// must not throw: try_push makes its copy before claiming, and try_push_n
+// requires an iterator whose elements assign without throwing.
+template <typename T, size_t N = my_dynamic_capacity>
+class my_mpmc_queue {
+    static_assert(N == my_dynamic_capacity || std::has_single_bit(N),
+                  "my_mpmc_queue: the capacity must be a power of two");
+    static_assert(std::is_nothrow_move_assignable_v<T>,
+                  "my_mpmc_queue: T must be nothrow move assignable");
+
+private:
+    struct cell {
+        // pos when free for the producer of position pos, pos + 1 once filled
+        std::atomic<size_t> sequence{0};
+        T value;
+
+        cell() = default;
+
+        // for my_vector's growth path, which the fixed-size ring never takes
+        cell(cell&& other) noexcept
+            : sequence(other.sequence.load(std::memory_order_relaxed)), value(std::move(other.value)) {}
+    };
+
+    my_ring_storage<cell, N> cells_;
+    size_t mask_;
+
+    alignas(my_cache_line_size) std::atomic<size_t> head_{0};
+    alignas(my_cache_line_size) std::atomic<size_t> tail_{0};
+
+    void init_sequences() noexcept {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Claims up to n consecutive positions whose cells have the sequence
+    // expected(pos) from the index counter, returning the first one and setting n to
+    // the count claimed, 0 if the queue is full or empty.
+    template <typename Expected>
+    size_t claim(std::atomic<size_t>& counter, size_t& n, Expected expected) {
+        size_t pos = counter.load(std::memory_order_relaxed);
+        if (n == 0) {
+            return pos;
+        }
+        for (;;) {
+            size_t ready = 0;
+            while (ready < n && cells_[(pos + ready) & mask_].sequence.load(std::memory_order_acquire) ==
+                                    expected(pos + ready)) {
+                ++ready;
+            }
+            if (ready == 0) {
+                const size_t seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - expected(pos)) < 0) {
+                    // a lap behind: full for producers, empty for consumers
+                    n = 0;
+                    return pos;
+                }
+                // another thread took pos
+                pos = counter.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (counter.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                n = ready;
+                return pos;
+            }
+        }
+    }
+
+    size_t claim_push(size_t& n) {
+        return claim(tail_, n, [](size_t pos) { return pos; });
+    }
+
+    size_t claim_pop(size_t& n) {
+        return claim(head_, n, [](size_t pos) { return pos + 1; });
+    }
+
+public:
+    using value_type = T;
+
+    my_mpmc_queue() requires (N != my_dynamic_capacity) : mask_(N - 1) {
+        init_sequences();
+    }
+
+    // capacity is rounded up to a power of two
+    explicit my_mpmc_queue(size_t capacity) requires (N == my_dynamic_capacity)
+        : cells_(my_ring_capacity(capacity)), mask_(cells_.size() - 1) {
+        init_sequences();
+    }
+
+    my_mpmc_queue(const my_mpmc_queue&) = delete;
+    my_mpmc_queue& operator=(const my_mpmc_queue&) = delete;
+
+    size_t capacity() const noexcept { return mask_ + 1; }
+
+    // counts claimed positions, exact only while no thread is active
+    size_t size_approx() const noexcept {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    // false when full
+    template <typename U>
+    bool try_push(U&& value) {
+        T item(std::forward<U>(value));
+        size_t n = 1;
+        const size_t pos = claim_push(n);
+        if (n == 0) {
+            return false;
+        }
+        cell& c = cells_[pos & mask_];
+        c.value = std::move(item);
+        c.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Copies up to n elements from first into consecutive slots, as many as
+    // are free, and returns how many; wrap std::make_move_iterator around
+    // first to move them.
+    template <typename InputIt>
+    size_t try_push_n(InputIt first, size_t n) {
+        static_assert(std::is_nothrow_assignable_v<T&, std::iter_reference_t<InputIt>>,
+                      "my_mpmc_queue::try_push_n: assigning the elements must not throw");
+        const size_t pos = claim_push(n);
+        for (size_t i = 0; i < n; ++i, ++first) {
+            cell& c = cells_[(pos + i) & mask_];
+            c.value = *first;
+            c.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // false when empty
+    bool try_pop(T& out) {
+        size_t n = 1;
+        const size_t pos = claim_pop(n);
+        if (n == 0) {
+            return false;
+        }
+        cell& c = cells_[pos & mask_];
+        out = std::move(c.value);
+        c.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // moves up to n elements from consecutive slots to out, which must not
+    // throw, and returns how many
+    template <typename OutputIt>
+    size_t try_pop_n(OutputIt out, size_t n) {
+        const size_t pos = claim_pop(n);
+        for (size_t i = 0; i < n; ++i, ++out) {
+            cell& c = cells_[(pos + i) & mask_];
+            *out = std::move(c.value);
+            c.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        return n;
+    }
+};
+
+#endif // MY_CONCURRENT_QUEUE_H
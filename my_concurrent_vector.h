@@ -0,0 +1,365 @@
+#ifndef MY_CONCURRENT_VECTOR_H
+#define MY_CONCURRENT_VECTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "my_vector.h"
+
+// Vector that many threads can append to at once, with elements that never
+// move. The storage is a table of segments that double in size, the first
+// one holding about 512 bytes; a segment is allocated the first time an
+// index in it is claimed, so growing never touches the existing elements and
+// pointers, references and indices stay valid until clear().
+//
+// push_back/emplace_back/grow_by claim indices with one atomic increment and
+// construct the elements in place (a second counter tracks the appends in
+// flight, see holes below); a missing segment is installed with a
+// compare-exchange, the loser of a race frees its copy. operator[], at and the
+// iterators may run concurrently with appends. size() counts claimed slots,
+// some of which may still be under construction: read an element only once the
+// append that made it happened-before the read, e.g. after joining the writer
+// or receiving the index from it through a synchronizing channel.
+//
+// An append whose constructor or segment allocation throws has already
+// claimed its indices; they stay claimed as a hole, counted by size() but
+// holding no element, and the exception reaches the caller unchanged. Once
+// has_holes() is true, skip the indices for which is_hole(idx) is true when
+// reading, iterating included.
+//
+// The allocator is used from several threads at once and must allow that.
+template <typename T, typename Allocator = std::allocator<T>>
+class my_concurrent_vector {
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "my_concurrent_vector: Allocator::value_type must be T");
+
+    // log2 of the first segment size, about 512 bytes of elements
+    static constexpr size_t first_shift = std::bit_width(std::max<size_t>(512 / sizeof(T), 1)) - 1;
+    static constexpr size_t max_segments = std::numeric_limits<size_t>::digits - first_shift;
+
+    struct location {
+        size_t segment;
+        size_t offset;
+    };
+
+    std::atomic<T*> segments_[max_segments] = {};
+    std::atomic<size_t> size_{0};
+    [[no_unique_address]] Allocator alloc_;
+
+    // claimed index ranges left without elements by a throwing constructor.
+    // holes_ keeps room for an entry per append in flight, so that recording
+    // a hole never allocates.
+    mutable std::mutex holes_mutex_;
+    my_vector<std::pair<size_t, size_t>> holes_;
+    std::atomic<size_t> hole_room_{0};
+    std::atomic<size_t> in_flight_{0};
+    std::atomic<bool> has_holes_{false};
+
+    static constexpr size_t segment_size(size_t segment) noexcept {
+        return size_t(1) << (first_shift + segment);
+    }
+
+    static constexpr size_t segment_base(size_t segment) noexcept {
+        return segment_size(segment) - segment_size(0);
+    }
+
+    static location locate(size_t index) noexcept {
+        const size_t segment = std::bit_width((index >> first_shift) + 1) - 1;
+        return {segment, index - segment_base(segment)};
+    }
+
+    // the storage of a segment, allocated if no thread did so yet
+    T* segment(size_t segment) {
+        T* storage = segments_[segment].load(std::memory_order_acquire);
+        if (storage) {
+            return storage;
+        }
+
+        T* fresh = alloc_traits::allocate(alloc_, segment_size(segment));
+        if (segments_[segment].compare_exchange_strong(storage, fresh, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+            return fresh;
+        }
+        alloc_traits::deallocate(alloc_, fresh, segment_size(segment));
+        return storage;
+    }
+
+    T* slot(size_t index) const noexcept {
+        const location loc = locate(index);
+        return segments_[loc.segment].load(std::memory_order_acquire) + loc.offset;
+    }
+
+    // calls f(ptr, n) for the storage of [first, first + count), once per segment
+    template <typename F>
+    void for_each_block(size_t first, size_t count, F&& f) {
+        while (count > 0) {
+            const location loc = locate(first);
+            const size_t n = std::min(count, segment_size(loc.segment) - loc.offset);
+            f(segment(loc.segment) + loc.offset, n);
+            first += n;
+            count -= n;
+        }
+    }
+
+    void destroy(size_t first, size_t count) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for_each_block(first, count, [this](T* ptr, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    alloc_traits::destroy(alloc_, ptr + i);
+                }
+            });
+        }
+    }
+
+    // makes room in holes_ for the append about to claim its indices
+    void reserve_hole_entry() {
+        const size_t needed = in_flight_.fetch_add(1) + 1;
+        if (needed > hole_room_.load()) {
+            std::lock_guard<std::mutex> lock(holes_mutex_);
+            // leave room for the constructions that started meanwhile as well
+            const size_t wanted = in_flight_.load();
+            if (wanted > holes_.capacity() - holes_.size()) {
+                try {
+                    holes_.reserve(holes_.size() + 2 * wanted);
+                } catch (...) {
+                    in_flight_.fetch_sub(1);
+                    throw;
+                }
+                hole_room_.store(holes_.capacity() - holes_.size());
+            }
+        }
+    }
+
+    // Claims count indices and constructs them with make(ptr); returns the
+    // first index. If anything throws after the claim, be it make or a
+    // segment allocation, the range is given up as a hole and the exception
+    // passes on. The room for that entry is set aside before claiming, so
+    // recording it cannot fail.
+    template <typename Construct>
+    size_t claim(size_t count, Construct&& make) {
+        reserve_hole_entry();
+        const size_t first = size_.fetch_add(count, std::memory_order_relaxed);
+        size_t done = 0;
+        try {
+            for_each_block(first, count, [&](T* ptr, size_t n) {
+                for (size_t i = 0; i < n; ++i, ++done) {
+                    make(ptr + i);
+                }
+            });
+        } catch (...) {
+            destroy(first, done);
+            {
+                std::lock_guard<std::mutex> lock(holes_mutex_);
+                holes_.push_back({first, first + count});
+                hole_room_.fetch_sub(1);
+                has_holes_.store(true, std::memory_order_release);
+            }
+            in_flight_.fetch_sub(1);
+            throw;
+        }
+        in_flight_.fetch_sub(1);
+        return first;
+    }
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    template <bool Const>
+    class basic_iterator {
+    private:
+        using owner_t = std::conditional_t<Const, const my_concurrent_vector, my_concurrent_vector>;
+
+        owner_t* owner_ = nullptr;
+        size_t index_ = 0;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        basic_iterator() noexcept = default;
+        basic_iterator(owner_t* owner, size_t index) noexcept : owner_(owner), index_(index) {}
+
+        // iterator to const_iterator
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+            : owner_(other.owner_), index_(other.index_) {}
+
+        reference operator*() const noexcept { return (*owner_)[index_]; }
+        pointer operator->() const noexcept { return &(*owner_)[index_]; }
+        reference operator[](difference_type n) const noexcept { return (*owner_)[index_ + n]; }
+
+        basic_iterator& operator++() noexcept { ++index_; return *this; }
+        basic_iterator operator++(int) noexcept { basic_iterator old = *this; ++index_; return old; }
+        basic_iterator& operator--() noexcept { --index_; return *this; }
+        basic_iterator operator--(int) noexcept { basic_iterator old = *this; --index_; return old; }
+
+        basic_iterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+        basic_iterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+
+        friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept { return it -= n; }
+
+        friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend std::strong_ordering operator<=>(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+        template <bool>
+        friend class basic_iterator;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    my_concurrent_vector() noexcept(noexcept(Allocator())) : my_concurrent_vector(Allocator()) {}
+
+    explicit my_concurrent_vector(const Allocator& alloc) noexcept : alloc_(alloc) {}
+
+    // the segments live at fixed addresses other threads may hold on to
+    my_concurrent_vector(const my_concurrent_vector&) = delete;
+    my_concurrent_vector& operator=(const my_concurrent_vector&) = delete;
+
+    ~my_concurrent_vector() {
+        clear();
+        for (size_t k = 0; k < max_segments; ++k) {
+            if (T* storage = segments_[k].load(std::memory_order_relaxed)) {
+                alloc_traits::deallocate(alloc_, storage, segment_size(k));
+            }
+        }
+    }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+    T& operator[](size_t idx) noexcept { return *slot(idx); }
+    const T& operator[](size_t idx) const noexcept { return *slot(idx); }
+
+    T& at(size_t idx) {
+        if (idx >= size()) {
+            throw std::out_of_range("my_concurrent_vector::at: index out of range");
+        }
+        return *slot(idx);
+    }
+
+    const T& at(size_t idx) const {
+        if (idx >= size()) {
+            throw std::out_of_range("my_concurrent_vector::at: index out of range");
+        }
+        return *slot(idx);
+    }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+
+    iterator end() noexcept { return iterator(this, size()); }
+    const_iterator end() const noexcept { return const_iterator(this, size()); }
+    const_iterator cend() const noexcept { return const_iterator(this, size()); }
+
+    bool is_empty() const noexcept { return size() == 0; }
+
+    // whether an append threw and left a hole since the last clear()
+    bool has_holes() const noexcept { return has_holes_.load(std::memory_order_acquire); }
+
+    // whether idx was claimed by an append that threw and holds no element
+    bool is_hole(size_t idx) const {
+        if (!has_holes()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(holes_mutex_);
+        return std::any_of(holes_.begin(), holes_.end(), [idx](const std::pair<size_t, size_t>& hole) {
+            return hole.first <= idx && idx < hole.second;
+        });
+    }
+    size_t size() const noexcept { return size_.load(std::memory_order_acquire); }
+
+    // elements that fit before the first segment not allocated yet
+    size_t capacity() const noexcept {
+        size_t k = 0;
+        while (k < max_segments && segments_[k].load(std::memory_order_acquire)) {
+            ++k;
+        }
+        return segment_base(k);
+    }
+
+    // allocates the segments holding the first new_cap elements; thread-safe
+    void reserve(size_t new_cap) {
+        for (size_t k = 0; k < max_segments && segment_base(k) < new_cap; ++k) {
+            segment(k);
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        T* ptr = nullptr;
+        claim(1, [&](T* p) {
+            alloc_traits::construct(alloc_, p, std::forward<Args>(args)...);
+            ptr = p;
+        });
+        return *ptr;
+    }
+
+    T& push_back(const T& value) {
+        return emplace_back(value);
+    }
+
+    T& push_back(T&& value) {
+        return emplace_back(std::move(value));
+    }
+
+    // appends count default-constructed elements with consecutive indices;
+    // returns the index of the first one
+    size_t grow_by(size_t count) {
+        return claim(count, [this](T* ptr) {
+            alloc_traits::construct(alloc_, ptr);
+        });
+    }
+
+    size_t grow_by(size_t count, const T& value) {
+        return claim(count, [&](T* ptr) {
+            alloc_traits::construct(alloc_, ptr, value);
+        });
+    }
+
+    // not thread-safe; destroys the elements and keeps the segments
+    void clear() noexcept {
+        std::sort(holes_.begin(), holes_.end());
+        size_t next = 0;
+        for (const auto& [first, last] : holes_) {
+            destroy(next, first - next);
+            next = last;
+        }
+        destroy(next, size() - next);
+
+        holes_.clear();
+        hole_room_.store(holes_.capacity());
+        has_holes_.store(false, std::memory_order_relaxed);
+        size_.store(0, std::memory_order_relaxed);
+    }
+};
+
+#endif // MY_CONCURRENT_VECTOR_H
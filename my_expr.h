@@ -0,0 +1,285 @@
+#ifndef MY_EXPR_H
+#define MY_EXPR_H
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "my_simd.h"
+#include "my_vector.h"
+
+// Lazy element-wise arithmetic on my_vectors of numbers. An operator on
+// vectors, numbers and expressions only records its operands:
+//
+//     my_vector<double> a = b * c + d;       // one pass, no temporaries
+//     a = my_expr::sqrt(a * 0.5 + 1.0);      // may read the destination
+//     double total = my_expr::sum(b * c);    // no vector at all
+//
+// Assigning the expression to a my_vector evaluates it in a single loop over
+// the indices, which the compiler can vectorize; the reductions sum, min and
+// max run over it the same way. An expression refers to the vectors it was
+// built from, except to temporaries, which it takes over: it must not
+// outlive its named operands, and it reads them when evaluated, not when
+// built. Combining vectors of different sizes throws std::invalid_argument.
+namespace my_expr {
+
+template <typename T>
+struct is_my_vector : std::false_type {};
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+struct is_my_vector<my_vector<T, Allocator, GrowthPolicy>> : std::true_type {};
+
+// the expression nodes below, recognized by my_vector's assignment as well
+template <typename E>
+concept expression = requires { typename std::remove_cvref_t<E>::my_expression_tag; };
+
+template <typename V>
+concept numeric_vector = is_my_vector<std::remove_cvref_t<V>>::value &&
+                         std::is_arithmetic_v<typename std::remove_cvref_t<V>::value_type>;
+
+template <typename X>
+concept operand = expression<X> || numeric_vector<X>;
+
+template <typename S>
+concept number = std::is_arithmetic_v<std::remove_cvref_t<S>>;
+
+// a vector operand, referenced if it is an lvalue and owned if a temporary
+template <typename V, bool Owning>
+class vector_leaf {
+private:
+    std::conditional_t<Owning, V, const V&> vector_;
+
+public:
+    using my_expression_tag = void;
+    using value_type = typename V::value_type;
+    static constexpr bool sized = true;
+
+    explicit vector_leaf(const V& vector) requires (!Owning) : vector_(vector) {}
+    explicit vector_leaf(V&& vector) requires Owning : vector_(std::move(vector)) {}
+
+    size_t size() const noexcept { return vector_.size(); }
+    value_type operator[](size_t idx) const noexcept { return vector_[idx]; }
+};
+
+// a number standing for every element; it has no size of its own
+template <typename T>
+class scalar_leaf {
+private:
+    T value_;
+
+public:
+    using my_expression_tag = void;
+    using value_type = T;
+    static constexpr bool sized = false;
+
+    explicit scalar_leaf(T value) noexcept : value_(value) {}
+
+    value_type operator[](size_t) const noexcept { return value_; }
+};
+
+template <typename X>
+auto wrap(X&& x) {
+    using plain = std::remove_cvref_t<X>;
+    if constexpr (expression<X>) {
+        return plain(std::forward<X>(x));
+    } else if constexpr (number<X>) {
+        return scalar_leaf<plain>(x);
+    } else if constexpr (std::is_lvalue_reference_v<X>) {
+        return vector_leaf<plain, false>(x);
+    } else {
+        return vector_leaf<plain, true>(std::move(x));
+    }
+}
+
+template <typename X>
+using wrap_t = decltype(wrap(std::declval<X>()));
+
+template <typename Op, typename L, typename R>
+class binary {
+private:
+    L left_;
+    R right_;
+    [[no_unique_address]] Op op_;
+
+public:
+    using my_expression_tag = void;
+    using value_type = std::remove_cvref_t<decltype(std::declval<const Op&>()(
+        std::declval<typename L::value_type>(), std::declval<typename R::value_type>()))>;
+    static constexpr bool sized = L::sized || R::sized;
+
+    binary(L left, R right) : left_(std::move(left)), right_(std::move(right)) {
+        if constexpr (L::sized && R::sized) {
+            if (left_.size() != right_.size()) {
+                throw std::invalid_argument("my_expr: operand sizes differ");
+            }
+        }
+    }
+
+    size_t size() const noexcept {
+        if constexpr (L::sized) {
+            return left_.size();
+        } else {
+            return right_.size();
+        }
+    }
+
+    value_type operator[](size_t idx) const { return op_(left_[idx], right_[idx]); }
+};
+
+template <typename Op, typename E>
+class unary {
+private:
+    E operand_;
+    [[no_unique_address]] Op op_;
+
+public:
+    using my_expression_tag = void;
+    using value_type = std::remove_cvref_t<decltype(std::declval<const Op&>()(
+        std::declval<typename E::value_type>()))>;
+    static constexpr bool sized = E::sized;
+
+    explicit unary(E operand) : operand_(std::move(operand)) {}
+
+    size_t size() const noexcept { return operand_.size(); }
+    value_type operator[](size_t idx) const { return op_(operand_[idx]); }
+};
+
+template <typename Op, typename L, typename R>
+auto make_binary(L&& left, R&& right) {
+    return binary<Op, wrap_t<L>, wrap_t<R>>(wrap(std::forward<L>(left)), wrap(std::forward<R>(right)));
+}
+
+template <typename Op, typename E>
+auto make_unary(E&& operand) {
+    return unary<Op, wrap_t<E>>(wrap(std::forward<E>(operand)));
+}
+
+struct abs_op {
+    template <typename T>
+    auto operator()(T x) const {
+        if constexpr (std::is_unsigned_v<T>) {
+            return x;
+        } else {
+            return std::abs(x);
+        }
+    }
+};
+
+struct sqrt_op {
+    template <typename T>
+    auto operator()(T x) const { return std::sqrt(x); }
+};
+
+struct exp_op {
+    template <typename T>
+    auto operator()(T x) const { return std::exp(x); }
+};
+
+struct log_op {
+    template <typename T>
+    auto operator()(T x) const { return std::log(x); }
+};
+
+template <operand E>
+auto abs(E&& e) { return make_unary<abs_op>(std::forward<E>(e)); }
+
+template <operand E>
+auto sqrt(E&& e) { return make_unary<sqrt_op>(std::forward<E>(e)); }
+
+template <operand E>
+auto exp(E&& e) { return make_unary<exp_op>(std::forward<E>(e)); }
+
+template <operand E>
+auto log(E&& e) { return make_unary<log_op>(std::forward<E>(e)); }
+
+// Reductions over the elements, computed on the fly. Like the my_simd
+// reductions, sum adds integers in (unsigned) long long and floating point
+// in several interleaved partial sums, so the last bits can differ from a
+// sequential loop, and min and max skip NaNs unless every element is one.
+
+template <operand E>
+auto sum(E&& e) {
+    const auto expr = wrap(std::forward<E>(e));
+    using result_t = my_simd::sum_t<typename decltype(expr)::value_type>;
+
+    // independent partial sums, so that floating point needs no reassociation to vectorize
+    constexpr size_t ways = 8;
+    result_t partial[ways] = {};
+    const size_t n = expr.size();
+    size_t i = 0;
+    for (; i + ways <= n; i += ways) {
+        for (size_t k = 0; k < ways; ++k) {
+            partial[k] += static_cast<result_t>(expr[i + k]);
+        }
+    }
+    for (; i < n; ++i) {
+        partial[0] += static_cast<result_t>(expr[i]);
+    }
+    result_t total = 0;
+    for (size_t k = 0; k < ways; ++k) {
+        total += partial[k];
+    }
+    return total;
+}
+
+template <bool Max, typename E>
+auto extremum(const E& expr, const char* what) {
+    my_simd::detail::check_not_empty(expr.size(), what);
+    typename E::value_type best = expr[0];
+    for (size_t i = 1; i < expr.size(); ++i) {
+        const typename E::value_type candidate = expr[i];
+        best = my_simd::detail::replaces<Max>(candidate, best) ? candidate : best;
+    }
+    return best;
+}
+
+// throws std::out_of_range if e is empty
+template <operand E>
+auto min(E&& e) { return extremum<false>(wrap(std::forward<E>(e)), "my_expr::min: empty expression"); }
+
+template <operand E>
+auto max(E&& e) { return extremum<true>(wrap(std::forward<E>(e)), "my_expr::max: empty expression"); }
+
+} // namespace my_expr
+
+// The operators, at global scope beside my_vector so that lookup finds them
+// for vectors as well as for expressions; at least one side must be a vector
+// or an expression, the other may be a number.
+
+template <typename L, typename R>
+concept my_expr_operands = (my_expr::operand<L> && (my_expr::operand<R> || my_expr::number<R>)) ||
+                           (my_expr::number<L> && my_expr::operand<R>);
+
+template <typename L, typename R>
+    requires my_expr_operands<L, R>
+auto operator+(L&& left, R&& right) {
+    return my_expr::make_binary<std::plus<>>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <typename L, typename R>
+    requires my_expr_operands<L, R>
+auto operator-(L&& left, R&& right) {
+    return my_expr::make_binary<std::minus<>>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <typename L, typename R>
+    requires my_expr_operands<L, R>
+auto operator*(L&& left, R&& right) {
+    return my_expr::make_binary<std::multiplies<>>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <typename L, typename R>
+    requires my_expr_operands<L, R>
+auto operator/(L&& left, R&& right) {
+    return my_expr::make_binary<std::divides<>>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <my_expr::operand E>
+auto operator-(E&& e) {
+    return my_expr::make_unary<std::negate<>>(std::forward<E>(e));
+}
+
+#endif // MY_EXPR_H
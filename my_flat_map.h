@@ -0,0 +1,395 @@
+#ifndef MY_FLAT_MAP_H
+#define MY_FLAT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "my_flat_set.h"
+#include "my_vector.h"
+
+// Sorted map with the keys and the values in two separate my_vectors: a
+// lookup binary-searches the keys alone, so the values never pass through
+// the cache until one is found. As with my_flat_set, single insertions shift
+// the larger entries; build big maps with the range constructor or
+// insert_range. Dereferencing an iterator gives a pair of references,
+// std::pair<const Key&, T&>, not a reference to a stored pair.
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename KeyAllocator = std::allocator<Key>, typename MappedAllocator = std::allocator<T>>
+class my_flat_map {
+public:
+    using key_container_type = my_vector<Key, KeyAllocator>;
+    using mapped_container_type = my_vector<T, MappedAllocator>;
+
+private:
+    key_container_type keys_;
+    mapped_container_type values_;
+    [[no_unique_address]] Compare comp_;
+
+    template <bool Const>
+    class basic_iterator {
+    private:
+        friend class my_flat_map;
+
+        using mapped_pointer = std::conditional_t<Const, const T*, T*>;
+
+        const Key* key_ = nullptr;
+        mapped_pointer value_ = nullptr;
+
+        basic_iterator(const Key* key, mapped_pointer value) noexcept : key_(key), value_(value) {}
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using iterator_concept = std::random_access_iterator_tag;
+        using value_type = std::pair<Key, T>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const Key&, std::conditional_t<Const, const T&, T&>>;
+
+        struct pointer {
+            reference ref;
+            const reference* operator->() const noexcept { return &ref; }
+        };
+
+        basic_iterator() noexcept = default;
+
+        // iterator to const_iterator
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        basic_iterator(const basic_iterator<OtherConst>& other) noexcept : key_(other.key_), value_(other.value_) {}
+
+        reference operator*() const noexcept { return {*key_, *value_}; }
+        pointer operator->() const noexcept { return {**this}; }
+        reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        const Key& key() const noexcept { return *key_; }
+        std::conditional_t<Const, const T&, T&> value() const noexcept { return *value_; }
+
+        basic_iterator& operator++() noexcept { ++key_; ++value_; return *this; }
+        basic_iterator operator++(int) noexcept { basic_iterator old = *this; ++*this; return old; }
+        basic_iterator& operator--() noexcept { --key_; --value_; return *this; }
+        basic_iterator operator--(int) noexcept { basic_iterator old = *this; --*this; return old; }
+
+        basic_iterator& operator+=(difference_type n) noexcept { key_ += n; value_ += n; return *this; }
+        basic_iterator& operator-=(difference_type n) noexcept { key_ -= n; value_ -= n; return *this; }
+
+        friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept { return it -= n; }
+        friend difference_type operator-(const basic_iterator& a, const basic_iterator& b) noexcept {
+            return a.key_ - b.key_;
+        }
+
+        friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.key_ == b.key_; }
+        friend auto operator<=>(const basic_iterator& a, const basic_iterator& b) noexcept { return a.key_ <=> b.key_; }
+
+        template <bool>
+        friend class basic_iterator;
+    };
+
+    size_t lower_index(const Key& key) const {
+        return my_branchless_lower_bound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    // the index of key, or size()
+    size_t find_index(const Key& key) const {
+        const size_t idx = lower_index(key);
+        return idx != keys_.size() && !comp_(key, keys_[idx]) ? idx : keys_.size();
+    }
+
+    // Sorts the entries from index old_size on by key and merges them into
+    // the sorted unique prefix in one pass over both columns. Entries already
+    // in the map win over new ones with an equivalent key, and among new
+    // ones the first wins. Leaves the map empty if a comparison or move throws.
+    void merge_tail(size_t old_size, bool tail_sorted) {
+        try {
+            my_vector<size_t> order;
+            order.reserve(keys_.size() - old_size);
+            for (size_t i = old_size; i < keys_.size(); ++i) {
+                order.push_back_unchecked(i);
+            }
+            if (!tail_sorted) {
+                std::stable_sort(order.begin(), order.end(),
+                                 [this](size_t a, size_t b) { return comp_(keys_[a], keys_[b]); });
+            }
+
+            key_container_type keys(keys_.get_allocator());
+            mapped_container_type values(values_.get_allocator());
+            keys.reserve(keys_.size());
+            values.reserve(values_.size());
+
+            auto take = [&](size_t idx) {
+                if (!keys.is_empty() && !comp_(keys.back(), keys_[idx])) {
+                    return;
+                }
+                keys.push_back_unchecked(std::move(keys_[idx]));
+                values.push_back_unchecked(std::move(values_[idx]));
+            };
+
+            size_t i = 0;
+            const size_t* next = order.begin();
+            while (i < old_size && next != order.end()) {
+                if (comp_(keys_[*next], keys_[i])) {
+                    take(*next++);
+                } else {
+                    take(i++);
+                }
+            }
+            while (i < old_size) {
+                take(i++);
+            }
+            while (next != order.end()) {
+                take(*next++);
+            }
+
+            keys_ = std::move(keys);
+            values_ = std::move(values);
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    // on a throw both columns are cut back to old_size
+    template <typename R>
+    void append_entries(size_t old_size, R&& range) {
+        if constexpr (std::ranges::sized_range<R>) {
+            reserve(size() + static_cast<size_t>(std::ranges::size(range)));
+        }
+        try {
+            for (auto&& entry : range) {
+                // moves out of rvalue entries only
+                keys_.emplace_back(std::get<0>(std::forward<decltype(entry)>(entry)));
+                values_.emplace_back(std::get<1>(std::forward<decltype(entry)>(entry)));
+            }
+        } catch (...) {
+            // the appended tail is unsorted, so none of it may stay
+            keys_.erase(keys_.begin() + old_size, keys_.end());
+            values_.erase(values_.begin() + old_size, values_.end());
+            throw;
+        }
+    }
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using key_compare = Compare;
+    using reference = std::pair<const Key&, T&>;
+    using const_reference = std::pair<const Key&, const T&>;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    my_flat_map() = default;
+
+    explicit my_flat_map(const Compare& comp) : comp_(comp) {}
+
+    // sorts the entries by key and drops those with duplicate keys; throws
+    // std::invalid_argument if the columns differ in length
+    my_flat_map(key_container_type keys, mapped_container_type values, const Compare& comp = Compare())
+        : keys_(std::move(keys)), values_(std::move(values)), comp_(comp) {
+        if (keys_.size() != values_.size()) {
+            throw std::invalid_argument("my_flat_map: key and value columns differ in size");
+        }
+        merge_tail(0, false);
+    }
+
+    my_flat_map(my_sorted_unique_t, key_container_type keys, mapped_container_type values,
+                const Compare& comp = Compare())
+        : keys_(std::move(keys)), values_(std::move(values)), comp_(comp) {
+        if (keys_.size() != values_.size()) {
+            throw std::invalid_argument("my_flat_map: key and value columns differ in size");
+        }
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    my_flat_map(InputIt first, InputIt last, const Compare& comp = Compare()) : comp_(comp) {
+        insert(first, last);
+    }
+
+    my_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare()) : comp_(comp) {
+        insert_range(ilist);
+    }
+
+    my_flat_map(my_sorted_unique_t, std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+        : comp_(comp) {
+        append_entries(0, ilist);
+    }
+
+    key_compare key_comp() const { return comp_; }
+
+    const key_container_type& keys() const noexcept { return keys_; }
+    const mapped_container_type& values() const noexcept { return values_; }
+
+    // hands out both columns, leaving the map empty
+    std::pair<key_container_type, mapped_container_type> extract() && {
+        return {std::move(keys_), std::move(values_)};
+    }
+
+    iterator begin() noexcept { return iterator(keys_.begin(), values_.begin()); }
+    iterator end() noexcept { return iterator(keys_.end(), values_.end()); }
+    const_iterator begin() const noexcept { return const_iterator(keys_.begin(), values_.begin()); }
+    const_iterator end() const noexcept { return const_iterator(keys_.end(), values_.end()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool is_empty() const noexcept { return keys_.is_empty(); }
+    size_t size() const noexcept { return keys_.size(); }
+
+    void reserve(size_t new_cap) {
+        keys_.reserve(new_cap);
+        values_.reserve(new_cap);
+    }
+
+    void shrink_to_fit() {
+        keys_.shrink_to_fit();
+        values_.shrink_to_fit();
+    }
+
+    void clear() noexcept {
+        keys_.clear();
+        values_.clear();
+    }
+
+    // the lookups
+
+    iterator lower_bound(const Key& key) { return begin() + lower_index(key); }
+    const_iterator lower_bound(const Key& key) const { return begin() + lower_index(key); }
+
+    iterator upper_bound(const Key& key) {
+        return begin() + my_branchless_upper_bound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    const_iterator upper_bound(const Key& key) const {
+        return begin() + my_branchless_upper_bound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    iterator find(const Key& key) { return begin() + find_index(key); }
+    const_iterator find(const Key& key) const { return begin() + find_index(key); }
+
+    bool contains(const Key& key) const { return find_index(key) != size(); }
+    size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    T& at(const Key& key) {
+        const size_t idx = find_index(key);
+        if (idx == size()) {
+            throw std::out_of_range("my_flat_map::at: key not found");
+        }
+        return values_[idx];
+    }
+
+    const T& at(const Key& key) const {
+        const size_t idx = find_index(key);
+        if (idx == size()) {
+            throw std::out_of_range("my_flat_map::at: key not found");
+        }
+        return values_[idx];
+    }
+
+    // single insertions, O(size()) each
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        const size_t idx = lower_index(key);
+        if (idx != size() && !comp_(key, keys_[idx])) {
+            return {begin() + idx, false};
+        }
+        keys_.emplace(keys_.begin() + idx, std::forward<K>(key));
+        try {
+            values_.emplace(values_.begin() + idx, std::forward<Args>(args)...);
+        } catch (...) {
+            keys_.erase(keys_.begin() + idx);
+            throw;
+        }
+        return {begin() + idx, true};
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> emplace(K&& key, V&& value) {
+        return try_emplace(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& entry) { return try_emplace(entry.first, entry.second); }
+    std::pair<iterator, bool> insert(value_type&& entry) {
+        return try_emplace(std::move(entry.first), std::move(entry.second));
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> insert_or_assign(K&& key, V&& value) {
+        auto result = try_emplace(std::forward<K>(key), std::forward<V>(value));
+        if (!result.second) {
+            result.first.value() = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    T& operator[](const Key& key) { return try_emplace(key).first.value(); }
+    T& operator[](Key&& key) { return try_emplace(std::move(key)).first.value(); }
+
+    // Bulk insertion of (key, value) pairs: appends both columns, sorts the
+    // new entries and merges them in, in O(n log n) for n new entries plus
+    // one pass over the map. Existing keys keep their values. If copying an
+    // entry throws, the map is left as it was; if a comparison or a move
+    // throws while merging, the map is left empty.
+    template <std::ranges::input_range R>
+    void insert_range(R&& range) {
+        const size_t old_size = size();
+        append_entries(old_size, std::forward<R>(range));
+        merge_tail(old_size, false);
+    }
+
+    // the same for entries whose keys are known to be sorted and unique
+    template <std::ranges::input_range R>
+    void insert_range(my_sorted_unique_t, R&& range) {
+        const size_t old_size = size();
+        append_entries(old_size, std::forward<R>(range));
+        merge_tail(old_size, true);
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    void insert(InputIt first, InputIt last) {
+        insert_range(std::ranges::subrange(first, last));
+    }
+
+    void insert(std::initializer_list<value_type> ilist) { insert_range(ilist); }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        const size_t start = first.key_ - keys_.begin();
+        const size_t stop = last.key_ - keys_.begin();
+        keys_.erase(keys_.begin() + start, keys_.begin() + stop);
+        values_.erase(values_.begin() + start, values_.begin() + stop);
+        return begin() + start;
+    }
+
+    size_t erase(const Key& key) {
+        const size_t idx = find_index(key);
+        if (idx == size()) {
+            return 0;
+        }
+        erase(begin() + idx);
+        return 1;
+    }
+
+    void swap(my_flat_map& other) noexcept {
+        keys_.swap(other.keys_);
+        values_.swap(other.values_);
+        std::swap(comp_, other.comp_);
+    }
+
+    friend void swap(my_flat_map& lhs, my_flat_map& rhs) noexcept { lhs.swap(rhs); }
+
+    bool operator==(const my_flat_map& other) const {
+        return keys_ == other.keys_ && values_ == other.values_;
+    }
+};
+
+#endif // MY_FLAT_MAP_H
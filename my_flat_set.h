@@ -0,0 +1,245 @@
+#ifndef MY_FLAT_SET_H
+#define MY_FLAT_SET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <utility>
+
+#include "my_vector.h"
+
+// Tag for the constructors of my_flat_set and my_flat_map taking keys that
+// are already sorted and free of duplicates, which are then used as they are.
+struct my_sorted_unique_t {
+    explicit my_sorted_unique_t() = default;
+};
+
+inline constexpr my_sorted_unique_t my_sorted_unique{};
+
+// Binary search whose loop has no data-dependent branch: each step halves
+// the range with a conditional move, so the CPU never mispredicts; the cost
+// is a fixed log2(n) steps even when an early probe would have matched.
+// index of the first element for which comp(element, key) is false
+template <typename T, typename K, typename Compare>
+size_t my_branchless_lower_bound(const T* data, size_t n, const K& key, Compare& comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = data;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = comp(base[half - 1], key) ? base + half : base;
+        n -= half;
+    }
+    return static_cast<size_t>(base - data) + (comp(*base, key) ? 1 : 0);
+}
+
+// index of the first element for which comp(key, element) is true
+template <typename T, typename K, typename Compare>
+size_t my_branchless_upper_bound(const T* data, size_t n, const K& key, Compare& comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = data;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = comp(key, base[half - 1]) ? base : base + half;
+        n -= half;
+    }
+    return static_cast<size_t>(base - data) + (comp(key, *base) ? 0 : 1);
+}
+
+// Sorted set of unique keys in one contiguous my_vector: lookups are a
+// branchless binary search over adjacent keys, with no pointers to chase.
+// Inserting a single key shifts the larger ones, so build big sets with the
+// range constructor or insert_range, which sort the new keys and merge them
+// in once. Iterators are const: the keys must stay sorted.
+template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class my_flat_set {
+public:
+    using container_type = my_vector<Key, Allocator>;
+
+private:
+    container_type keys_;
+    [[no_unique_address]] Compare comp_;
+
+    bool equivalent(const Key& a, const Key& b) const {
+        return !comp_(a, b) && !comp_(b, a);
+    }
+
+    // sorts the keys from index old_size on and merges them into the sorted
+    // unique prefix; the first of equivalent keys stays
+    void merge_tail(size_t old_size) {
+        try {
+            std::sort(keys_.begin() + old_size, keys_.end(), comp_);
+            std::inplace_merge(keys_.begin(), keys_.begin() + old_size, keys_.end(), comp_);
+            auto last = std::unique(keys_.begin(), keys_.end(),
+                                    [this](const Key& a, const Key& b) { return !comp_(a, b); });
+            keys_.erase(last, keys_.end());
+        } catch (...) {
+            // the order is lost
+            keys_.clear();
+            throw;
+        }
+    }
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using iterator = const Key*;
+    using const_iterator = const Key*;
+
+    my_flat_set() = default;
+
+    explicit my_flat_set(const Compare& comp, const Allocator& alloc = Allocator()) : keys_(alloc), comp_(comp) {}
+
+    // sorts keys and drops the duplicates
+    explicit my_flat_set(container_type keys, const Compare& comp = Compare()) : keys_(std::move(keys)), comp_(comp) {
+        merge_tail(0);
+    }
+
+    my_flat_set(my_sorted_unique_t, container_type keys, const Compare& comp = Compare())
+        : keys_(std::move(keys)), comp_(comp) {}
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    my_flat_set(InputIt first, InputIt last, const Compare& comp = Compare()) : comp_(comp) {
+        insert(first, last);
+    }
+
+    my_flat_set(std::initializer_list<Key> ilist, const Compare& comp = Compare()) : comp_(comp) {
+        insert_range(ilist);
+    }
+
+    my_flat_set(my_sorted_unique_t, std::initializer_list<Key> ilist, const Compare& comp = Compare())
+        : keys_(ilist), comp_(comp) {}
+
+    allocator_type get_allocator() const noexcept { return keys_.get_allocator(); }
+    key_compare key_comp() const { return comp_; }
+
+    const container_type& keys() const noexcept { return keys_; }
+
+    // hands out the sorted keys, leaving the set empty
+    container_type extract() && {
+        return std::move(keys_);
+    }
+
+    iterator begin() const noexcept { return keys_.begin(); }
+    iterator end() const noexcept { return keys_.end(); }
+    const_iterator cbegin() const noexcept { return keys_.begin(); }
+    const_iterator cend() const noexcept { return keys_.end(); }
+
+    std::reverse_iterator<iterator> rbegin() const noexcept { return std::reverse_iterator<iterator>(end()); }
+    std::reverse_iterator<iterator> rend() const noexcept { return std::reverse_iterator<iterator>(begin()); }
+
+    bool is_empty() const noexcept { return keys_.is_empty(); }
+    size_t size() const noexcept { return keys_.size(); }
+    size_t capacity() const noexcept { return keys_.capacity(); }
+
+    void reserve(size_t new_cap) { keys_.reserve(new_cap); }
+    void shrink_to_fit() { keys_.shrink_to_fit(); }
+    void clear() noexcept { keys_.clear(); }
+
+    // the lookups
+
+    iterator lower_bound(const Key& key) const {
+        return begin() + my_branchless_lower_bound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    iterator upper_bound(const Key& key) const {
+        return begin() + my_branchless_upper_bound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key& key) const {
+        const iterator first = lower_bound(key);
+        return {first, first != end() && !comp_(key, *first) ? first + 1 : first};
+    }
+
+    iterator find(const Key& key) const {
+        const iterator it = lower_bound(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    bool contains(const Key& key) const { return find(key) != end(); }
+    size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    // single insertions, O(size()) each
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        Key key(std::forward<Args>(args)...);
+        const iterator it = lower_bound(key);
+        if (it != end() && !comp_(key, *it)) {
+            return {it, false};
+        }
+        return {keys_.insert(it, std::move(key)), true};
+    }
+
+    std::pair<iterator, bool> insert(const Key& key) { return emplace(key); }
+    std::pair<iterator, bool> insert(Key&& key) { return emplace(std::move(key)); }
+
+    // Bulk insertion: appends the keys, sorts them and merges them in, in
+    // O(n log n) for n new keys plus one pass over the set. Keys already in
+    // the set win over equivalent new ones. If a comparison or a move throws,
+    // the set is left empty.
+    template <std::ranges::input_range R>
+    void insert_range(R&& range) {
+        const size_t old_size = keys_.size();
+        keys_.append_range(std::forward<R>(range));
+        merge_tail(old_size);
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    void insert(InputIt first, InputIt last) {
+        insert_range(std::ranges::subrange(first, last));
+    }
+
+    void insert(std::initializer_list<Key> ilist) { insert_range(ilist); }
+
+    // the same for keys known to be sorted and unique
+    template <std::ranges::input_range R>
+    void insert_range(my_sorted_unique_t, R&& range) {
+        const size_t old_size = keys_.size();
+        keys_.append_range(std::forward<R>(range));
+        try {
+            std::inplace_merge(keys_.begin(), keys_.begin() + old_size, keys_.end(), comp_);
+            auto last = std::unique(keys_.begin(), keys_.end(),
+                                    [this](const Key& a, const Key& b) { return equivalent(a, b); });
+            keys_.erase(last, keys_.end());
+        } catch (...) {
+            keys_.clear();
+            throw;
+        }
+    }
+
+    iterator erase(iterator pos) { return keys_.erase(pos); }
+    iterator erase(iterator first, iterator last) { return keys_.erase(first, last); }
+
+    size_t erase(const Key& key) {
+        const iterator it = find(key);
+        if (it == end()) {
+            return 0;
+        }
+        keys_.erase(it);
+        return 1;
+    }
+
+    void swap(my_flat_set& other) noexcept {
+        keys_.swap(other.keys_);
+        std::swap(comp_, other.comp_);
+    }
+
+    friend void swap(my_flat_set& lhs, my_flat_set& rhs) noexcept { lhs.swap(rhs); }
+
+    bool operator==(const my_flat_set& other) const { return keys_ == other.keys_; }
+};
+
+#endif // MY_FLAT_SET_H
@@ -0,0 +1,52 @@
+#ifndef MY_GROWTH_H
+#define MY_GROWTH_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+// Growth policies decide the capacity a container moves to when it runs out
+// of room: next_capacity(capacity, min_capacity, element_size) must return at
+// least min_capacity.
+
+struct my_growth_double {
+    static constexpr size_t next_capacity(size_t capacity, size_t min_capacity, size_t) noexcept {
+        return std::max(capacity ? capacity * 2 : 1, min_capacity);
+    }
+};
+
+// 1.5x keeps at most a third of the buffer unused and lets freed blocks be
+// reused by later growth, at the cost of more reallocations
+struct my_growth_one_and_half {
+    static constexpr size_t next_capacity(size_t capacity, size_t min_capacity, size_t) noexcept {
+        return std::max(capacity ? capacity + (capacity + 1) / 2 : 1, min_capacity);
+    }
+};
+
+// Size of the block malloc actually hands out for a request of bytes:
+// 16-byte steps up to 128 bytes, then four classes per power of two
+// (as in jemalloc and close to glibc bins), whole pages from 128 KiB up,
+// where glibc serves requests with mmap.
+constexpr size_t my_good_malloc_size(size_t bytes) noexcept {
+    constexpr size_t page = 4096;
+    if (bytes <= 128) {
+        return (std::max<size_t>(bytes, 1) + 15) & ~size_t(15);
+    }
+    if (bytes >= 128 * 1024) {
+        return (bytes + page - 1) & ~(page - 1);
+    }
+
+    const size_t step = size_t(1) << (std::bit_width(bytes - 1) - 3);
+    return (bytes + step - 1) & ~(step - 1);
+}
+
+// 1.5x growth rounded up to the malloc size class, so the slack malloc would
+// add anyway becomes usable capacity
+struct my_growth_size_class {
+    static constexpr size_t next_capacity(size_t capacity, size_t min_capacity, size_t element_size) noexcept {
+        const size_t target = my_growth_one_and_half::next_capacity(capacity, min_capacity, element_size);
+        return std::max(target, my_good_malloc_size(target * element_size) / element_size);
+    }
+};
+
+#endif // MY_GROWTH_H
@@ -0,0 +1,351 @@
+#ifndef MY_MAPPED_VECTOR_H
+#define MY_MAPPED_VECTOR_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "my_growth.h"
+
+// On-disk layout: a 64-byte header followed by capacity elements.
+struct my_mapped_header {
+    static constexpr char expected_magic[8] = {'M', 'Y', 'V', 'E', 'C', 'T', 'O', 'R'};
+    static constexpr uint32_t current_version = 1;
+    static constexpr uint32_t byte_order_mark = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t element_size;
+    uint64_t element_alignment;
+    uint64_t size;
+    uint64_t capacity;
+    char reserved[16];
+};
+
+static_assert(sizeof(my_mapped_header) == 64);
+
+// my_vector whose storage is a memory-mapped file. Opening an existing file
+// maps it as is, with no deserialization; growing the vector grows the file
+// with ftruncate and remaps it. Elements are written straight into the page
+// cache, sync() flushes them and the header to disk with msync.
+template <typename T, typename GrowthPolicy = my_growth_double>
+class my_mapped_vector {
+private:
+    static_assert(std::is_trivially_copyable_v<T>, "my_mapped_vector: T must be trivially copyable");
+    static_assert(alignof(T) <= sizeof(my_mapped_header), "my_mapped_vector: T is over-aligned");
+
+    static constexpr size_t data_offset = sizeof(my_mapped_header);
+
+    int fd_ = -1;
+    std::byte* map_ = nullptr;
+    size_t map_bytes_ = 0;
+    std::string path_;
+
+    my_mapped_header& header() noexcept { return *reinterpret_cast<my_mapped_header*>(map_); }
+    const my_mapped_header& header() const noexcept { return *reinterpret_cast<const my_mapped_header*>(map_); }
+
+    T* elements() noexcept { return map_ ? reinterpret_cast<T*>(map_ + data_offset) : nullptr; }
+    const T* elements() const noexcept { return map_ ? reinterpret_cast<const T*>(map_ + data_offset) : nullptr; }
+
+    [[noreturn]] static void throw_errno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    void check_open() const {
+        if (!map_) {
+            throw std::logic_error("my_mapped_vector: no file is open");
+        }
+    }
+
+    void map(size_t bytes) {
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (ptr == MAP_FAILED) {
+            throw_errno("my_mapped_vector: mmap");
+        }
+        map_ = static_cast<std::byte*>(ptr);
+        map_bytes_ = bytes;
+    }
+
+    void remap(size_t bytes) {
+#if defined(__linux__)
+        void* ptr = mremap(map_, map_bytes_, bytes, MREMAP_MAYMOVE);
+        if (ptr == MAP_FAILED) {
+            throw_errno("my_mapped_vector: mremap");
+        }
+        map_ = static_cast<std::byte*>(ptr);
+        map_bytes_ = bytes;
+#else
+        munmap(map_, map_bytes_);
+        map_ = nullptr;
+        map(bytes);
+#endif
+    }
+
+    void resize_file(size_t bytes) {
+        if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            throw_errno("my_mapped_vector: ftruncate");
+        }
+    }
+
+    static constexpr size_t max_capacity() noexcept {
+        const auto max_bytes = static_cast<size_t>(std::numeric_limits<off_t>::max());
+        return (std::min(max_bytes, std::numeric_limits<size_t>::max()) - data_offset) / sizeof(T);
+    }
+
+    // The header never claims more elements than the file holds: it is
+    // updated after the file grows and before it shrinks, so a process that
+    // dies in between leaves a file that is merely larger than it says.
+    void set_capacity(size_t new_cap) {
+        if (new_cap > max_capacity()) {
+            throw std::length_error("my_mapped_vector: capacity too large");
+        }
+        const size_t bytes = data_offset + new_cap * sizeof(T);
+        if (bytes > map_bytes_) {
+            resize_file(bytes);
+            remap(bytes);
+            header().capacity = new_cap;
+        } else {
+            header().capacity = new_cap;
+            remap(bytes);
+            resize_file(bytes);
+        }
+    }
+
+    void validate(const my_mapped_header& h, size_t file_bytes) const {
+        if (std::memcmp(h.magic, my_mapped_header::expected_magic, sizeof(h.magic)) != 0) {
+            throw std::runtime_error("my_mapped_vector: " + path_ + " is not a my_mapped_vector file");
+        }
+        if (h.version != my_mapped_header::current_version || h.byte_order != my_mapped_header::byte_order_mark) {
+            throw std::runtime_error("my_mapped_vector: " + path_ + " has an unsupported version or byte order");
+        }
+        if (h.element_size != sizeof(T) || h.element_alignment != alignof(T)) {
+            throw std::runtime_error("my_mapped_vector: " + path_ + " holds elements of a different type");
+        }
+        if (h.size > h.capacity || h.capacity > (file_bytes - data_offset) / sizeof(T)) {
+            throw std::runtime_error("my_mapped_vector: " + path_ + " is truncated or corrupted");
+        }
+    }
+
+    void close_noexcept() noexcept {
+        if (map_) {
+            munmap(map_, map_bytes_);
+        }
+        if (fd_ != -1) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+        map_ = nullptr;
+        map_bytes_ = 0;
+        path_.clear();
+    }
+
+public:
+    using value_type = T;
+
+    my_mapped_vector() noexcept = default;
+
+    explicit my_mapped_vector(const std::string& path) {
+        open(path);
+    }
+
+    my_mapped_vector(const my_mapped_vector&) = delete;
+    my_mapped_vector& operator=(const my_mapped_vector&) = delete;
+
+    my_mapped_vector(my_mapped_vector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1)), map_(std::exchange(other.map_, nullptr)),
+          map_bytes_(std::exchange(other.map_bytes_, 0)), path_(std::move(other.path_)) {}
+
+    my_mapped_vector& operator=(my_mapped_vector&& other) noexcept {
+        if (this != &other) {
+            close_noexcept();
+            fd_ = std::exchange(other.fd_, -1);
+            map_ = std::exchange(other.map_, nullptr);
+            map_bytes_ = std::exchange(other.map_bytes_, 0);
+            path_ = std::move(other.path_);
+        }
+        return *this;
+    }
+
+    ~my_mapped_vector() {
+        close_noexcept();
+    }
+
+    // maps the file at path, creating an empty vector file if it does not
+    // exist; throws std::runtime_error if the file holds something else.
+    // The capacity is whatever the file has room for.
+    void open(const std::string& path) {
+        close();
+        path_ = path;
+
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ == -1) {
+            const int error = errno;
+            path_.clear();
+            throw std::system_error(error, std::generic_category(), "my_mapped_vector: open " + path);
+        }
+
+        try {
+            struct stat st;
+            if (fstat(fd_, &st) != 0) {
+                throw_errno("my_mapped_vector: fstat");
+            }
+            const auto file_bytes = static_cast<size_t>(st.st_size);
+
+            if (file_bytes == 0) {
+                resize_file(data_offset);
+                map(data_offset);
+
+                my_mapped_header& h = header();
+                std::memcpy(h.magic, my_mapped_header::expected_magic, sizeof(h.magic));
+                h.version = my_mapped_header::current_version;
+                h.byte_order = my_mapped_header::byte_order_mark;
+                h.element_size = sizeof(T);
+                h.element_alignment = alignof(T);
+                h.size = 0;
+                h.capacity = 0;
+                std::memset(h.reserved, 0, sizeof(h.reserved));
+            } else {
+                if (file_bytes < data_offset) {
+                    throw std::runtime_error("my_mapped_vector: " + path + " is not a my_mapped_vector file");
+                }
+                map(file_bytes);
+                validate(header(), file_bytes);
+                // a grow that was cut short left room the header does not count yet
+                header().capacity = (file_bytes - data_offset) / sizeof(T);
+            }
+        } catch (...) {
+            close_noexcept();
+            throw;
+        }
+    }
+
+    // unmaps and closes the file; the contents stay on disk, call sync()
+    // first if they must survive a system crash
+    void close() noexcept {
+        close_noexcept();
+    }
+
+    // flushes the elements and the header to disk
+    void sync() {
+        check_open();
+        if (msync(map_, map_bytes_, MS_SYNC) != 0) {
+            throw_errno("my_mapped_vector: msync");
+        }
+    }
+
+    bool is_open() const noexcept { return map_ != nullptr; }
+    const std::string& path() const noexcept { return path_; }
+
+    T& operator[](size_t idx) noexcept { return elements()[idx]; }
+    const T& operator[](size_t idx) const noexcept { return elements()[idx]; }
+
+    T& at(size_t idx) {
+        if (idx >= size()) {
+            throw std::out_of_range("my_mapped_vector::at: index out of range");
+        }
+        return elements()[idx];
+    }
+
+    const T& at(size_t idx) const {
+        if (idx >= size()) {
+            throw std::out_of_range("my_mapped_vector::at: index out of range");
+        }
+        return elements()[idx];
+    }
+
+    T& front() { return elements()[0]; }
+    const T& front() const { return elements()[0]; }
+
+    T& back() { return elements()[size() - 1]; }
+    const T& back() const { return elements()[size() - 1]; }
+
+    T* data() noexcept { return elements(); }
+    const T* data() const noexcept { return elements(); }
+
+    T* begin() noexcept { return elements(); }
+    const T* begin() const noexcept { return elements(); }
+    const T* cbegin() const noexcept { return elements(); }
+
+    T* end() noexcept { return elements() + size(); }
+    const T* end() const noexcept { return elements() + size(); }
+    const T* cend() const noexcept { return elements() + size(); }
+
+    bool is_empty() const noexcept { return size() == 0; }
+    size_t size() const noexcept { return map_ ? header().size : 0; }
+    size_t capacity() const noexcept { return map_ ? header().capacity : 0; }
+
+    void reserve(size_t new_cap) {
+        check_open();
+        if (new_cap <= capacity()) return;
+
+        set_capacity(new_cap);
+    }
+
+    // truncates the file to the live elements
+    void shrink_to_fit() {
+        check_open();
+        if (size() < capacity()) {
+            set_capacity(size());
+        }
+    }
+
+    void clear() noexcept {
+        if (map_) {
+            header().size = 0;
+        }
+    }
+
+    void resize(size_t count, const T& value = T()) {
+        check_open();
+        if (count > capacity()) {
+            const T copy = value; // value may live in the mapping that is about to move
+            set_capacity(count);
+            std::fill(end(), elements() + count, copy);
+        } else if (count > size()) {
+            std::fill(end(), elements() + count, value);
+        }
+        header().size = count;
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        check_open();
+        const size_t size_now = size();
+        if (size_now >= capacity()) {
+            T value(std::forward<Args>(args)...);
+            set_capacity(GrowthPolicy::next_capacity(capacity(), size_now + 1, sizeof(T)));
+            elements()[size_now] = value;
+        } else {
+            elements()[size_now] = T(std::forward<Args>(args)...);
+        }
+        header().size = size_now + 1;
+        return elements()[size_now];
+    }
+
+    void pop_back() {
+        if (size() > 0) {
+            --header().size;
+        }
+    }
+};
+
+#endif // MY_MAPPED_VECTOR_H
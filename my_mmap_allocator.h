@@ -0,0 +1,276 @@
+#ifndef MY_MMAP_ALLOCATOR_H
+#define MY_MMAP_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "my_allocators.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+struct my_mmap_options {
+    // blocks of at least this many bytes are mapped directly, smaller ones come from malloc
+    size_t threshold = size_t(2) << 20;
+    // ask for transparent huge pages with madvise(MADV_HUGEPAGE)
+    bool huge_pages = true;
+    // map with MAP_HUGETLB from the reserved huge page pool, falling back to
+    // normal pages when the pool is exhausted
+    bool explicit_huge_pages = false;
+
+    bool operator==(const my_mmap_options&) const = default;
+};
+
+#if defined(__linux__)
+// Base addresses of the live MAP_HUGETLB blocks. Their lengths and offsets
+// must be whole huge pages, and deallocate only gets a pointer and a count.
+class my_hugetlb_blocks {
+private:
+    static inline std::mutex mutex_;
+    static inline std::vector<const void*> bases_;
+
+public:
+    static void add(const void* base) {
+        const std::lock_guard lock(mutex_);
+        bases_.push_back(base);
+    }
+
+    static bool contains(const void* base) noexcept {
+        const std::lock_guard lock(mutex_);
+        return std::find(bases_.begin(), bases_.end(), base) != bases_.end();
+    }
+
+    static void replace(const void* old_base, const void* new_base) noexcept {
+        const std::lock_guard lock(mutex_);
+        std::replace(bases_.begin(), bases_.end(), old_base, new_base);
+    }
+
+    static void remove(const void* base) noexcept {
+        const std::lock_guard lock(mutex_);
+        bases_.erase(std::remove(bases_.begin(), bases_.end(), base), bases_.end());
+    }
+};
+#endif
+
+// Allocator for very large buffers: blocks above options.threshold get their
+// own anonymous mapping, aligned to 2 MiB and backed by huge pages where
+// possible, and are resized with mremap. release_unused returns the pages
+// behind the unused part of a block to the OS with madvise(MADV_DONTNEED);
+// my_vector calls it from clear(). On systems without mmap every block comes
+// from malloc.
+template <typename T>
+class my_mmap_allocator {
+private:
+    template <typename U>
+    friend class my_mmap_allocator;
+
+    static constexpr size_t page_size = 4096;
+    static constexpr size_t huge_page_size = size_t(2) << 20;
+    static constexpr bool over_aligned = alignof(T) > alignof(std::max_align_t);
+
+    my_mmap_options options_;
+
+    static size_t round_up(size_t bytes, size_t granularity) noexcept {
+        return (bytes + granularity - 1) & ~(granularity - 1);
+    }
+
+    size_t granularity() const noexcept {
+        return options_.huge_pages || options_.explicit_huge_pages ? huge_page_size : page_size;
+    }
+
+    bool is_mapped(size_t count) const noexcept {
+#if defined(__linux__)
+        return count * sizeof(T) >= options_.threshold;
+#else
+        (void)count;
+        return false;
+#endif
+    }
+
+    // malloc blocks must stay below the threshold, deallocate tells blocks apart by size
+    size_t clamp_malloc_count(size_t count, size_t usable) const noexcept {
+        const size_t below_threshold = options_.threshold ? (options_.threshold - 1) / sizeof(T) : 0;
+        return std::max(count, std::min(usable, below_threshold));
+    }
+
+    my_allocation_result<T> malloc_at_least(size_t count) {
+        const auto result = my_malloc_allocator<T>().allocate_at_least(count);
+        return {result.ptr, clamp_malloc_count(count, result.count)};
+    }
+
+#if defined(__linux__)
+    void advise(void* ptr, size_t bytes) const noexcept {
+        if (options_.huge_pages) {
+            madvise(ptr, bytes, MADV_HUGEPAGE);
+        }
+    }
+
+    // the unit the lengths and offsets of the mapped block at ptr are rounded to
+    size_t block_granularity(const void* ptr) const noexcept {
+        return options_.explicit_huge_pages && my_hugetlb_blocks::contains(ptr) ? huge_page_size : page_size;
+    }
+
+    my_allocation_result<T> map_at_least(size_t count) {
+        const size_t gran = granularity();
+        const size_t bytes = round_up(count * sizeof(T), gran);
+
+        if (options_.explicit_huge_pages) {
+            void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (ptr != MAP_FAILED) {
+                try {
+                    my_hugetlb_blocks::add(ptr);
+                } catch (...) {
+                    munmap(ptr, bytes);
+                    throw;
+                }
+                return {static_cast<T*>(ptr), trim_tail(ptr, bytes, huge_page_size)};
+            }
+        }
+
+        // over-map by one huge page to cut out a 2 MiB aligned range
+        const size_t extra = gran > page_size ? gran : 0;
+        void* raw = mmap(nullptr, bytes + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        auto* first = static_cast<std::byte*>(raw);
+        auto* aligned = reinterpret_cast<std::byte*>(round_up(reinterpret_cast<uintptr_t>(first), gran));
+        if (aligned != first) {
+            munmap(first, aligned - first);
+        }
+        if (const size_t tail = extra - (aligned - first)) {
+            munmap(aligned + bytes, tail);
+        }
+        advise(aligned, bytes);
+
+        return {reinterpret_cast<T*>(aligned), trim_tail(aligned, bytes, page_size)};
+    }
+
+    // gran is page_size, or huge_page_size for MAP_HUGETLB blocks
+    static size_t mapped_bytes(size_t count, size_t gran) noexcept {
+        return round_up(count * sizeof(T), gran);
+    }
+
+    // the slack of a mapping of bytes becomes capacity; whole pages that
+    // cannot hold another element are unmapped, so that mapped_bytes(count, gran)
+    // describes the mapping again. Returns the element count.
+    static size_t trim_tail(void* ptr, size_t bytes, size_t gran) noexcept {
+        const size_t count = bytes / sizeof(T);
+        const size_t kept = mapped_bytes(count, gran);
+        if (kept < bytes) {
+            munmap(static_cast<std::byte*>(ptr) + kept, bytes - kept);
+        }
+        return count;
+    }
+#endif
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    my_mmap_allocator() noexcept = default;
+
+    explicit my_mmap_allocator(const my_mmap_options& options) noexcept : options_(options) {}
+
+    template <typename U>
+    my_mmap_allocator(const my_mmap_allocator<U>& other) noexcept : options_(other.options_) {}
+
+    const my_mmap_options& options() const noexcept { return options_; }
+
+    T* allocate(size_t count) {
+        return allocate_at_least(count).ptr;
+    }
+
+    my_allocation_result<T> allocate_at_least(size_t count) {
+#if defined(__linux__)
+        if (is_mapped(count) && !over_aligned) {
+            return map_at_least(count);
+        }
+#endif
+        return malloc_at_least(count);
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+#if defined(__linux__)
+        if (is_mapped(count) && !over_aligned) {
+            const size_t gran = block_granularity(ptr);
+            munmap(ptr, mapped_bytes(count, gran));
+            if (gran == huge_page_size) {
+                my_hugetlb_blocks::remove(ptr);
+            }
+            return;
+        }
+#endif
+        my_malloc_allocator<T>().deallocate(ptr, count);
+    }
+
+    // only valid for trivially relocatable T, the bytes are moved by the kernel or memcpy
+    my_allocation_result<T> reallocate(T* ptr, size_t old_count, size_t new_count) requires(!over_aligned) {
+#if defined(__linux__)
+        const bool old_mapped = is_mapped(old_count);
+        const bool new_mapped = is_mapped(new_count);
+
+        if (old_mapped && new_mapped) {
+            const size_t gran = block_granularity(ptr);
+            const size_t bytes = mapped_bytes(new_count, gran);
+            void* result = mremap(ptr, mapped_bytes(old_count, gran), bytes, MREMAP_MAYMOVE);
+            if (result != MAP_FAILED) {
+                if (gran == huge_page_size) {
+                    my_hugetlb_blocks::replace(ptr, result);
+                } else {
+                    advise(result, bytes);
+                }
+                return {static_cast<T*>(result), trim_tail(result, bytes, gran)};
+            }
+            // e.g. MAP_HUGETLB mappings on older kernels, fall back to a copy
+        }
+
+        if (old_mapped || new_mapped) {
+            const auto result = allocate_at_least(new_count);
+            std::memcpy(static_cast<void*>(result.ptr), static_cast<const void*>(ptr),
+                        std::min(old_count, new_count) * sizeof(T));
+            deallocate(ptr, old_count);
+            return result;
+        }
+#endif
+        const auto result = my_malloc_allocator<T>().reallocate(ptr, old_count, new_count);
+        return {result.ptr, clamp_malloc_count(new_count, result.count)};
+    }
+
+    // drops the pages that lie entirely past the first used_count elements;
+    // they read back as zeros when touched again
+    void release_unused(T* ptr, size_t used_count, size_t count) noexcept {
+#if defined(__linux__)
+        if (ptr && is_mapped(count) && !over_aligned) {
+            const size_t gran = block_granularity(ptr);
+            auto* first = reinterpret_cast<std::byte*>(ptr) + mapped_bytes(used_count, gran);
+            auto* last = reinterpret_cast<std::byte*>(ptr) + mapped_bytes(count, gran);
+            if (first < last) {
+                madvise(first, last - first, MADV_DONTNEED);
+            }
+        }
+#else
+        (void)ptr;
+        (void)used_count;
+        (void)count;
+#endif
+    }
+
+    template <typename U>
+    bool operator==(const my_mmap_allocator<U>& other) const noexcept {
+        return options_ == other.options_;
+    }
+};
+
+#endif // MY_MMAP_ALLOCATOR_H
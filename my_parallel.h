@@ -0,0 +1,446 @@
+#ifndef MY_PARALLEL_H
+#define MY_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "my_thread_pool.h"
+#include "my_vector.h"
+
+// Parallel versions of the std algorithms for random-access ranges such as
+// my_vector and my_array, running on a my_thread_pool (the global one by
+// default). The range is split recursively until a piece holds at most grain
+// elements; idle threads steal the larger pieces that are still unsplit.
+// A grain of 0 picks one from chunk_bytes.
+namespace my_parallel {
+
+// default chunk size: small enough to stay in a core's L2 cache while a task
+// works on it, large enough that the cost of scheduling it is noise
+inline constexpr size_t chunk_bytes = 64 * 1024;
+
+template <typename T>
+constexpr size_t default_grain() noexcept {
+    return std::max<size_t>(chunk_bytes / sizeof(T), 1);
+}
+
+namespace detail {
+
+template <typename It>
+size_t grain_for(size_t grain) noexcept {
+    return grain ? grain : default_grain<std::iter_value_t<It>>();
+}
+
+template <typename It, typename F>
+void split(my_task_group& group, It first, size_t count, F& body, size_t grain) {
+    while (count > grain) {
+        const size_t half = count / 2;
+        group.run([&group, &body, second = first + half, rest = count - half, grain] {
+            split(group, second, rest, body, grain);
+        });
+        count = half;
+    }
+    body(first, first + count);
+}
+
+template <typename It, typename T, typename Op>
+T reduce(my_thread_pool& pool, It first, size_t count, Op& op, size_t grain);
+
+// kept apart from the leaf case in reduce: sharing a frame with the
+// reference-capturing task keeps the leaf's accumulator in memory
+template <typename It, typename T, typename Op>
+T reduce_halves(my_thread_pool& pool, It first, size_t count, Op& op, size_t grain) {
+    const size_t half = count / 2;
+    std::optional<T> right;
+    my_task_group group(pool);
+    group.run([&] { right.emplace(reduce<It, T>(pool, first + half, count - half, op, grain)); });
+    T left = reduce<It, T>(pool, first, half, op, grain);
+    group.wait();
+    return op(std::move(left), std::move(*right));
+}
+
+template <typename It, typename T, typename Op>
+T reduce(my_thread_pool& pool, It first, size_t count, Op& op, size_t grain) {
+    if (count <= grain) {
+        return std::accumulate(first + 1, first + count, T(*first), op);
+    }
+    return reduce_halves<It, T>(pool, first, count, op, grain);
+}
+
+// merges [a, a + a_count) and [b, b + b_count) into out by moving; the larger
+// input is split at its middle and the other at the matching position
+template <typename InIt, typename OutIt, typename Compare>
+void merge(my_thread_pool& pool, InIt a, size_t a_count, InIt b, size_t b_count, OutIt out, Compare& comp,
+           size_t grain) {
+    if (a_count + b_count <= std::max<size_t>(grain, 2)) {
+        std::merge(std::make_move_iterator(a), std::make_move_iterator(a + a_count), std::make_move_iterator(b),
+                   std::make_move_iterator(b + b_count), out, comp);
+        return;
+    }
+    if (a_count < b_count) {
+        std::swap(a, b);
+        std::swap(a_count, b_count);
+    }
+
+    const size_t a_half = a_count / 2;
+    const size_t b_half = std::lower_bound(b, b + b_count, a[a_half], comp) - b;
+
+    my_task_group group(pool);
+    group.run([&] { merge(pool, a, a_half, b, b_half, out, comp, grain); });
+    merge(pool, a + a_half, a_count - a_half, b + b_half, b_count - b_half, out + a_half + b_half, comp, grain);
+    group.wait();
+}
+
+// sorts [data, data + count) into data, or into buffer if to_buffer; the
+// other one is scratch space. The halves end up in the opposite place so
+// that merging them moves the result where it belongs.
+template <typename It, typename Buf, typename Compare>
+void merge_sort(my_thread_pool& pool, It data, Buf buffer, size_t count, bool to_buffer, Compare& comp,
+                size_t grain) {
+    if (count <= grain) {
+        std::sort(data, data + count, comp);
+        if (to_buffer) {
+            std::move(data, data + count, buffer);
+        }
+        return;
+    }
+
+    const size_t half = count / 2;
+    {
+        my_task_group group(pool);
+        group.run([&] { merge_sort(pool, data, buffer, half, !to_buffer, comp, grain); });
+        merge_sort(pool, data + half, buffer + half, count - half, !to_buffer, comp, grain);
+        group.wait();
+    }
+
+    if (to_buffer) {
+        merge(pool, data, half, data + half, count - half, buffer, comp, grain);
+    } else {
+        merge(pool, buffer, half, buffer + half, count - half, data, comp, grain);
+    }
+}
+
+} // namespace detail
+
+// calls body(chunk_first, chunk_last) for consecutive chunks of at most grain elements
+template <std::random_access_iterator It, typename F>
+void for_chunks(It first, It last, F body, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    const size_t count = last - first;
+    grain = detail::grain_for<It>(grain);
+    if (count <= grain || pool.size() == 0) {
+        body(first, last);
+        return;
+    }
+
+    my_task_group group(pool);
+    detail::split(group, first, count, body, grain);
+    group.wait();
+}
+
+template <std::random_access_iterator It, typename F>
+void for_each(It first, It last, F f, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    for_chunks(first, last, [&f](It chunk_first, It chunk_last) {
+        for (; chunk_first != chunk_last; ++chunk_first) {
+            f(*chunk_first);
+        }
+    }, grain, pool);
+}
+
+// writes op(x) for every x in [first, last) to the range starting at d_first
+template <std::random_access_iterator It, std::random_access_iterator OutIt, typename Op>
+OutIt transform(It first, It last, OutIt d_first, Op op, size_t grain = 0,
+                my_thread_pool& pool = my_thread_pool::global()) {
+    for_chunks(first, last, [&](It chunk_first, It chunk_last) {
+        std::transform(chunk_first, chunk_last, d_first + (chunk_first - first), op);
+    }, grain, pool);
+    return d_first + (last - first);
+}
+
+// op must be associative; the chunks are combined in a fixed tree order, so
+// the result does not depend on the scheduling
+template <std::random_access_iterator It, typename T, typename Op = std::plus<>>
+T reduce(It first, It last, T init, Op op = {}, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    const size_t count = last - first;
+    if (count == 0) {
+        return init;
+    }
+    grain = detail::grain_for<It>(grain);
+    if (pool.size() == 0) {
+        grain = count;
+    }
+    return op(std::move(init), detail::reduce<It, T>(pool, first, count, op, grain));
+}
+
+// Parallel merge sort, not stable. Needs a buffer of last - first elements;
+// if comp throws, the range is left holding valid but unspecified values.
+template <std::random_access_iterator It, typename Compare = std::less<>>
+void sort(It first, It last, Compare comp = {}, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    using T = std::iter_value_t<It>;
+
+    const size_t count = last - first;
+    grain = detail::grain_for<It>(grain);
+    if (count <= grain || pool.size() == 0) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // the elements move to the buffer and the range becomes the scratch space
+    // the result is merged into, no default-constructed T needed
+    my_vector<T> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+    detail::merge_sort(pool, buffer.begin(), first, count, true, comp, grain);
+}
+
+// The same over whole containers.
+
+template <std::ranges::random_access_range R, typename F>
+void for_chunks(R&& range, F body, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    for_chunks(std::ranges::begin(range), std::ranges::end(range), std::move(body), grain, pool);
+}
+
+template <std::ranges::random_access_range R, typename F>
+void for_each(R&& range, F f, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    for_each(std::ranges::begin(range), std::ranges::end(range), std::move(f), grain, pool);
+}
+
+template <std::ranges::random_access_range R, std::random_access_iterator OutIt, typename Op>
+OutIt transform(R&& range, OutIt d_first, Op op, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    return transform(std::ranges::begin(range), std::ranges::end(range), d_first, std::move(op), grain, pool);
+}
+
+template <std::ranges::random_access_range R, typename T, typename Op = std::plus<>>
+T reduce(R&& range, T init, Op op = {}, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    return reduce(std::ranges::begin(range), std::ranges::end(range), std::move(init), std::move(op), grain, pool);
+}
+
+template <std::ranges::random_access_range R, typename Compare = std::less<>>
+void sort(R&& range, Compare comp = {}, size_t grain = 0, my_thread_pool& pool = my_thread_pool::global()) {
+    sort(std::ranges::begin(range), std::ranges::end(range), std::move(comp), grain, pool);
+}
+
+
+// Building the elements of a large vector on the threads that will use them.
+// Linux backs a page with memory of the NUMA node whose CPU first writes it,
+// so a vector filled by one thread lives on one node, and threads on the
+// other nodes scan it through the slower remote link. These resizes split the
+// new elements into contiguous, page-aligned parts and build each part on a
+// thread of its own, optionally pinned to the CPUs of a node: part i of n on
+// node i * nodes / n. They start threads rather than use a pool, where work
+// stealing decides only at run time which thread takes which piece.
+struct first_touch {
+    size_t threads = 0;        // 0 for one per core
+    bool pin_to_nodes = false; // a no-op where the nodes are unknown
+};
+
+namespace detail {
+
+inline constexpr size_t page_bytes = 4096;
+
+// a sysfs CPU or node list such as "0-3,8-11"
+inline my_vector<int> parse_id_list(const std::string& list) {
+    my_vector<int> ids;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        const size_t end = std::min(list.find(',', pos), list.size());
+        const std::string item = list.substr(pos, end - pos);
+        const size_t dash = item.find('-');
+        try {
+            const int first = std::stoi(item.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int id = first; id <= last; ++id) {
+                ids.push_back(id);
+            }
+        } catch (const std::exception&) {
+            // a malformed entry, e.g. the trailing newline
+        }
+        pos = end + 1;
+    }
+    return ids;
+}
+
+// the CPUs of every NUMA node, none where sysfs does not tell
+inline const my_vector<my_vector<int>>& numa_nodes() {
+    static const my_vector<my_vector<int>> nodes = [] {
+        my_vector<my_vector<int>> result;
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string list;
+        if (!std::getline(online, list)) {
+            return result;
+        }
+        for (int node : parse_id_list(list)) {
+            std::ifstream cpus("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string cpu_list;
+            if (std::getline(cpus, cpu_list)) {
+                my_vector<int> node_cpus = parse_id_list(cpu_list);
+                if (!node_cpus.is_empty()) {
+                    result.push_back(std::move(node_cpus));
+                }
+            }
+        }
+        return result;
+    }();
+    return nodes;
+}
+
+// best effort: a thread left unpinned still builds its part
+inline void pin_current_thread(const my_vector<int>& cpus) noexcept {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpus;
+#endif
+}
+
+// Runs build(part_first, part_count) over [first, first + count) in parts,
+// each on its own thread, and rethrows the first exception once every thread
+// is done; build must destroy what it built before throwing, and the parts
+// that were built are destroyed then as well.
+template <typename T, typename Build>
+void build_in_parts(T* first, size_t count, const first_touch& options, const Build& build) {
+    constexpr size_t page_elements = std::max<size_t>(page_bytes / sizeof(T), 1);
+    size_t threads = options.threads ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min(threads, count * sizeof(T) / chunk_bytes);
+    if (threads <= 1) {
+        build(first, count);
+        return;
+    }
+
+    // part boundaries fall on page starts, so that no page is touched by two parts
+    const size_t skew = reinterpret_cast<uintptr_t>(first) % page_bytes / sizeof(T);
+    my_vector<size_t> bounds(threads + 1);
+    for (size_t i = 1; i < threads; ++i) {
+        const size_t index = count / threads * i + skew;
+        bounds[i] = std::clamp(index - index % page_elements, skew, count + skew) - skew;
+    }
+    bounds[threads] = count;
+
+    const my_vector<my_vector<int>>& nodes = numa_nodes();
+    const bool pin = options.pin_to_nodes && !nodes.is_empty();
+    my_vector<std::exception_ptr> errors(threads);
+    my_vector<std::thread> workers;
+    workers.reserve(threads);
+
+    std::exception_ptr start_error;
+    try {
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([&, i] {
+                if (pin) {
+                    pin_current_thread(nodes[i * nodes.size() / threads]);
+                }
+                try {
+                    build(first + bounds[i], bounds[i + 1] - bounds[i]);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+    } catch (...) {
+        start_error = std::current_exception();
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // the parts of threads that never started count as failed
+    for (size_t i = workers.size(); i < threads; ++i) {
+        errors[i] = start_error;
+    }
+    const auto failed = std::find_if(errors.begin(), errors.end(), [](const std::exception_ptr& e) { return bool(e); });
+    if (failed != errors.end()) {
+        for (size_t i = 0; i < threads; ++i) {
+            if (!errors[i]) {
+                std::destroy(first + bounds[i], first + bounds[i + 1]);
+            }
+        }
+        std::rethrow_exception(*failed);
+    }
+}
+
+// the private my_vector members the parallel algorithms build on
+struct vector_access {
+    template <typename Vector, typename Construct>
+    static void append_constructed(Vector& vec, size_t count, Construct&& construct) {
+        vec.append_constructed(count, std::forward<Construct>(construct));
+    }
+};
+
+// resizes vec to count, building new elements with build in parts
+template <typename T, typename Allocator, typename GrowthPolicy, typename Build>
+void resize_in_parts(my_vector<T, Allocator, GrowthPolicy>& vec, size_t count, const first_touch& options,
+                     const Build& build) {
+    if (count <= vec.size()) {
+        vec.erase(vec.begin() + count, vec.end());
+        return;
+    }
+    vector_access::append_constructed(vec, count - vec.size(), [&](T* first, size_t n) {
+        build_in_parts(first, n, options, build);
+    });
+}
+
+} // namespace detail
+
+// Resizes vec to count, new elements copies of value, built in parallel. The
+// elements already there are moved by the calling thread if the storage
+// grows, so this is best called on an empty vector. The new elements are
+// built in place, without the allocator's construct.
+template <typename T, typename Allocator, typename GrowthPolicy>
+void resize(my_vector<T, Allocator, GrowthPolicy>& vec, size_t count, const std::type_identity_t<T>& value,
+            first_touch options = {}) {
+    const T copy = value; // value may be an element about to move
+    detail::resize_in_parts(vec, count, options, [&copy](T* first, size_t n) {
+        std::uninitialized_fill_n(first, n, copy);
+    });
+}
+
+// the same with value-initialized elements, zero for numbers
+template <typename T, typename Allocator, typename GrowthPolicy>
+void resize(my_vector<T, Allocator, GrowthPolicy>& vec, size_t count, first_touch options = {}) {
+    detail::resize_in_parts(vec, count, options, [](T* first, size_t n) {
+        std::uninitialized_value_construct_n(first, n);
+    });
+}
+
+// The same with default-initialized elements: a trivial T is left
+// uninitialized, but each thread still writes a byte of every page of its
+// part, so that the pages are placed before the elements are written.
+template <typename T, typename Allocator, typename GrowthPolicy>
+void resize_default_init(my_vector<T, Allocator, GrowthPolicy>& vec, size_t count, first_touch options = {}) {
+    detail::resize_in_parts(vec, count, options, [](T* first, size_t n) {
+        if constexpr (std::is_trivially_default_constructible_v<T>) {
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(first);
+            const size_t size = n * sizeof(T);
+            for (size_t offset = 0; offset < size; offset += detail::page_bytes) {
+                bytes[offset] = 0;
+            }
+        } else {
+            std::uninitialized_default_construct_n(first, n);
+        }
+    });
+}
+
+} // namespace my_parallel
+
+#endif // MY_PARALLEL_H
@@ -0,0 +1,146 @@
+#ifndef MY_RING_BUFFER_H
+#define MY_RING_BUFFER_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "my_array.h"
+#include "my_vector.h"
+
+// Capacity argument of my_ring_buffer and the queues for a capacity chosen at
+// run time, passed to the constructor.
+inline constexpr size_t my_dynamic_capacity = 0;
+
+// The slots of a ring of N elements: a my_array for a capacity fixed at
+// compile time, held inline, or a my_vector allocated once for
+// my_dynamic_capacity. Every slot holds a live T, default-constructed up
+// front; pushing assigns to a slot and popping moves out of it.
+template <typename T, size_t N>
+using my_ring_storage = std::conditional_t<N == my_dynamic_capacity, my_vector<T>, my_array<T, N>>;
+
+// the capacity for a requested one: a power of two, so that an index maps to
+// its slot with a mask instead of a division
+inline size_t my_ring_capacity(size_t requested) {
+    if (requested == 0 || requested > (size_t(1) << (std::numeric_limits<size_t>::digits - 2))) {
+        throw std::invalid_argument("my_ring_buffer: capacity must be between 1 and 2^(digits - 2)");
+    }
+    return std::bit_ceil(requested);
+}
+
+// Fixed-capacity FIFO for one thread. The head and tail are counters that only
+// grow, their difference is the size, so full and empty need no extra flag.
+template <typename T, size_t N = my_dynamic_capacity>
+class my_ring_buffer {
+    static_assert(N == my_dynamic_capacity || std::has_single_bit(N),
+                  "my_ring_buffer: the capacity must be a power of two");
+
+private:
+    my_ring_storage<T, N> slots_;
+    size_t mask_;
+    size_t head_ = 0;
+    size_t tail_ = 0;
+
+public:
+    using value_type = T;
+
+    my_ring_buffer() requires (N != my_dynamic_capacity) : mask_(N - 1) {}
+
+    // capacity is rounded up to a power of two
+    explicit my_ring_buffer(size_t capacity) requires (N == my_dynamic_capacity)
+        : slots_(my_ring_capacity(capacity)), mask_(slots_.size() - 1) {}
+
+    size_t size() const noexcept { return tail_ - head_; }
+    size_t capacity() const noexcept { return mask_ + 1; }
+    bool is_empty() const noexcept { return head_ == tail_; }
+    bool is_full() const noexcept { return size() == capacity(); }
+
+    // the i-th element from the front, without bounds checking
+    T& operator[](size_t idx) noexcept { return slots_[(head_ + idx) & mask_]; }
+    const T& operator[](size_t idx) const noexcept { return slots_[(head_ + idx) & mask_]; }
+
+    T& at(size_t idx) {
+        if (idx >= size()) {
+            throw std::out_of_range("my_ring_buffer::at: index out of range");
+        }
+        return (*this)[idx];
+    }
+
+    const T& at(size_t idx) const {
+        if (idx >= size()) {
+            throw std::out_of_range("my_ring_buffer::at: index out of range");
+        }
+        return (*this)[idx];
+    }
+
+    T& front() noexcept { return slots_[head_ & mask_]; }
+    const T& front() const noexcept { return slots_[head_ & mask_]; }
+    T& back() noexcept { return slots_[(tail_ - 1) & mask_]; }
+    const T& back() const noexcept { return slots_[(tail_ - 1) & mask_]; }
+
+    // false when full
+    template <typename U>
+    bool try_push(U&& value) {
+        if (is_full()) {
+            return false;
+        }
+        slots_[tail_ & mask_] = std::forward<U>(value);
+        ++tail_;
+        return true;
+    }
+
+    // overwrites the oldest element when full
+    template <typename U>
+    void push_overwrite(U&& value) {
+        if (is_full()) {
+            ++head_;
+        }
+        slots_[tail_ & mask_] = std::forward<U>(value);
+        ++tail_;
+    }
+
+    // false when empty
+    bool try_pop(T& out) {
+        if (is_empty()) {
+            return false;
+        }
+        out = std::move(slots_[head_ & mask_]);
+        ++head_;
+        return true;
+    }
+
+    // drops the front element, which must exist
+    void pop_front() noexcept { ++head_; }
+
+    // Copies up to n elements from first, as many as fit, and returns how many;
+    // wrap std::make_move_iterator around first to move them instead.
+    template <typename InputIt>
+    size_t try_push_n(InputIt first, size_t n) {
+        n = std::min(n, capacity() - size());
+        for (size_t i = 0; i < n; ++i, ++first) {
+            slots_[(tail_ + i) & mask_] = *first;
+        }
+        tail_ += n;
+        return n;
+    }
+
+    // moves up to n elements to out and returns how many
+    template <typename OutputIt>
+    size_t try_pop_n(OutputIt out, size_t n) {
+        n = std::min(n, size());
+        for (size_t i = 0; i < n; ++i, ++out) {
+            *out = std::move(slots_[(head_ + i) & mask_]);
+        }
+        head_ += n;
+        return n;
+    }
+
+    // the popped slots keep their moved-from values until overwritten
+    void clear() noexcept { head_ = tail_; }
+};
+
+#endif // MY_RING_BUFFER_H
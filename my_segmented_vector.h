@@ -0,0 +1,667 @@
+#ifndef MY_SEGMENTED_VECTOR_H
+#define MY_SEGMENTED_VECTOR_H
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "my_vector.h"
+
+// my_vector stored as a directory of fixed-size chunks, which grows at both
+// ends. Adding an element allocates at most one chunk and never moves the
+// others, so there are no reallocation stalls and references to elements stay
+// valid across push_back/push_front/emplace_*. Every few chunks the directory
+// itself is reallocated, which copies chunk pointers only, and invalidates
+// iterators.
+//
+// Popping keeps at most one empty chunk at each end; an emptied chunk goes to
+// the other end when that one has none, so a queue that pushes at one end and
+// pops at the other stops allocating once it reaches its working size.
+template <typename T, typename Allocator = std::allocator<T>, size_t ChunkBytes = 4096>
+class my_segmented_vector {
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using map_allocator = typename alloc_traits::template rebind_alloc<T*>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "my_segmented_vector: Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T*>,
+                  "my_segmented_vector: allocators with fancy pointers are not supported");
+
+    static constexpr size_t chunk_shift = std::bit_width(std::max<size_t>(ChunkBytes / sizeof(T), 1)) - 1;
+
+public:
+    // elements per chunk, a power of two
+    static constexpr size_t chunk_size = size_t(1) << chunk_shift;
+
+private:
+    static constexpr size_t chunk_mask = chunk_size - 1;
+
+    // what iterators of a container without chunks point into
+    static inline T* const empty_map_[1] = {nullptr};
+
+    // chunk pointers: map_[first_chunk_, first_chunk_ + chunk_count_) are
+    // allocated, the other slots are null, and at least one follows the
+    // allocated ones so that an end iterator can point at it
+    my_vector<T*, map_allocator> map_;
+    size_t first_chunk_ = 0;
+    size_t chunk_count_ = 0;
+    size_t start_ = 0; // position of the first element, counted from the first chunk
+    size_t size_ = 0;
+    [[no_unique_address]] Allocator alloc_;
+
+    T* slot(size_t pos) const noexcept {
+        return map_[first_chunk_ + (pos >> chunk_shift)] + (pos & chunk_mask);
+    }
+
+    size_t free_back() const noexcept {
+        return chunk_count_ * chunk_size - start_ - size_;
+    }
+
+    // moves the chunk pointers to the middle of the directory, leaving about
+    // as many free slots on each side as there are chunks, plus the end slot;
+    // returns false if the directory is too small for that
+    bool recenter_map() noexcept {
+        if (map_.size() < 3 * chunk_count_ + 3) {
+            return false;
+        }
+
+        T** data = map_.data();
+        const size_t first = (map_.size() - chunk_count_) / 2;
+        if (first < first_chunk_) {
+            std::copy(data + first_chunk_, data + first_chunk_ + chunk_count_, data + first);
+        } else {
+            std::copy_backward(data + first_chunk_, data + first_chunk_ + chunk_count_, data + first + chunk_count_);
+        }
+        std::fill(data, data + first, nullptr);
+        std::fill(data + first + chunk_count_, data + map_.size(), nullptr);
+        first_chunk_ = first;
+        return true;
+    }
+
+    void grow_map() {
+        if (recenter_map()) {
+            return;
+        }
+
+        const size_t slack = chunk_count_ + 1;
+        my_vector<T*, map_allocator> map(chunk_count_ + 2 * slack + 1, nullptr, map_.get_allocator());
+        std::copy_n(map_.data() + first_chunk_, chunk_count_, map.data() + slack);
+        map_.swap(map);
+        first_chunk_ = slack;
+    }
+
+    bool has_back_slot() const noexcept {
+        return first_chunk_ + chunk_count_ + 1 < map_.size();
+    }
+
+    void attach_back(T* chunk) noexcept {
+        map_[first_chunk_ + chunk_count_] = chunk;
+        ++chunk_count_;
+    }
+
+    void attach_front(T* chunk) noexcept {
+        map_[--first_chunk_] = chunk;
+        ++chunk_count_;
+        start_ += chunk_size;
+    }
+
+    void add_chunk_back() {
+        if (!has_back_slot()) {
+            grow_map();
+        }
+        attach_back(alloc_traits::allocate(alloc_, chunk_size));
+    }
+
+    void add_chunk_front() {
+        if (first_chunk_ == 0) {
+            grow_map();
+        }
+        attach_front(alloc_traits::allocate(alloc_, chunk_size));
+    }
+
+    T* detach_front() noexcept {
+        T* chunk = std::exchange(map_[first_chunk_], nullptr);
+        ++first_chunk_;
+        --chunk_count_;
+        start_ -= chunk_size;
+        return chunk;
+    }
+
+    T* detach_back() noexcept {
+        --chunk_count_;
+        return std::exchange(map_[first_chunk_ + chunk_count_], nullptr);
+    }
+
+    // called once the front holds two empty chunks
+    void trim_front() noexcept {
+        T* chunk = detach_front();
+        if (free_back() < chunk_size && (has_back_slot() || recenter_map())) {
+            attach_back(chunk);
+        } else {
+            alloc_traits::deallocate(alloc_, chunk, chunk_size);
+        }
+    }
+
+    // called once the back holds two empty chunks
+    void trim_back() noexcept {
+        T* chunk = detach_back();
+        if (start_ < chunk_size && (first_chunk_ > 0 || recenter_map())) {
+            attach_front(chunk);
+        } else {
+            alloc_traits::deallocate(alloc_, chunk, chunk_size);
+        }
+    }
+
+    void destroy_all() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t pos = start_; pos < start_ + size_; ++pos) {
+                alloc_traits::destroy(alloc_, slot(pos));
+            }
+        }
+        size_ = 0;
+    }
+
+    void release() noexcept {
+        destroy_all();
+        while (chunk_count_ > 0) {
+            alloc_traits::deallocate(alloc_, detach_back(), chunk_size);
+        }
+        map_ = my_vector<T*, map_allocator>(map_.get_allocator());
+        first_chunk_ = 0;
+        start_ = 0;
+    }
+
+    void steal(my_segmented_vector& other) noexcept {
+        map_ = std::move(other.map_);
+        first_chunk_ = std::exchange(other.first_chunk_, 0);
+        chunk_count_ = std::exchange(other.chunk_count_, 0);
+        start_ = std::exchange(other.start_, 0);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // undoes the push_backs past old_size after an exception
+    void truncate(size_t old_size) noexcept {
+        while (size_ > old_size) {
+            pop_back();
+        }
+    }
+
+    template <typename InputIt>
+    void append(InputIt first, InputIt last) {
+        const size_t old_size = size_;
+        try {
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        } catch (...) {
+            truncate(old_size);
+            throw;
+        }
+    }
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    template <bool Const>
+    class basic_iterator {
+    private:
+        friend class my_segmented_vector;
+
+        T* cur_ = nullptr;
+        T* const* node_ = nullptr;
+
+        basic_iterator(T* cur, T* const* node) noexcept : cur_(cur), node_(node) {}
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        basic_iterator() noexcept = default;
+
+        // iterator to const_iterator
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        basic_iterator(const basic_iterator<OtherConst>& other) noexcept : cur_(other.cur_), node_(other.node_) {}
+
+        reference operator*() const noexcept { return *cur_; }
+        pointer operator->() const noexcept { return cur_; }
+        reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        basic_iterator& operator++() noexcept {
+            if (++cur_ == *node_ + chunk_size) {
+                ++node_;
+                cur_ = *node_;
+            }
+            return *this;
+        }
+
+        basic_iterator& operator--() noexcept {
+            if (cur_ == *node_) {
+                --node_;
+                cur_ = *node_ + chunk_size;
+            }
+            --cur_;
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept { basic_iterator old = *this; ++*this; return old; }
+        basic_iterator operator--(int) noexcept { basic_iterator old = *this; --*this; return old; }
+
+        basic_iterator& operator+=(difference_type n) noexcept {
+            const difference_type offset = (cur_ - *node_) + n;
+            if (offset >= 0 && offset < static_cast<difference_type>(chunk_size)) {
+                cur_ += n;
+            } else {
+                // floor division, offset may be negative
+                const difference_type nodes = offset >= 0 ? offset >> chunk_shift : -((-offset - 1) >> chunk_shift) - 1;
+                node_ += nodes;
+                cur_ = *node_ + (offset - nodes * static_cast<difference_type>(chunk_size));
+            }
+            return *this;
+        }
+
+        basic_iterator& operator-=(difference_type n) noexcept { return *this += -n; }
+
+        friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept { return it -= n; }
+
+        friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            return (lhs.node_ - rhs.node_) * static_cast<difference_type>(chunk_size) + (lhs.cur_ - *lhs.node_) -
+                   (rhs.cur_ - *rhs.node_);
+        }
+
+        friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            return lhs.cur_ == rhs.cur_;
+        }
+
+        friend std::strong_ordering operator<=>(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+            if (lhs.node_ != rhs.node_) {
+                return std::compare_three_way()(lhs.node_, rhs.node_);
+            }
+            return std::compare_three_way()(lhs.cur_, rhs.cur_);
+        }
+
+        template <bool>
+        friend class basic_iterator;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+private:
+    iterator iterator_at(size_t pos) const noexcept {
+        if (chunk_count_ == 0) {
+            return iterator(nullptr, empty_map_);
+        }
+        T* const* node = map_.data() + first_chunk_ + (pos >> chunk_shift);
+        return iterator(*node + (pos & chunk_mask), node);
+    }
+
+public:
+    my_segmented_vector() noexcept(noexcept(Allocator())) : my_segmented_vector(Allocator()) {}
+
+    explicit my_segmented_vector(const Allocator& alloc) noexcept : map_(map_allocator(alloc)), alloc_(alloc) {}
+
+    explicit my_segmented_vector(size_t count, const Allocator& alloc = Allocator()) : my_segmented_vector(alloc) {
+        resize(count);
+    }
+
+    my_segmented_vector(size_t count, const T& value, const Allocator& alloc = Allocator())
+        : my_segmented_vector(alloc) {
+        resize(count, value);
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    my_segmented_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : my_segmented_vector(alloc) {
+        append(first, last);
+    }
+
+    my_segmented_vector(std::initializer_list<T> ilist, const Allocator& alloc = Allocator())
+        : my_segmented_vector(alloc) {
+        append(ilist.begin(), ilist.end());
+    }
+
+    my_segmented_vector(const my_segmented_vector& other)
+        : my_segmented_vector(other, alloc_traits::select_on_container_copy_construction(other.alloc_)) {}
+
+    my_segmented_vector(const my_segmented_vector& other, const Allocator& alloc) : my_segmented_vector(alloc) {
+        reserve(other.size_);
+        append(other.begin(), other.end());
+    }
+
+    my_segmented_vector(my_segmented_vector&& other) noexcept
+        : map_(other.map_.get_allocator()), alloc_(std::move(other.alloc_)) {
+        steal(other);
+    }
+
+    my_segmented_vector(my_segmented_vector&& other, const Allocator& alloc) : my_segmented_vector(alloc) {
+        if (alloc_traits::is_always_equal::value || alloc_ == other.alloc_) {
+            steal(other);
+        } else {
+            reserve(other.size_);
+            append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        }
+    }
+
+    ~my_segmented_vector() {
+        release();
+    }
+
+    my_segmented_vector& operator=(const my_segmented_vector& other) {
+        if (this != &other) {
+            constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+            my_segmented_vector temp(other, propagate ? other.alloc_ : alloc_);
+            release();
+            if constexpr (propagate) {
+                alloc_ = temp.alloc_;
+            }
+            steal(temp);
+        }
+        return *this;
+    }
+
+    my_segmented_vector& operator=(my_segmented_vector&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this != &other) {
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                release();
+                alloc_ = std::move(other.alloc_);
+                steal(other);
+            } else {
+                // unequal allocators cannot take over each other's chunks
+                my_segmented_vector temp(std::move(other), alloc_);
+                release();
+                steal(temp);
+            }
+        }
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+    T& operator[](size_t idx) noexcept { return *slot(start_ + idx); }
+    const T& operator[](size_t idx) const noexcept { return *slot(start_ + idx); }
+
+    T& at(size_t idx) {
+        if (idx >= size_) {
+            throw std::out_of_range("my_segmented_vector::at: index out of range");
+        }
+        return *slot(start_ + idx);
+    }
+
+    const T& at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("my_segmented_vector::at: index out of range");
+        }
+        return *slot(start_ + idx);
+    }
+
+    T& front() { return *slot(start_); }
+    const T& front() const { return *slot(start_); }
+
+    T& back() { return *slot(start_ + size_ - 1); }
+    const T& back() const { return *slot(start_ + size_ - 1); }
+
+    iterator begin() noexcept { return iterator_at(start_); }
+    const_iterator begin() const noexcept { return iterator_at(start_); }
+    const_iterator cbegin() const noexcept { return iterator_at(start_); }
+
+    iterator end() noexcept { return iterator_at(start_ + size_); }
+    const_iterator end() const noexcept { return iterator_at(start_ + size_); }
+    const_iterator cend() const noexcept { return iterator_at(start_ + size_); }
+
+    std::reverse_iterator<iterator> rbegin() noexcept { return std::reverse_iterator<iterator>(end()); }
+    std::reverse_iterator<const_iterator> rbegin() const noexcept { return std::reverse_iterator<const_iterator>(end()); }
+    std::reverse_iterator<const_iterator> crbegin() const noexcept { return std::reverse_iterator<const_iterator>(end()); }
+
+    std::reverse_iterator<iterator> rend() noexcept { return std::reverse_iterator<iterator>(begin()); }
+    std::reverse_iterator<const_iterator> rend() const noexcept { return std::reverse_iterator<const_iterator>(begin()); }
+    std::reverse_iterator<const_iterator> crend() const noexcept { return std::reverse_iterator<const_iterator>(begin()); }
+
+    bool is_empty() const noexcept { return size_ == 0; }
+    size_t size() const noexcept { return size_; }
+
+    // elements that fit before push_back allocates a chunk
+    size_t capacity() const noexcept { return size_ + free_back(); }
+
+    void reserve(size_t new_cap) {
+        while (capacity() < new_cap) {
+            add_chunk_back();
+        }
+    }
+
+    // frees the chunks holding no elements
+    void shrink_to_fit() noexcept {
+        if (size_ == 0) {
+            release();
+            return;
+        }
+        while (start_ >= chunk_size) {
+            alloc_traits::deallocate(alloc_, detach_front(), chunk_size);
+        }
+        while (free_back() >= chunk_size) {
+            alloc_traits::deallocate(alloc_, detach_back(), chunk_size);
+        }
+    }
+
+    // keeps the chunks
+    void clear() noexcept {
+        destroy_all();
+        start_ = 0;
+    }
+
+    void resize(size_t count) {
+        const size_t old_size = size_;
+        try {
+            while (size_ < count) {
+                emplace_back();
+            }
+        } catch (...) {
+            truncate(old_size);
+            throw;
+        }
+        truncate(count);
+    }
+
+    void resize(size_t count, const T& value) {
+        const size_t old_size = size_;
+        try {
+            while (size_ < count) {
+                emplace_back(value);
+            }
+        } catch (...) {
+            truncate(old_size);
+            throw;
+        }
+        truncate(count);
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void push_front(const T& value) {
+        emplace_front(value);
+    }
+
+    void push_front(T&& value) {
+        emplace_front(std::move(value));
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (free_back() == 0) {
+            add_chunk_back();
+        }
+        T* ptr = slot(start_ + size_);
+        alloc_traits::construct(alloc_, ptr, std::forward<Args>(args)...);
+        ++size_;
+        return *ptr;
+    }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args) {
+        if (start_ == 0) {
+            add_chunk_front();
+        }
+        T* ptr = slot(start_ - 1);
+        alloc_traits::construct(alloc_, ptr, std::forward<Args>(args)...);
+        --start_;
+        ++size_;
+        return *ptr;
+    }
+
+    void pop_back() {
+        if (size_ > 0) {
+            --size_;
+            alloc_traits::destroy(alloc_, slot(start_ + size_));
+            if (free_back() >= 2 * chunk_size) {
+                trim_back();
+            }
+        }
+    }
+
+    void pop_front() {
+        if (size_ > 0) {
+            alloc_traits::destroy(alloc_, slot(start_));
+            ++start_;
+            --size_;
+            if (start_ >= 2 * chunk_size) {
+                trim_front();
+            }
+        }
+    }
+
+    // Inserting and erasing in the middle shift the elements on the side of
+    // pos closer to an end, so references to the other side stay valid.
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        const size_t index = pos - cbegin();
+        if (index > size_) {
+            throw std::out_of_range("my_segmented_vector::emplace: iterator out of range");
+        }
+
+        if (index < size_ / 2) {
+            emplace_front(std::forward<Args>(args)...);
+            std::rotate(begin(), begin() + 1, begin() + index + 1);
+        } else {
+            emplace_back(std::forward<Args>(args)...);
+            std::rotate(begin() + index, end() - 1, end());
+        }
+        return begin() + index;
+    }
+
+    iterator insert(const_iterator pos, const T& value) {
+        return emplace(pos, value);
+    }
+
+    iterator insert(const_iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        const size_t index = pos - cbegin();
+        if (index > size_) {
+            throw std::out_of_range("my_segmented_vector::insert: iterator out of range");
+        }
+
+        const size_t old_size = size_;
+        append(first, last);
+        std::rotate(begin() + index, begin() + old_size, end());
+        return begin() + index;
+    }
+
+    iterator erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        const size_t start_index = first - cbegin();
+        const size_t end_index = last - cbegin();
+
+        if (start_index > size_ || end_index > size_ || start_index > end_index) {
+            throw std::out_of_range("my_segmented_vector::erase: iterator out of range");
+        }
+
+        if (start_index == end_index) {
+            return begin() + start_index;
+        }
+
+        const size_t count = end_index - start_index;
+        if (start_index < size_ - end_index) {
+            std::move_backward(begin(), begin() + start_index, begin() + end_index);
+            for (size_t i = 0; i < count; ++i) {
+                pop_front();
+            }
+        } else {
+            std::move(begin() + end_index, end(), begin() + start_index);
+            truncate(size_ - count);
+        }
+        return begin() + start_index;
+    }
+
+    void swap(my_segmented_vector& other) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+        map_.swap(other.map_);
+        std::swap(first_chunk_, other.first_chunk_);
+        std::swap(chunk_count_, other.chunk_count_);
+        std::swap(start_, other.start_);
+        std::swap(size_, other.size_);
+    }
+
+    bool operator==(const my_segmented_vector& other) const {
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const my_segmented_vector& other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const my_segmented_vector& other) const {
+        return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+    }
+
+    bool operator<=(const my_segmented_vector& other) const {
+        return !(other < *this);
+    }
+
+    bool operator>(const my_segmented_vector& other) const {
+        return other < *this;
+    }
+
+    bool operator>=(const my_segmented_vector& other) const {
+        return !(*this < other);
+    }
+};
+
+template <typename T, typename Allocator, size_t ChunkBytes>
+void swap(my_segmented_vector<T, Allocator, ChunkBytes>& lhs,
+          my_segmented_vector<T, Allocator, ChunkBytes>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+#endif // MY_SEGMENTED_VECTOR_H
@@ -0,0 +1,459 @@
+#ifndef MY_SIMD_H
+#define MY_SIMD_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+
+// The vector kernels in my_simd_kernels.h are written with GCC vector
+// extensions and compiled once per instruction set; other compilers and
+// architectures get the scalar kernels only.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(__clang__)
+#define MY_SIMD_X86 1
+#endif
+
+enum class my_simd_level { scalar, sse2, avx2, avx512 };
+
+// Vectorized comparison, search and reduction kernels over contiguous
+// arrays of integers, float and double. The instruction set is picked at
+// runtime from what the CPU supports; in constant evaluation the scalar
+// kernels run.
+//
+// Floating point follows the scalar operators: NaN is unequal to everything,
+// so find, count and equal never match it, and less() treats NaN as
+// equivalent to any value, like std::lexicographical_compare. min and max
+// skip NaNs unless every element is one. sum and dot add float and double in
+// a different order than a sequential loop, so results can differ in the last
+// bits; integer sums are computed modulo 2^64 in (unsigned) long long.
+namespace my_simd {
+
+template <typename T>
+inline constexpr bool is_vectorizable_v =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+     (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+template <typename T>
+using sum_t = std::conditional_t<std::is_floating_point_v<T>, T,
+                                 std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>>;
+
+template <typename R>
+concept vectorizable_range = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+                             is_vectorizable_v<std::ranges::range_value_t<R>>;
+
+template <typename R1, typename R2>
+concept vectorizable_range_pair = vectorizable_range<R1> && vectorizable_range<R2> &&
+                                  std::is_same_v<std::ranges::range_value_t<R1>, std::ranges::range_value_t<R2>>;
+
+namespace detail {
+
+struct mismatch_op {};
+struct ordered_mismatch_op {};
+struct find_op {};
+struct count_op {};
+struct min_op {};
+struct max_op {};
+struct sum_op {};
+struct dot_op {};
+struct popcount_op {};
+struct find_nonzero_op {};
+struct and_op {};
+struct or_op {};
+struct xor_op {};
+struct not_op {};
+
+// integers are processed as the standard integer type of the same size and
+// signedness, char16_t as unsigned short and so on
+template <typename T, bool = std::is_integral_v<T>>
+struct lane {
+    using type = T;
+};
+
+template <typename T>
+struct lane<T, true> {
+    using type = std::conditional_t<std::is_signed_v<T>, std::make_signed_t<T>, std::make_unsigned_t<T>>;
+};
+
+template <typename T, size_t Bytes>
+struct vec {
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+template <typename T, size_t Bytes>
+using vec_t = typename vec<T, Bytes>::type;
+
+template <typename T, size_t Bytes>
+struct unaligned_vec {
+    typedef T type __attribute__((vector_size(Bytes), aligned(1), may_alias));
+};
+
+// keeps current unless candidate beats it; a NaN is replaced by anything
+template <bool Max, typename T>
+constexpr bool replaces(const T& candidate, const T& current) noexcept {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (current != current) return true;
+    }
+    return Max ? current < candidate : candidate < current;
+}
+
+template <typename T>
+struct scalar_kernels {
+    using acc_t = std::conditional_t<std::is_floating_point_v<T>, T, unsigned long long>;
+
+    static constexpr size_t run(mismatch_op, const T* a, const T* b, size_t n) noexcept {
+        size_t i = 0;
+        while (i < n && a[i] == b[i]) ++i;
+        return i;
+    }
+
+    static constexpr size_t run(ordered_mismatch_op, const T* a, const T* b, size_t n) noexcept {
+        size_t i = 0;
+        while (i < n && !(a[i] < b[i]) && !(b[i] < a[i])) ++i;
+        return i;
+    }
+
+    static constexpr size_t run(find_op, const T* a, size_t n, T value) noexcept {
+        size_t i = 0;
+        while (i < n && !(a[i] == value)) ++i;
+        return i;
+    }
+
+    static constexpr size_t run(count_op, const T* a, size_t n, T value) noexcept {
+        size_t total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            total += a[i] == value;
+        }
+        return total;
+    }
+
+    template <bool Max>
+    static constexpr T extreme(const T* a, size_t n) noexcept {
+        T result = a[0];
+        for (size_t i = 1; i < n; ++i) {
+            if (replaces<Max>(a[i], result)) result = a[i];
+        }
+        return result;
+    }
+
+    static constexpr T run(min_op, const T* a, size_t n) noexcept { return extreme<false>(a, n); }
+    static constexpr T run(max_op, const T* a, size_t n) noexcept { return extreme<true>(a, n); }
+
+    static constexpr sum_t<T> run(sum_op, const T* a, size_t n) noexcept {
+        acc_t total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            total += static_cast<acc_t>(a[i]);
+        }
+        return static_cast<sum_t<T>>(total);
+    }
+
+    static constexpr sum_t<T> run(dot_op, const T* a, const T* b, size_t n) noexcept {
+        acc_t total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            total += static_cast<acc_t>(a[i]) * static_cast<acc_t>(b[i]);
+        }
+        return static_cast<sum_t<T>>(total);
+    }
+
+    // the bit operations are for integers only
+
+    static constexpr size_t run(popcount_op, const T* a, size_t n) noexcept {
+        size_t total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            total += static_cast<size_t>(std::popcount(static_cast<std::make_unsigned_t<T>>(a[i])));
+        }
+        return total;
+    }
+
+    static constexpr size_t run(find_nonzero_op, const T* a, size_t n) noexcept {
+        size_t i = 0;
+        while (i < n && a[i] == 0) ++i;
+        return i;
+    }
+
+    static constexpr void run(and_op, const T* a, const T* b, T* out, size_t n) noexcept {
+        for (size_t i = 0; i < n; ++i) out[i] = a[i] & b[i];
+    }
+
+    static constexpr void run(or_op, const T* a, const T* b, T* out, size_t n) noexcept {
+        for (size_t i = 0; i < n; ++i) out[i] = a[i] | b[i];
+    }
+
+    static constexpr void run(xor_op, const T* a, const T* b, T* out, size_t n) noexcept {
+        for (size_t i = 0; i < n; ++i) out[i] = a[i] ^ b[i];
+    }
+
+    static constexpr void run(not_op, const T* a, T* out, size_t n) noexcept {
+        for (size_t i = 0; i < n; ++i) out[i] = static_cast<T>(~a[i]);
+    }
+};
+
+} // namespace detail
+
+} // namespace my_simd
+
+#if defined(MY_SIMD_X86)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#define MY_SIMD_KERNELS_NAMESPACE sse2
+#define MY_SIMD_KERNELS_BYTES 16
+#include "my_simd_kernels.h"
+#undef MY_SIMD_KERNELS_NAMESPACE
+#undef MY_SIMD_KERNELS_BYTES
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#define MY_SIMD_KERNELS_NAMESPACE avx2
+#define MY_SIMD_KERNELS_BYTES 32
+#include "my_simd_kernels.h"
+#undef MY_SIMD_KERNELS_NAMESPACE
+#undef MY_SIMD_KERNELS_BYTES
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512dq,avx512vl,fma")
+#define MY_SIMD_KERNELS_NAMESPACE avx512
+#define MY_SIMD_KERNELS_BYTES 64
+#include "my_simd_kernels.h"
+#undef MY_SIMD_KERNELS_NAMESPACE
+#undef MY_SIMD_KERNELS_BYTES
+#pragma GCC pop_options
+#endif
+
+namespace my_simd {
+
+namespace detail {
+
+inline my_simd_level detect_level() noexcept {
+#if defined(MY_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+        return my_simd_level::avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return my_simd_level::avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return my_simd_level::sse2;
+    }
+#endif
+    return my_simd_level::scalar;
+}
+
+inline my_simd_level supported() noexcept {
+    static const my_simd_level level = detect_level();
+    return level;
+}
+
+inline std::atomic<my_simd_level>& active() noexcept {
+    static std::atomic<my_simd_level> level(supported());
+    return level;
+}
+
+template <typename T, typename Op, typename... Args>
+constexpr auto call(Op op, Args... args) noexcept {
+#if defined(MY_SIMD_X86)
+    if (!std::is_constant_evaluated()) {
+        switch (active().load(std::memory_order_relaxed)) {
+        case my_simd_level::avx512:
+            return avx512::kernels<T>::run(op, args...);
+        case my_simd_level::avx2:
+            return avx2::kernels<T>::run(op, args...);
+        case my_simd_level::sse2:
+            return sse2::kernels<T>::run(op, args...);
+        case my_simd_level::scalar:
+            break;
+        }
+    }
+#endif
+    return scalar_kernels<T>::run(op, args...);
+}
+
+constexpr void check_not_empty(size_t n, const char* what) {
+    if (n == 0) {
+        throw std::out_of_range(what);
+    }
+}
+
+} // namespace detail
+
+// the best instruction set this CPU supports
+inline my_simd_level supported_level() noexcept {
+    return detail::supported();
+}
+
+inline my_simd_level active_level() noexcept {
+    return detail::active().load(std::memory_order_relaxed);
+}
+
+// restricts the kernels to level, clamped to supported_level(), e.g. to test
+// or benchmark a fallback; returns the previous level
+inline my_simd_level set_level(my_simd_level level) noexcept {
+    return detail::active().exchange(std::min(level, supported_level()));
+}
+
+// index of the first position where a and b differ, n if there is none
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr size_t mismatch(const T* a, const T* b, size_t n) noexcept {
+    return detail::call<T>(detail::mismatch_op{}, a, b, n);
+}
+
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr bool equal(const T* a, const T* b, size_t n) noexcept {
+    return mismatch(a, b, n) == n;
+}
+
+// lexicographical_compare of [a, a + a_count) and [b, b + b_count)
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr bool less(const T* a, size_t a_count, const T* b, size_t b_count) noexcept {
+    const size_t n = std::min(a_count, b_count);
+    const size_t i = detail::call<T>(detail::ordered_mismatch_op{}, a, b, n);
+    return i < n ? a[i] < b[i] : a_count < b_count;
+}
+
+// index of the first element equal to value, n if there is none
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr size_t find(const T* a, size_t n, std::type_identity_t<T> value) noexcept {
+    return detail::call<T>(detail::find_op{}, a, n, value);
+}
+
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr size_t count(const T* a, size_t n, std::type_identity_t<T> value) noexcept {
+    return detail::call<T>(detail::count_op{}, a, n, value);
+}
+
+// throws std::out_of_range if n is 0
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr T min(const T* a, size_t n) {
+    detail::check_not_empty(n, "my_simd::min: empty range");
+    return detail::call<T>(detail::min_op{}, a, n);
+}
+
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr T max(const T* a, size_t n) {
+    detail::check_not_empty(n, "my_simd::max: empty range");
+    return detail::call<T>(detail::max_op{}, a, n);
+}
+
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr sum_t<T> sum(const T* a, size_t n) noexcept {
+    return detail::call<T>(detail::sum_op{}, a, n);
+}
+
+template <typename T>
+    requires is_vectorizable_v<T>
+constexpr sum_t<T> dot(const T* a, const T* b, size_t n) noexcept {
+    return detail::call<T>(detail::dot_op{}, a, b, n);
+}
+
+// Bit operations over arrays of integers, e.g. the words of a bit set.
+
+// number of set bits in [a, a + n)
+template <typename T>
+    requires is_vectorizable_v<T> && std::is_integral_v<T>
+constexpr size_t popcount(const T* a, size_t n) noexcept {
+    return detail::call<T>(detail::popcount_op{}, a, n);
+}
+
+// index of the first nonzero element, n if there is none
+template <typename T>
+    requires is_vectorizable_v<T> && std::is_integral_v<T>
+constexpr size_t find_nonzero(const T* a, size_t n) noexcept {
+    return detail::call<T>(detail::find_nonzero_op{}, a, n);
+}
+
+// out[i] = a[i] & b[i] for i < n; out may be a or b, but not overlap them otherwise
+template <typename T>
+    requires is_vectorizable_v<T> && std::is_integral_v<T>
+constexpr void bit_and(const T* a, const T* b, T* out, size_t n) noexcept {
+    detail::call<T>(detail::and_op{}, a, b, out, n);
+}
+
+template <typename T>
+    requires is_vectorizable_v<T> && std::is_integral_v<T>
+constexpr void bit_or(const T* a, const T* b, T* out, size_t n) noexcept {
+    detail::call<T>(detail::or_op{}, a, b, out, n);
+}
+
+template <typename T>
+    requires is_vectorizable_v<T> && std::is_integral_v<T>
+constexpr void bit_xor(const T* a, const T* b, T* out, size_t n) noexcept {
+    detail::call<T>(detail::xor_op{}, a, b, out, n);
+}
+
+// out[i] = ~a[i]; out may be a
+template <typename T>
+    requires is_vectorizable_v<T> && std::is_integral_v<T>
+constexpr void bit_not(const T* a, T* out, size_t n) noexcept {
+    detail::call<T>(detail::not_op{}, a, out, n);
+}
+
+// The same kernels over whole containers: my_vector, my_small_vector,
+// my_array, std::vector, spans and anything else contiguous.
+
+template <typename R1, typename R2>
+    requires vectorizable_range_pair<R1, R2>
+constexpr bool equal(const R1& a, const R2& b) noexcept {
+    return std::ranges::size(a) == std::ranges::size(b) &&
+           equal(std::ranges::data(a), std::ranges::data(b), std::ranges::size(a));
+}
+
+template <typename R1, typename R2>
+    requires vectorizable_range_pair<R1, R2>
+constexpr bool less(const R1& a, const R2& b) noexcept {
+    return less(std::ranges::data(a), std::ranges::size(a), std::ranges::data(b), std::ranges::size(b));
+}
+
+template <vectorizable_range R>
+constexpr auto find(R& range, const std::ranges::range_value_t<R>& value) noexcept {
+    return std::ranges::begin(range) + find(std::ranges::data(range), std::ranges::size(range), value);
+}
+
+template <vectorizable_range R>
+constexpr size_t count(const R& range, const std::ranges::range_value_t<R>& value) noexcept {
+    return count(std::ranges::data(range), std::ranges::size(range), value);
+}
+
+template <vectorizable_range R>
+constexpr auto min(const R& range) {
+    return min(std::ranges::data(range), std::ranges::size(range));
+}
+
+template <vectorizable_range R>
+constexpr auto max(const R& range) {
+    return max(std::ranges::data(range), std::ranges::size(range));
+}
+
+template <vectorizable_range R>
+constexpr auto sum(const R& range) noexcept {
+    return sum(std::ranges::data(range), std::ranges::size(range));
+}
+
+// throws std::invalid_argument if the sizes differ
+template <typename R1, typename R2>
+    requires vectorizable_range_pair<R1, R2>
+constexpr auto dot(const R1& a, const R2& b) {
+    if (std::ranges::size(a) != std::ranges::size(b)) {
+        throw std::invalid_argument("my_simd::dot: ranges differ in size");
+    }
+    return dot(std::ranges::data(a), std::ranges::data(b), std::ranges::size(a));
+}
+
+} // namespace my_simd
+
+#endif // MY_SIMD_H
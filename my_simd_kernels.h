@@ -0,0 +1,285 @@
+// No include guard: my_simd.h includes this file once per instruction set,
+// each time inside a #pragma GCC target region and with
+// MY_SIMD_KERNELS_NAMESPACE and MY_SIMD_KERNELS_BYTES (the register width)
+// defined. Everything here must be defined in the region, not merely
+// instantiated from it: GCC lowers vector operations per function before
+// inlining, with the target of the function that contains them.
+
+namespace my_simd::detail::MY_SIMD_KERNELS_NAMESPACE {
+
+// Every loop leaves the tail of fewer than a vector to the scalar kernels.
+template <typename T>
+struct kernels {
+    static constexpr size_t Bytes = MY_SIMD_KERNELS_BYTES;
+
+    using scalar = scalar_kernels<T>;
+    using lane_t = typename lane<T>::type;
+    using V = vec_t<lane_t, Bytes>;
+    using U = typename unaligned_vec<lane_t, Bytes>::type;
+    using M = decltype(V{} != V{});
+    static constexpr size_t L = Bytes / sizeof(T);
+
+    // an integer sum or product is widened to 64-bit lanes, W elements at a time
+    static constexpr size_t W = Bytes / 8;
+    using narrow_t = typename unaligned_vec<lane_t, W * sizeof(T)>::type;
+    using wide_t = vec_t<unsigned long long, Bytes>;
+
+    // unaligned load of a vector of lanes from T elements
+    template <typename Vec = U>
+    [[gnu::always_inline]] static const Vec& at(const T* ptr) noexcept {
+        return *reinterpret_cast<const Vec*>(ptr);
+    }
+
+    [[gnu::always_inline]] static bool any(const M& mask) noexcept {
+        const wide_t words = reinterpret_cast<const wide_t&>(mask);
+        unsigned long long bits = 0;
+        for (size_t k = 0; k < W; ++k) {
+            bits |= words[k];
+        }
+        return bits != 0;
+    }
+
+    template <typename Op>
+    [[gnu::always_inline]] static void differs(Op, M& mask, const U& x, const U& y) noexcept {
+        if constexpr (std::is_same_v<Op, ordered_mismatch_op> && std::is_floating_point_v<T>) {
+            mask |= (x < y) | (y < x);
+        } else {
+            mask |= x != y;
+        }
+    }
+
+    template <typename Op>
+    [[gnu::always_inline]] static size_t mismatch(Op op, const T* a, const T* b, size_t n) noexcept {
+        size_t i = 0;
+        for (; i + 4 * L <= n; i += 4 * L) {
+            M mask{};
+            for (size_t k = 0; k < 4 * L; k += L) {
+                differs(op, mask, at(a + i + k), at(b + i + k));
+            }
+            if (any(mask)) break;
+        }
+        for (; i + L <= n; i += L) {
+            M mask{};
+            differs(op, mask, at(a + i), at(b + i));
+            if (any(mask)) break;
+        }
+        return i + scalar::run(op, a + i, b + i, n - i);
+    }
+
+    static size_t run(mismatch_op op, const T* a, const T* b, size_t n) noexcept {
+        return mismatch(op, a, b, n);
+    }
+
+    static size_t run(ordered_mismatch_op op, const T* a, const T* b, size_t n) noexcept {
+        return mismatch(op, a, b, n);
+    }
+
+    static size_t run(find_op op, const T* a, size_t n, T value) noexcept {
+        const V needle = V{} + static_cast<lane_t>(value);
+        size_t i = 0;
+        for (; i + 4 * L <= n; i += 4 * L) {
+            M mask{};
+            for (size_t k = 0; k < 4 * L; k += L) {
+                mask |= at(a + i + k) == needle;
+            }
+            if (any(mask)) break;
+        }
+        for (; i + L <= n; i += L) {
+            if (any(at(a + i) == needle)) break;
+        }
+        return i + scalar::run(op, a + i, n - i, value);
+    }
+
+    static size_t run(count_op op, const T* a, size_t n, T value) noexcept {
+        // a match is -1 in the mask; the per-lane counters are flushed before
+        // they overflow their lane width
+        constexpr size_t flush_every = (size_t(1) << (8 * sizeof(T) - 1)) - 1;
+        const V needle = V{} + static_cast<lane_t>(value);
+        size_t total = 0;
+        size_t i = 0;
+        while (i + L <= n) {
+            const size_t blocks = std::min((n - i) / L, flush_every);
+            M counts{};
+            for (size_t b = 0; b < blocks; ++b, i += L) {
+                counts -= at(a + i) == needle;
+            }
+            for (size_t k = 0; k < L; ++k) {
+                total += static_cast<size_t>(counts[k]);
+            }
+        }
+        return total + scalar::run(op, a + i, n - i, value);
+    }
+
+    template <bool Max>
+    [[gnu::always_inline]] static void pick(V& acc, const U& x) noexcept {
+        M better = Max ? acc < x : x < acc;
+        if constexpr (std::is_floating_point_v<T>) {
+            better |= acc != acc;
+        }
+        acc = better ? x : acc;
+    }
+
+    // the last vector is loaded overlapping the previous one, which is
+    // harmless for min and max
+    template <bool Max>
+    [[gnu::always_inline]] static T extreme(const T* a, size_t n) noexcept {
+        if (n < L) {
+            return scalar::template extreme<Max>(a, n);
+        }
+        V acc = at(a);
+        for (size_t i = L; i < n; i += L) {
+            pick<Max>(acc, at(a + std::min(i, n - L)));
+        }
+        T result = static_cast<T>(acc[0]);
+        for (size_t k = 1; k < L; ++k) {
+            if (replaces<Max>(static_cast<T>(acc[k]), result)) result = static_cast<T>(acc[k]);
+        }
+        return result;
+    }
+
+    static T run(min_op, const T* a, size_t n) noexcept { return extreme<false>(a, n); }
+    static T run(max_op, const T* a, size_t n) noexcept { return extreme<true>(a, n); }
+
+    static sum_t<T> run(sum_op op, const T* a, size_t n) noexcept {
+        size_t i = 0;
+        if constexpr (std::is_floating_point_v<T>) {
+            V acc[4] = {};
+            for (; i + 4 * L <= n; i += 4 * L) {
+                for (size_t k = 0; k < 4; ++k) {
+                    acc[k] += at(a + i + k * L);
+                }
+            }
+            acc[0] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            T total = 0;
+            for (size_t k = 0; k < L; ++k) {
+                total += acc[0][k];
+            }
+            return total + scalar::run(op, a + i, n - i);
+        } else {
+            wide_t acc[4] = {};
+            for (; i + 4 * W <= n; i += 4 * W) {
+                for (size_t k = 0; k < 4; ++k) {
+                    acc[k] += __builtin_convertvector(at<narrow_t>(a + i + k * W), wide_t);
+                }
+            }
+            acc[0] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            unsigned long long total = 0;
+            for (size_t k = 0; k < W; ++k) {
+                total += acc[0][k];
+            }
+            return static_cast<sum_t<T>>(total + static_cast<unsigned long long>(scalar::run(op, a + i, n - i)));
+        }
+    }
+
+    static sum_t<T> run(dot_op op, const T* a, const T* b, size_t n) noexcept {
+        size_t i = 0;
+        if constexpr (std::is_floating_point_v<T>) {
+            V acc[4] = {};
+            for (; i + 4 * L <= n; i += 4 * L) {
+                for (size_t k = 0; k < 4; ++k) {
+                    acc[k] += at(a + i + k * L) * at(b + i + k * L);
+                }
+            }
+            acc[0] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            T total = 0;
+            for (size_t k = 0; k < L; ++k) {
+                total += acc[0][k];
+            }
+            return total + scalar::run(op, a + i, b + i, n - i);
+        } else {
+            wide_t acc[4] = {};
+            for (; i + 4 * W <= n; i += 4 * W) {
+                for (size_t k = 0; k < 4; ++k) {
+                    acc[k] += __builtin_convertvector(at<narrow_t>(a + i + k * W), wide_t) *
+                              __builtin_convertvector(at<narrow_t>(b + i + k * W), wide_t);
+                }
+            }
+            acc[0] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            unsigned long long total = 0;
+            for (size_t k = 0; k < W; ++k) {
+                total += acc[0][k];
+            }
+            return static_cast<sum_t<T>>(total +
+                                         static_cast<unsigned long long>(scalar::run(op, a + i, b + i, n - i)));
+        }
+    }
+
+    // bit counts of the bytes of x, each at most 8, in place
+    [[gnu::always_inline]] static wide_t byte_popcounts(wide_t x) noexcept {
+        x -= (x >> 1) & 0x5555555555555555ULL;
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        return (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    }
+
+    // the bytes hold at most 31 * 8 bits each, so they never carry over
+    static size_t run(popcount_op op, const T* a, size_t n) noexcept {
+        using WU = typename unaligned_vec<unsigned long long, Bytes>::type;
+        constexpr size_t flush_every = 31;
+        size_t total = 0;
+        size_t i = 0;
+        while (i + L <= n) {
+            const size_t blocks = std::min((n - i) / L, flush_every);
+            wide_t counts{};
+            for (size_t b = 0; b < blocks; ++b, i += L) {
+                counts += byte_popcounts(at<WU>(a + i));
+            }
+            counts = (counts & 0x00ff00ff00ff00ffULL) + ((counts >> 8) & 0x00ff00ff00ff00ffULL);
+            counts += counts >> 16;
+            counts += counts >> 32;
+            for (size_t k = 0; k < W; ++k) {
+                total += static_cast<size_t>(counts[k] & 0xffff);
+            }
+        }
+        return total + scalar::run(op, a + i, n - i);
+    }
+
+    static size_t run(find_nonzero_op op, const T* a, size_t n) noexcept {
+        size_t i = 0;
+        for (; i + 4 * L <= n; i += 4 * L) {
+            const U x = at(a + i) | at(a + i + L) | at(a + i + 2 * L) | at(a + i + 3 * L);
+            if (any(x != V{})) break;
+        }
+        for (; i + L <= n; i += L) {
+            if (any(at(a + i) != V{})) break;
+        }
+        return i + scalar::run(op, a + i, n - i);
+    }
+
+    [[gnu::always_inline]] static void store(T* ptr, const V& x) noexcept {
+        *reinterpret_cast<U*>(ptr) = x;
+    }
+
+    static void run(and_op op, const T* a, const T* b, T* out, size_t n) noexcept {
+        size_t i = 0;
+        for (; i + L <= n; i += L) {
+            store(out + i, at(a + i) & at(b + i));
+        }
+        scalar::run(op, a + i, b + i, out + i, n - i);
+    }
+
+    static void run(or_op op, const T* a, const T* b, T* out, size_t n) noexcept {
+        size_t i = 0;
+        for (; i + L <= n; i += L) {
+            store(out + i, at(a + i) | at(b + i));
+        }
+        scalar::run(op, a + i, b + i, out + i, n - i);
+    }
+
+    static void run(xor_op op, const T* a, const T* b, T* out, size_t n) noexcept {
+        size_t i = 0;
+        for (; i + L <= n; i += L) {
+            store(out + i, at(a + i) ^ at(b + i));
+        }
+        scalar::run(op, a + i, b + i, out + i, n - i);
+    }
+
+    static void run(not_op op, const T* a, T* out, size_t n) noexcept {
+        size_t i = 0;
+        for (; i + L <= n; i += L) {
+            store(out + i, ~at(a + i));
+        }
+        scalar::run(op, a + i, out + i, n - i);
+    }
+};
+
+} // namespace my_simd::detail::MY_SIMD_KERNELS_NAMESPACE
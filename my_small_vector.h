@@ -0,0 +1,637 @@
+#ifndef MY_SMALL_VECTOR_H
+#define MY_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "my_array.h"
+#include "my_growth.h"
+#include "my_vector.h"
+
+// my_vector with the first N elements stored inline, in the object itself.
+// Heap storage is allocated only once the size grows past N, and grows as
+// GrowthPolicy says from there.
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = my_growth_double>
+class my_small_vector {
+private:
+    static_assert(N > 0, "my_small_vector: inline capacity must be positive");
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    // heap buffers change hands only with the allocator that owns them;
+    // otherwise a move allocates and moves element by element
+    static constexpr bool nothrow_move_assignable = std::is_nothrow_move_constructible_v<T> &&
+        (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value);
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "my_small_vector: Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T*>,
+                  "my_small_vector: allocators with fancy pointers are not supported");
+
+    T* data_;
+    size_t capacity_;
+    size_t size_;
+    [[no_unique_address]] Allocator alloc_;
+    // raw bytes for N elements, left uninitialized by my_array's default constructor
+    alignas(T) my_array<std::byte, N * sizeof(T)> inline_;
+
+    T* inline_data() noexcept { return reinterpret_cast<T*>(inline_.data()); }
+
+    size_t calc_cap(size_t new_min_capacity) const {
+        return GrowthPolicy::next_capacity(capacity_, new_min_capacity, sizeof(T));
+    }
+
+    T* acquire(size_t count) {
+        return count <= N ? inline_data() : alloc_traits::allocate(alloc_, count);
+    }
+
+    void release_storage(T* ptr, size_t count) noexcept {
+        if (ptr != inline_data()) {
+            alloc_traits::deallocate(alloc_, ptr, count);
+        }
+    }
+
+    void destroy(T* first, T* last) noexcept {
+        for (; first != last; ++first) {
+            alloc_traits::destroy(alloc_, first);
+        }
+    }
+
+    template <typename Construct>
+    void construct_n(T* dst, size_t count, Construct&& make) {
+        size_t i = 0;
+        try {
+            for (; i < count; ++i) {
+                make(dst + i);
+            }
+        } catch (...) {
+            destroy(dst, dst + i);
+            throw;
+        }
+    }
+
+    static void relocate_bytes(T* src, size_t count, T* dst) noexcept {
+        if (count) {
+            std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
+        }
+    }
+
+    void move_construct_n(T* src, size_t count, T* dst) {
+        construct_n(dst, count, [&](T* ptr) {
+            alloc_traits::construct(alloc_, ptr, std::move_if_noexcept(*src++));
+        });
+    }
+
+    // same contract as my_vector::reallocate_with_gap; a new_cap of at most N
+    // moves the elements back into the inline buffer
+    template <typename Construct>
+    void reallocate_with_gap(size_t new_cap, size_t index, size_t count, Construct&& make) {
+        T* new_data = acquire(new_cap);
+        new_cap = std::max(new_cap, N);
+
+        if constexpr (is_trivially_relocatable_v<T>) {
+            try {
+                construct_n(new_data + index, count, make);
+            } catch (...) {
+                release_storage(new_data, new_cap);
+                throw;
+            }
+
+            relocate_bytes(data_, index, new_data);
+            relocate_bytes(data_ + index, size_ - index, new_data + index + count);
+        } else {
+            T* live_first = new_data + index;
+            T* live_last = live_first;
+
+            try {
+                construct_n(new_data + index, count, make);
+                live_last += count;
+                move_construct_n(data_, index, new_data);
+                live_first = new_data;
+                move_construct_n(data_ + index, size_ - index, new_data + index + count);
+            } catch (...) {
+                destroy(live_first, live_last);
+                release_storage(new_data, new_cap);
+                throw;
+            }
+
+            destroy(data_, data_ + size_);
+        }
+
+        release_storage(data_, capacity_);
+        data_ = new_data;
+        capacity_ = new_cap;
+        size_ += count;
+    }
+
+    template <typename... Args>
+    void emplace_at(size_t index, Args&&... args) {
+        if (size_ >= capacity_) {
+            reallocate_with_gap(calc_cap(size_ + 1), index, 1, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, std::forward<Args>(args)...);
+            });
+        } else if (index == size_) {
+            alloc_traits::construct(alloc_, data_ + size_, std::forward<Args>(args)...);
+            ++size_;
+        } else if constexpr (is_trivially_relocatable_v<T>) {
+            alignas(T) unsigned char buffer[sizeof(T)];
+            T* value = reinterpret_cast<T*>(buffer);
+            alloc_traits::construct(alloc_, value, std::forward<Args>(args)...);
+
+            relocate_bytes(data_ + index, size_ - index, data_ + index + 1);
+            relocate_bytes(value, 1, data_ + index);
+            ++size_;
+        } else {
+            T value(std::forward<Args>(args)...);
+            alloc_traits::construct(alloc_, data_ + size_, std::move(data_[size_ - 1]));
+            ++size_;
+            std::move_backward(data_ + index, data_ + size_ - 2, data_ + size_ - 1);
+            data_[index] = std::move(value);
+        }
+    }
+
+    // inserts count elements read from first before index, growing the
+    // storage at most once
+    template <typename ForwardIt>
+    void insert_n(size_t index, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        if constexpr (std::contiguous_iterator<ForwardIt>) {
+            // a range over our own elements would be shifted under it
+            const T* source = std::to_address(first);
+            if (std::less_equal<const T*>()(data_, source) && std::less<const T*>()(source, data_ + size_)) {
+                const my_vector<T, Allocator> copy(first, first + count, alloc_);
+                insert_n(index, copy.begin(), count);
+                return;
+            }
+        }
+
+        if (size_ + count > capacity_) {
+            reallocate_with_gap(calc_cap(size_ + count), index, count, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, *first);
+                ++first;
+            });
+        } else if constexpr (is_trivially_relocatable_v<T>) {
+            T* gap = data_ + index;
+            const size_t elems_after = size_ - index;
+            relocate_bytes(gap, elems_after, gap + count);
+
+            try {
+                construct_n(gap, count, [&](T* ptr) {
+                    alloc_traits::construct(alloc_, ptr, *first);
+                    ++first;
+                });
+            } catch (...) {
+                relocate_bytes(gap + count, elems_after, gap);
+                throw;
+            }
+
+            size_ += count;
+        } else {
+            T* old_end = end();
+            const size_t elems_after = size_ - index;
+
+            if (elems_after > count) {
+                move_construct_n(old_end - count, count, old_end);
+                size_ += count;
+                std::move_backward(data_ + index, old_end - count, old_end);
+                std::copy_n(first, count, data_ + index);
+            } else {
+                ForwardIt mid = first;
+                std::advance(mid, elems_after);
+                construct_n(old_end, count - elems_after, [&](T* ptr) {
+                    alloc_traits::construct(alloc_, ptr, *mid);
+                    ++mid;
+                });
+                size_ += count - elems_after;
+                move_construct_n(data_ + index, elems_after, end());
+                size_ += elems_after;
+                std::copy_n(first, elems_after, data_ + index);
+            }
+        }
+    }
+
+    // appends the elements of an input range, reading it once, and rotates
+    // them into place
+    template <typename R>
+    void insert_single_pass(size_t index, R&& range) {
+        const size_t old_size = size_;
+        if constexpr (std::ranges::sized_range<R>) {
+            const size_t needed = size_ + static_cast<size_t>(std::ranges::size(range));
+            if (needed > capacity_) {
+                reserve(calc_cap(needed));
+            }
+        }
+
+        try {
+            for (auto&& value : range) {
+                emplace_back(std::forward<decltype(value)>(value));
+            }
+        } catch (...) {
+            destroy(data_ + old_size, data_ + size_);
+            size_ = old_size;
+            throw;
+        }
+        std::rotate(data_ + index, data_ + old_size, data_ + size_);
+    }
+
+    template <typename R>
+    void insert_range_at(size_t index, R&& range) {
+        if constexpr (std::ranges::forward_range<R>) {
+            insert_n(index, std::ranges::begin(range), static_cast<size_t>(std::ranges::distance(range)));
+        } else {
+            insert_single_pass(index, std::forward<R>(range));
+        }
+    }
+
+    // destroys the elements and goes back to the empty inline buffer
+    void reset() noexcept {
+        destroy(data_, data_ + size_);
+        release_storage(data_, capacity_);
+        data_ = inline_data();
+        capacity_ = N;
+        size_ = 0;
+    }
+
+    // takes over the contents of other, *this must be empty and inline;
+    // heap buffers are stolen, inline elements are moved one by one
+    void take(my_small_vector& other) {
+        if (!other.is_inline() && (alloc_traits::is_always_equal::value || alloc_ == other.alloc_)) {
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            size_ = other.size_;
+
+            other.data_ = other.inline_data();
+            other.capacity_ = N;
+            other.size_ = 0;
+            return;
+        }
+
+        reserve(other.size_);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            relocate_bytes(other.data_, other.size_, data_);
+            size_ = other.size_;
+            other.size_ = 0;
+        } else {
+            T* src = other.data_;
+            construct_n(data_, other.size_, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, std::move(*src++));
+            });
+            size_ = other.size_;
+            other.clear();
+        }
+    }
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    my_small_vector() noexcept(noexcept(Allocator())) : my_small_vector(Allocator()) {}
+
+    explicit my_small_vector(const Allocator& alloc) noexcept
+        : data_(inline_data()), capacity_(N), size_(0), alloc_(alloc) {}
+
+    explicit my_small_vector(size_t count, const Allocator& alloc = Allocator()) : my_small_vector(alloc) {
+        resize(count);
+    }
+
+    my_small_vector(size_t count, const T& value, const Allocator& alloc = Allocator())
+        : my_small_vector(alloc) {
+        resize(count, value);
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    my_small_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : my_small_vector(alloc) {
+        insert_range_at(0, std::ranges::subrange(first, last));
+    }
+
+    my_small_vector(std::initializer_list<T> ilist, const Allocator& alloc = Allocator())
+        : my_small_vector(alloc) {
+        insert_n(0, ilist.begin(), ilist.size());
+    }
+
+    my_small_vector(const my_small_vector& other)
+        : my_small_vector(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
+        insert_n(0, other.begin(), other.size_);
+    }
+
+    my_small_vector(const my_small_vector& other, const Allocator& alloc) : my_small_vector(alloc) {
+        insert_n(0, other.begin(), other.size_);
+    }
+
+    my_small_vector(my_small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : data_(inline_data()), capacity_(N), size_(0), alloc_(other.alloc_) {
+        take(other);
+    }
+
+    ~my_small_vector() {
+        reset();
+    }
+
+    // copy-and-swap: the copy is built aside, with the allocator *this ends
+    // up with, so a throwing copy leaves *this as it was
+    my_small_vector& operator=(const my_small_vector& other) {
+        if (this != &other) {
+            constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+            my_small_vector copy(other, propagate ? other.alloc_ : alloc_);
+            reset();
+            if constexpr (propagate) {
+                alloc_ = other.alloc_;
+            }
+            take(copy);
+        }
+        return *this;
+    }
+
+    my_small_vector& operator=(my_small_vector&& other) noexcept(nothrow_move_assignable) {
+        if (this != &other) {
+            reset();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                alloc_ = other.alloc_;
+            }
+            take(other);
+        }
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+    T& operator[](size_t idx) noexcept { return data_[idx]; }
+    const T& operator[](size_t idx) const noexcept { return data_[idx]; }
+
+    T& at(size_t idx) {
+        if (idx >= size_) {
+            throw std::out_of_range("my_small_vector::at: index out of range");
+        }
+        return data_[idx];
+    }
+
+    const T& at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("my_small_vector::at: index out of range");
+        }
+        return data_[idx];
+    }
+
+    T& front() { return data_[0]; }
+    const T& front() const { return data_[0]; }
+
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    T* begin() noexcept { return data_; }
+    const T* begin() const noexcept { return data_; }
+    const T* cbegin() const noexcept { return data_; }
+
+    T* end() noexcept { return data_ + size_; }
+    const T* end() const noexcept { return data_ + size_; }
+    const T* cend() const noexcept { return data_ + size_; }
+
+    std::reverse_iterator<T*> rbegin() noexcept { return std::reverse_iterator<T*>(end()); }
+    std::reverse_iterator<const T*> rbegin() const noexcept { return std::reverse_iterator<const T*>(end()); }
+    std::reverse_iterator<const T*> crbegin() const noexcept { return std::reverse_iterator<const T*>(end()); }
+
+    std::reverse_iterator<T*> rend() noexcept { return std::reverse_iterator<T*>(begin()); }
+    std::reverse_iterator<const T*> rend() const noexcept { return std::reverse_iterator<const T*>(begin()); }
+    std::reverse_iterator<const T*> crend() const noexcept { return std::reverse_iterator<const T*>(begin()); }
+
+    bool is_empty() const noexcept { return size_ == 0; }
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return capacity_; }
+    static constexpr size_t inline_capacity() noexcept { return N; }
+    bool is_inline() const noexcept { return data_ == reinterpret_cast<const T*>(inline_.data()); }
+
+    void reserve(size_t new_cap) {
+        if (new_cap <= capacity_) return;
+
+        reallocate_with_gap(new_cap, size_, 0, [](T*) {});
+    }
+
+    void shrink_to_fit() {
+        if (!is_inline() && size_ < capacity_) {
+            reallocate_with_gap(size_, size_, 0, [](T*) {});
+        }
+    }
+
+    void clear() noexcept {
+        destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    void resize(size_t count) {
+        if (count > capacity_) {
+            reallocate_with_gap(count, size_, count - size_, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr);
+            });
+        } else if (count > size_) {
+            construct_n(data_ + size_, count - size_, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr);
+            });
+            size_ = count;
+        } else {
+            destroy(data_ + count, data_ + size_);
+            size_ = count;
+        }
+    }
+
+    void resize(size_t count, const T& value) {
+        if (count > capacity_) {
+            reallocate_with_gap(count, size_, count - size_, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, value);
+            });
+        } else if (count > size_) {
+            construct_n(data_ + size_, count - size_, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, value);
+            });
+            size_ = count;
+        } else {
+            destroy(data_ + count, data_ + size_);
+            size_ = count;
+        }
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() {
+        if (size_ > 0) {
+            --size_;
+            alloc_traits::destroy(alloc_, data_ + size_);
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        emplace_at(size_, std::forward<Args>(args)...);
+        return data_[size_ - 1];
+    }
+
+    template <typename... Args>
+    T* emplace(const T* pos, Args&&... args) {
+        const size_t index = pos - begin();
+        if (index > size_) {
+            throw std::out_of_range("my_small_vector::emplace: iterator out of range");
+        }
+
+        emplace_at(index, std::forward<Args>(args)...);
+        return begin() + index;
+    }
+
+    T* insert(const T* pos, const T& value) {
+        const size_t index = pos - begin();
+        if (index > size_) {
+            throw std::out_of_range("my_small_vector::insert: iterator out of range");
+        }
+
+        emplace_at(index, value);
+        return begin() + index;
+    }
+
+    T* insert(const T* pos, T&& value) {
+        const size_t index = pos - begin();
+        if (index > size_) {
+            throw std::out_of_range("my_small_vector::insert: iterator out of range");
+        }
+
+        emplace_at(index, std::move(value));
+        return begin() + index;
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    T* insert(const T* pos, InputIt first, InputIt last) {
+        return insert_range(pos, std::ranges::subrange(first, last));
+    }
+
+    // Inserts the elements of a range before pos, as my_vector::insert_range
+    // does: forward ranges grow the storage at most once, input ranges are
+    // read exactly once.
+    template <std::ranges::input_range R>
+    T* insert_range(const T* pos, R&& range) {
+        const size_t index = pos - begin();
+        if (index > size_) {
+            throw std::out_of_range("my_small_vector::insert_range: iterator out of range");
+        }
+
+        insert_range_at(index, std::forward<R>(range));
+        return begin() + index;
+    }
+
+    template <std::ranges::input_range R>
+    void append_range(R&& range) {
+        insert_range_at(size_, std::forward<R>(range));
+    }
+
+    T* erase(const T* pos) {
+        return erase(pos, pos + 1);
+    }
+
+    T* erase(const T* first, const T* last) {
+        const size_t start_index = first - begin();
+        const size_t end_index = last - begin();
+
+        if (start_index > size_ || end_index > size_ || start_index > end_index) {
+            throw std::out_of_range("my_small_vector::erase: iterator out of range");
+        }
+
+        if (start_index == end_index) {
+            return begin() + start_index;
+        }
+
+        const size_t count = end_index - start_index;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            destroy(data_ + start_index, data_ + end_index);
+            relocate_bytes(data_ + end_index, size_ - end_index, data_ + start_index);
+        } else {
+            std::move(data_ + end_index, data_ + size_, data_ + start_index);
+            destroy(data_ + size_ - count, data_ + size_);
+        }
+
+        size_ -= count;
+        return begin() + start_index;
+    }
+
+    // pointer swap when both sides are on the heap, element moves otherwise
+    void swap(my_small_vector& other) noexcept(nothrow_move_assignable) {
+        if (this == &other) return;
+
+        if (!is_inline() && !other.is_inline()) {
+            if constexpr (alloc_traits::propagate_on_container_swap::value) {
+                std::swap(alloc_, other.alloc_);
+            }
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(capacity_, other.capacity_);
+            return;
+        }
+
+        my_small_vector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    bool operator==(const my_small_vector& other) const {
+        if constexpr (my_simd::is_vectorizable_v<T>) {
+            return size_ == other.size_ && my_simd::equal(data_, other.data_, size_);
+        }
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const my_small_vector& other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const my_small_vector& other) const {
+        if constexpr (my_simd::is_vectorizable_v<T>) {
+            return my_simd::less(data_, size_, other.data_, other.size_);
+        }
+        return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+    }
+
+    bool operator<=(const my_small_vector& other) const {
+        return !(other < *this);
+    }
+
+    bool operator>(const my_small_vector& other) const {
+        return other < *this;
+    }
+
+    bool operator>=(const my_small_vector& other) const {
+        return !(*this < other);
+    }
+};
+
+template <typename T, size_t N, typename Allocator, typename GrowthPolicy>
+void swap(my_small_vector<T, N, Allocator, GrowthPolicy>& lhs, my_small_vector<T, N, Allocator, GrowthPolicy>& rhs)
+    noexcept(noexcept(lhs.swap(rhs))) {
+    lhs.swap(rhs);
+}
+
+namespace pmr {
+template <typename T, size_t N>
+using my_small_vector = ::my_small_vector<T, N, std::pmr::polymorphic_allocator<T>>;
+}
+
+#endif // MY_SMALL_VECTOR_H
@@ -0,0 +1,164 @@
+#ifndef MY_SNAPSHOT_H
+#define MY_SNAPSHOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "my_growth.h"
+#include "my_vector.h"
+
+// Immutable, reference-counted view of a my_vector, for handing one version of
+// a large vector to many readers. Building one moves the vector in without
+// copying the elements; copies of a snapshot share them. A default-constructed
+// snapshot is empty.
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = my_growth_double>
+class my_snapshot {
+public:
+    using vector_type = my_vector<T, Allocator, GrowthPolicy>;
+
+private:
+    template <typename, typename, typename>
+    friend class my_snapshot_builder;
+    template <typename, typename, typename>
+    friend class my_atomic_snapshot;
+
+    std::shared_ptr<const vector_type> data_;
+
+    explicit my_snapshot(std::shared_ptr<const vector_type> data) noexcept : data_(std::move(data)) {}
+
+public:
+    using value_type = T;
+
+    my_snapshot() noexcept = default;
+
+    explicit my_snapshot(vector_type&& vector) : data_(std::make_shared<vector_type>(std::move(vector))) {}
+
+    const T& operator[](size_t idx) const noexcept { return (*data_)[idx]; }
+
+    const T& at(size_t idx) const {
+        if (idx >= size()) {
+            throw std::out_of_range("my_snapshot::at: index out of range");
+        }
+        return (*data_)[idx];
+    }
+
+    const T& front() const { return data_->front(); }
+    const T& back() const { return data_->back(); }
+
+    const T* data() const noexcept { return data_ ? data_->data() : nullptr; }
+
+    const T* begin() const noexcept { return data(); }
+    const T* end() const noexcept { return data() + size(); }
+    const T* cbegin() const noexcept { return begin(); }
+    const T* cend() const noexcept { return end(); }
+
+    bool is_empty() const noexcept { return size() == 0; }
+    size_t size() const noexcept { return data_ ? data_->size() : 0; }
+
+    // the number of snapshots, builders and atomic slots sharing the elements
+    long use_count() const noexcept { return data_.use_count(); }
+
+    // for the algorithms taking a my_vector; an empty snapshot has none
+    const vector_type* vector() const noexcept { return data_.get(); }
+
+    // the same version, not merely equal elements
+    bool shares_with(const my_snapshot& other) const noexcept { return data_ == other.data_; }
+
+    bool operator==(const my_snapshot& other) const {
+        if (data_ == other.data_) {
+            return true;
+        }
+        if (!data_ || !other.data_) {
+            return size() == other.size();
+        }
+        return *data_ == *other.data_;
+    }
+};
+
+// Mutable vector that turns into snapshots without copying. snapshot() shares
+// the current elements; the next edit() then copies them once, so that the
+// snapshots keep their version, while edits of an unshared vector happen in
+// place. A reference returned by edit() must not be used after the next
+// snapshot(). A builder is meant for one writer thread.
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = my_growth_double>
+class my_snapshot_builder {
+public:
+    using vector_type = my_vector<T, Allocator, GrowthPolicy>;
+    using snapshot_type = my_snapshot<T, Allocator, GrowthPolicy>;
+
+private:
+    std::shared_ptr<vector_type> data_;
+
+public:
+    my_snapshot_builder() : data_(std::make_shared<vector_type>()) {}
+
+    explicit my_snapshot_builder(vector_type&& vector) : data_(std::make_shared<vector_type>(std::move(vector))) {}
+
+    // starts from the version in snapshot, copied on the first edit
+    explicit my_snapshot_builder(const snapshot_type& snapshot)
+        : data_(snapshot.data_ ? std::const_pointer_cast<vector_type>(snapshot.data_)
+                               : std::make_shared<vector_type>()) {}
+
+    const vector_type& view() const noexcept { return *data_; }
+
+    // true when edit() has to copy
+    bool is_shared() const noexcept { return data_.use_count() != 1; }
+
+    // the vector to modify, copied first if a snapshot still refers to it
+    vector_type& edit() {
+        if (is_shared()) {
+            data_ = std::make_shared<vector_type>(std::as_const(*data_));
+        } else {
+            // the last reader let go with a release decrement of the count
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *data_;
+    }
+
+    snapshot_type snapshot() const noexcept { return snapshot_type(data_); }
+
+    // the vector itself, copied only if it is shared; the builder is left empty
+    vector_type take() {
+        vector_type result = std::move(edit());
+        data_ = std::make_shared<vector_type>();
+        return result;
+    }
+};
+
+// Slot holding the latest snapshot, for one thread to publish versions that
+// many threads acquire, as cheap as std::atomic<std::shared_ptr> on the
+// platform. A reader keeps its version alive while it holds the snapshot.
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = my_growth_double>
+class my_atomic_snapshot {
+public:
+    using snapshot_type = my_snapshot<T, Allocator, GrowthPolicy>;
+
+private:
+    std::atomic<std::shared_ptr<const typename snapshot_type::vector_type>> latest_;
+
+public:
+    my_atomic_snapshot() noexcept = default;
+
+    explicit my_atomic_snapshot(snapshot_type snapshot) noexcept : latest_(std::move(snapshot.data_)) {}
+
+    my_atomic_snapshot(const my_atomic_snapshot&) = delete;
+    my_atomic_snapshot& operator=(const my_atomic_snapshot&) = delete;
+
+    void publish(snapshot_type snapshot) noexcept {
+        latest_.store(std::move(snapshot.data_), std::memory_order_release);
+    }
+
+    snapshot_type acquire() const noexcept {
+        return snapshot_type(latest_.load(std::memory_order_acquire));
+    }
+
+    // publishes snapshot and returns the version it replaced
+    snapshot_type exchange(snapshot_type snapshot) noexcept {
+        return snapshot_type(latest_.exchange(std::move(snapshot.data_), std::memory_order_acq_rel));
+    }
+};
+
+#endif // MY_SNAPSHOT_H
@@ -0,0 +1,549 @@
+#ifndef MY_SOA_VECTOR_H
+#define MY_SOA_VECTOR_H
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "my_growth.h"
+#include "my_vector.h"
+
+// A row of a my_soa_vector as references to its fields; Us are the column
+// types, const for rows of a const vector.
+template <typename... Us>
+class my_soa_row {
+private:
+    template <typename...>
+    friend class my_soa_row;
+
+    std::tuple<Us&...> fields_;
+
+    template <typename Tuple>
+    void assign(Tuple&& values) const {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((std::get<I>(fields_) = std::get<I>(std::forward<Tuple>(values))), ...);
+        }(std::index_sequence_for<Us...>{});
+    }
+
+public:
+    using value_type = std::tuple<std::remove_const_t<Us>...>;
+
+    explicit my_soa_row(Us&... fields) noexcept : fields_(fields...) {}
+
+    my_soa_row(const my_soa_row&) noexcept = default;
+
+    // const rows from mutable ones
+    template <typename... Vs, typename = std::enable_if_t<(std::is_same_v<const Vs, Us> && ...)>>
+    my_soa_row(const my_soa_row<Vs...>& other) noexcept
+        : fields_(other.fields_) {}
+
+    // the assignments write the referenced fields, they never rebind
+    const my_soa_row& operator=(const my_soa_row& other) const {
+        assign(other.fields_);
+        return *this;
+    }
+
+    const my_soa_row& operator=(const value_type& row) const {
+        assign(row);
+        return *this;
+    }
+
+    const my_soa_row& operator=(value_type&& row) const {
+        assign(std::move(row));
+        return *this;
+    }
+
+    operator value_type() const {
+        return value_type(fields_);
+    }
+
+    const std::tuple<Us&...>& fields() const noexcept { return fields_; }
+
+    template <size_t I>
+    auto& get() const noexcept { return std::get<I>(fields_); }
+
+    template <size_t I>
+    friend auto& get(const my_soa_row& row) noexcept { return std::get<I>(row.fields_); }
+
+    friend void swap(const my_soa_row& lhs, const my_soa_row& rhs) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            using std::swap;
+            (swap(std::get<I>(lhs.fields_), std::get<I>(rhs.fields_)), ...);
+        }(std::index_sequence_for<Us...>{});
+    }
+
+    friend bool operator==(const my_soa_row& lhs, const my_soa_row& rhs) {
+        return lhs.fields_ == rhs.fields_;
+    }
+
+    friend bool operator==(const my_soa_row& lhs, const value_type& rhs) {
+        return lhs.fields_ == rhs;
+    }
+
+    friend auto operator<=>(const my_soa_row& lhs, const my_soa_row& rhs) {
+        return lhs.fields_ <=> rhs.fields_;
+    }
+
+    friend auto operator<=>(const my_soa_row& lhs, const value_type& rhs) {
+        return lhs.fields_ <=> rhs;
+    }
+};
+
+// Random-access iterator over the rows of a my_soa_vector, yielding my_soa_row proxies.
+template <typename... Us>
+class my_soa_iterator {
+private:
+    template <typename, typename...>
+    friend class my_basic_soa_vector;
+
+    std::tuple<Us*...> columns_{};
+    std::ptrdiff_t index_ = 0;
+
+    my_soa_iterator(const std::tuple<Us*...>& columns, std::ptrdiff_t index) noexcept
+        : columns_(columns), index_(index) {}
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::tuple<std::remove_const_t<Us>...>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = my_soa_row<Us...>;
+
+    my_soa_iterator() noexcept = default;
+
+    // const_iterator from iterator
+    template <typename... Vs, typename = std::enable_if_t<(std::is_same_v<const Vs, Us> && ...)>>
+    my_soa_iterator(const my_soa_iterator<Vs...>& other) noexcept
+        : columns_(other.columns_), index_(other.index_) {}
+
+    reference operator*() const noexcept {
+        return std::apply([this](Us*... columns) { return reference(columns[index_]...); }, columns_);
+    }
+
+    reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+    my_soa_iterator& operator++() noexcept { ++index_; return *this; }
+    my_soa_iterator operator++(int) noexcept { my_soa_iterator old = *this; ++index_; return old; }
+    my_soa_iterator& operator--() noexcept { --index_; return *this; }
+    my_soa_iterator operator--(int) noexcept { my_soa_iterator old = *this; --index_; return old; }
+
+    my_soa_iterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+    my_soa_iterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+
+    friend my_soa_iterator operator+(my_soa_iterator it, difference_type n) noexcept { return it += n; }
+    friend my_soa_iterator operator+(difference_type n, my_soa_iterator it) noexcept { return it += n; }
+    friend my_soa_iterator operator-(my_soa_iterator it, difference_type n) noexcept { return it -= n; }
+
+    friend difference_type operator-(const my_soa_iterator& lhs, const my_soa_iterator& rhs) noexcept {
+        return lhs.index_ - rhs.index_;
+    }
+
+    friend bool operator==(const my_soa_iterator& lhs, const my_soa_iterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend std::strong_ordering operator<=>(const my_soa_iterator& lhs, const my_soa_iterator& rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+    template <typename...>
+    friend class my_soa_iterator;
+};
+
+// Vector of rows stored as one array per field (structure of arrays): a scan
+// over one field reads only that field's bytes. All columns share one size
+// and one capacity, which grows by GrowthPolicy like my_vector with the whole
+// row as the element size.
+//
+// Rows are std::tuple<Ts...> values; operator[] and the iterators yield a
+// proxy holding a reference to every field of a row. Assigning to the proxy
+// writes the fields, swapping two proxies swaps the rows, so std::sort and
+// the other std algorithms can rearrange the rows. Moving through a proxy
+// copies, as a proxy cannot tell std::move(*it) from *it.
+template <typename GrowthPolicy, typename... Ts>
+class my_basic_soa_vector {
+private:
+    static_assert(sizeof...(Ts) > 0, "my_soa_vector: at least one column is needed");
+    static_assert((std::is_object_v<Ts> && ...) && (!std::is_const_v<Ts> && ...),
+                  "my_soa_vector: columns must be non-const object types");
+
+    template <size_t I>
+    using column_t = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    static constexpr size_t row_bytes = (sizeof(Ts) + ...);
+
+    // a throwing move could leave some columns moved and others not, so the
+    // columns are copied on reallocation unless every one moves without throwing
+    static constexpr bool nothrow_move = (std::is_nothrow_move_constructible_v<Ts> && ...);
+
+    std::tuple<Ts*...> columns_{};
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+
+    // calls f(std::integral_constant<size_t, I>{}) for every column I
+    template <typename F>
+    static void for_each_column(F&& f) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (f(std::integral_constant<size_t, I>{}), ...);
+        }(std::index_sequence_for<Ts...>{});
+    }
+
+    static void deallocate(std::tuple<Ts*...>& columns, size_t count) noexcept {
+        for_each_column([&](auto i) {
+            using T = column_t<i>;
+            if (T*& ptr = std::get<i>(columns)) {
+                std::allocator<T>().deallocate(ptr, count);
+                ptr = nullptr;
+            }
+        });
+    }
+
+    template <size_t I>
+    static void destroy(column_t<I>* first, size_t count) noexcept {
+        std::destroy_n(first, count);
+    }
+
+    void destroy_rows(size_t first, size_t last) noexcept {
+        for_each_column([&](auto i) {
+            destroy<i>(std::get<i>(columns_) + first, last - first);
+        });
+    }
+
+    // constructs row size_ from the values, one per column; if a column throws,
+    // the fields built so far are destroyed
+    template <typename... Us>
+    void construct_row(Us&&... values) {
+        auto args = std::forward_as_tuple(std::forward<Us>(values)...);
+        size_t done = 0;
+        try {
+            for_each_column([&](auto i) {
+                using U = std::tuple_element_t<i, std::tuple<Us...>>;
+                std::construct_at(std::get<i>(columns_) + size_, std::forward<U>(std::get<i>(args)));
+                ++done;
+            });
+        } catch (...) {
+            for_each_column([&](auto i) {
+                if (i < done) {
+                    std::destroy_at(std::get<i>(columns_) + size_);
+                }
+            });
+            throw;
+        }
+        ++size_;
+    }
+
+    void construct_default_row() {
+        size_t done = 0;
+        try {
+            for_each_column([&](auto i) {
+                std::construct_at(std::get<i>(columns_) + size_);
+                ++done;
+            });
+        } catch (...) {
+            for_each_column([&](auto i) {
+                if (i < done) {
+                    std::destroy_at(std::get<i>(columns_) + size_);
+                }
+            });
+            throw;
+        }
+        ++size_;
+    }
+
+    // moves every column into new arrays of new_cap elements (new_cap >= size_)
+    void reallocate(size_t new_cap) {
+        std::tuple<Ts*...> fresh{};
+        size_t copied = 0;
+        try {
+            for_each_column([&](auto i) {
+                std::get<i>(fresh) = std::allocator<column_t<i>>().allocate(new_cap);
+            });
+            for_each_column([&](auto i) {
+                using T = column_t<i>;
+                T* src = std::get<i>(columns_);
+                T* dst = std::get<i>(fresh);
+                if constexpr (is_trivially_relocatable_v<T>) {
+                    if (size_) {
+                        std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), size_ * sizeof(T));
+                    }
+                } else if constexpr (nothrow_move) {
+                    std::uninitialized_move_n(src, size_, dst);
+                } else {
+                    std::uninitialized_copy_n(src, size_, dst);
+                }
+                ++copied;
+            });
+        } catch (...) {
+            for_each_column([&](auto i) {
+                if (i < copied && !is_trivially_relocatable_v<column_t<i>>) {
+                    destroy<i>(std::get<i>(fresh), size_);
+                }
+            });
+            deallocate(fresh, new_cap);
+            throw;
+        }
+
+        for_each_column([&](auto i) {
+            if constexpr (!is_trivially_relocatable_v<column_t<i>>) {
+                destroy<i>(std::get<i>(columns_), size_);
+            }
+        });
+        deallocate(columns_, capacity_);
+        columns_ = fresh;
+        capacity_ = new_cap;
+    }
+
+    void grow_for(size_t min_capacity) {
+        if (min_capacity > capacity_) {
+            reallocate(GrowthPolicy::next_capacity(capacity_, min_capacity, row_bytes));
+        }
+    }
+
+    void release() noexcept {
+        destroy_rows(0, size_);
+        deallocate(columns_, capacity_);
+        capacity_ = 0;
+        size_ = 0;
+    }
+
+public:
+    using value_type = std::tuple<Ts...>;
+
+    using reference = my_soa_row<Ts...>;
+    using const_reference = my_soa_row<const Ts...>;
+
+    using iterator = my_soa_iterator<Ts...>;
+    using const_iterator = my_soa_iterator<const Ts...>;
+
+    my_basic_soa_vector() noexcept = default;
+
+    explicit my_basic_soa_vector(size_t count) : my_basic_soa_vector() {
+        resize(count);
+    }
+
+    my_basic_soa_vector(std::initializer_list<value_type> rows) : my_basic_soa_vector() {
+        reserve(rows.size());
+        for (const value_type& row : rows) {
+            push_back(row);
+        }
+    }
+
+    my_basic_soa_vector(const my_basic_soa_vector& other) : my_basic_soa_vector() {
+        reserve(other.size_);
+        for (size_t i = 0; i < other.size_; ++i) {
+            std::apply([this](const Ts&... fields) { construct_row(fields...); }, other[i].fields());
+        }
+    }
+
+    my_basic_soa_vector(my_basic_soa_vector&& other) noexcept
+        : columns_(std::exchange(other.columns_, {})),
+          capacity_(std::exchange(other.capacity_, 0)),
+          size_(std::exchange(other.size_, 0)) {}
+
+    ~my_basic_soa_vector() {
+        release();
+    }
+
+    my_basic_soa_vector& operator=(const my_basic_soa_vector& other) {
+        if (this != &other) {
+            my_basic_soa_vector temp(other);
+            swap(temp);
+        }
+        return *this;
+    }
+
+    my_basic_soa_vector& operator=(my_basic_soa_vector&& other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    reference operator[](size_t idx) noexcept { return *(begin() + idx); }
+    const_reference operator[](size_t idx) const noexcept { return *(begin() + idx); }
+
+    reference at(size_t idx) {
+        if (idx >= size_) {
+            throw std::out_of_range("my_soa_vector::at: index out of range");
+        }
+        return (*this)[idx];
+    }
+
+    const_reference at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("my_soa_vector::at: index out of range");
+        }
+        return (*this)[idx];
+    }
+
+    reference front() { return (*this)[0]; }
+    const_reference front() const { return (*this)[0]; }
+
+    reference back() { return (*this)[size_ - 1]; }
+    const_reference back() const { return (*this)[size_ - 1]; }
+
+    // the contiguous array of field I
+    template <size_t I>
+    std::span<column_t<I>> column() noexcept {
+        return {std::get<I>(columns_), size_};
+    }
+
+    template <size_t I>
+    std::span<const column_t<I>> column() const noexcept {
+        return {std::get<I>(columns_), size_};
+    }
+
+    iterator begin() noexcept { return iterator(columns_, 0); }
+    const_iterator begin() const noexcept { return const_iterator(columns_, 0); }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return begin() + size_; }
+    const_iterator end() const noexcept { return begin() + size_; }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool is_empty() const noexcept { return size_ == 0; }
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return capacity_; }
+
+    void reserve(size_t new_cap) {
+        if (new_cap > capacity_) {
+            reallocate(new_cap);
+        }
+    }
+
+    void shrink_to_fit() {
+        if (size_ == 0) {
+            release();
+        } else if (size_ < capacity_) {
+            reallocate(size_);
+        }
+    }
+
+    void clear() noexcept {
+        destroy_rows(0, size_);
+        size_ = 0;
+    }
+
+    void resize(size_t count) {
+        if (count < size_) {
+            destroy_rows(count, size_);
+            size_ = count;
+            return;
+        }
+
+        reserve(count);
+        const size_t old_size = size_;
+        try {
+            while (size_ < count) {
+                construct_default_row();
+            }
+        } catch (...) {
+            destroy_rows(old_size, size_);
+            size_ = old_size;
+            throw;
+        }
+    }
+
+    // one value per column
+    template <typename... Us>
+        requires(sizeof...(Us) == sizeof...(Ts))
+    reference emplace_back(Us&&... values) {
+        if (size_ == capacity_) {
+            // the values may refer into the columns about to move
+            value_type row(std::forward<Us>(values)...);
+            grow_for(size_ + 1);
+            std::apply([this](Ts&... fields) { construct_row(std::move(fields)...); }, row);
+        } else {
+            construct_row(std::forward<Us>(values)...);
+        }
+        return back();
+    }
+
+    void push_back(const value_type& row) {
+        std::apply([this](const Ts&... fields) { emplace_back(fields...); }, row);
+    }
+
+    void push_back(value_type&& row) {
+        std::apply([this](Ts&... fields) { emplace_back(std::move(fields)...); }, row);
+    }
+
+    void pop_back() {
+        if (size_ > 0) {
+            --size_;
+            destroy_rows(size_, size_ + 1);
+        }
+    }
+
+    iterator erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        const size_t start_index = first - cbegin();
+        const size_t end_index = last - cbegin();
+
+        if (start_index > size_ || end_index > size_ || start_index > end_index) {
+            throw std::out_of_range("my_soa_vector::erase: iterator out of range");
+        }
+
+        if (start_index != end_index) {
+            for_each_column([&](auto i) {
+                auto* data = std::get<i>(columns_);
+                std::move(data + end_index, data + size_, data + start_index);
+            });
+            destroy_rows(size_ - (end_index - start_index), size_);
+            size_ -= end_index - start_index;
+        }
+        return begin() + start_index;
+    }
+
+    void swap(my_basic_soa_vector& other) noexcept {
+        std::swap(columns_, other.columns_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+    }
+
+    bool operator==(const my_basic_soa_vector& other) const {
+        if (size_ != other.size_) {
+            return false;
+        }
+        bool equal = true;
+        for_each_column([&](auto i) {
+            equal = equal && std::equal(column<i>().begin(), column<i>().end(), other.template column<i>().begin());
+        });
+        return equal;
+    }
+
+    bool operator!=(const my_basic_soa_vector& other) const {
+        return !(*this == other);
+    }
+};
+
+template <typename GrowthPolicy, typename... Ts>
+void swap(my_basic_soa_vector<GrowthPolicy, Ts...>& lhs, my_basic_soa_vector<GrowthPolicy, Ts...>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template <typename... Ts>
+using my_soa_vector = my_basic_soa_vector<my_growth_double, Ts...>;
+
+// structured bindings for rows: auto [id, price] = soa[i];
+template <typename... Us>
+struct std::tuple_size<my_soa_row<Us...>> : std::integral_constant<size_t, sizeof...(Us)> {};
+
+template <size_t I, typename... Us>
+struct std::tuple_element<I, my_soa_row<Us...>> {
+    using type = std::tuple_element_t<I, std::tuple<Us...>>&;
+};
+
+#endif // MY_SOA_VECTOR_H
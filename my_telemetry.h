@@ -0,0 +1,305 @@
+#ifndef MY_TELEMETRY_H
+#define MY_TELEMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef MY_VECTOR_TELEMETRY
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#endif
+
+// Allocation and relocation counters for my_vector, per element type.
+// Compiled in only when MY_VECTOR_TELEMETRY is defined, for the whole
+// program: every translation unit has to agree, since my_vector's inline
+// functions differ. Without it the hooks are discarded by if constexpr and
+// this header defines nothing but empty stand-ins for them.
+//
+// Reading the numbers: my_telemetry::registry::instance().for_each(f) or
+// write_json(out) on demand, dump_at_exit(path) or the MY_VECTOR_TELEMETRY_JSON
+// environment variable for a JSON file at exit, and set_hook(h) to be called
+// on every event, e.g. to feed a metrics exporter.
+namespace my_telemetry {
+
+#ifdef MY_VECTOR_TELEMETRY
+inline constexpr bool enabled = true;
+
+// a copy of the counters of one element type
+struct stats {
+    std::string_view type;
+    size_t element_size;
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t reallocations;   // buffer changes that moved the elements
+    uint64_t bytes_allocated;
+    uint64_t bytes_relocated;
+    uint64_t live_bytes;      // capacity currently allocated
+    uint64_t peak_live_bytes;
+    uint64_t peak_capacity;   // largest capacity of a single vector, in elements
+    uint64_t wasted_bytes;    // capacity never filled, summed over released buffers
+    uint64_t reallocation_ns; // time spent in reallocations, allocating and moving included
+};
+
+class counters {
+private:
+    friend class registry;
+
+    std::string_view type_;
+    size_t element_size_;
+
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> deallocations_{0};
+    std::atomic<uint64_t> reallocations_{0};
+    std::atomic<uint64_t> bytes_allocated_{0};
+    std::atomic<uint64_t> bytes_relocated_{0};
+    std::atomic<uint64_t> live_bytes_{0};
+    std::atomic<uint64_t> peak_live_bytes_{0};
+    std::atomic<uint64_t> peak_capacity_{0};
+    std::atomic<uint64_t> wasted_bytes_{0};
+    std::atomic<uint64_t> reallocation_ns_{0};
+
+    static void raise(std::atomic<uint64_t>& peak, uint64_t value) noexcept {
+        uint64_t current = peak.load(std::memory_order_relaxed);
+        while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+public:
+    counters(std::string_view type, size_t element_size) noexcept : type_(type), element_size_(element_size) {}
+
+    std::string_view type() const noexcept { return type_; }
+    size_t element_size() const noexcept { return element_size_; }
+
+    stats snapshot() const noexcept {
+        auto get = [](const std::atomic<uint64_t>& value) { return value.load(std::memory_order_relaxed); };
+        return {type_,
+                element_size_,
+                get(allocations_),
+                get(deallocations_),
+                get(reallocations_),
+                get(bytes_allocated_),
+                get(bytes_relocated_),
+                get(live_bytes_),
+                get(peak_live_bytes_),
+                get(peak_capacity_),
+                get(wasted_bytes_),
+                get(reallocation_ns_)};
+    }
+
+    void record_allocate(size_t capacity) noexcept;
+    void record_deallocate(size_t capacity, size_t size) noexcept;
+    void record_relocate(size_t count, uint64_t ns) noexcept;
+};
+
+enum class event { allocate, deallocate, relocate };
+
+// Called on the thread that caused the event, after the counters were
+// updated; bytes is the size of the buffer, or of the elements relocated.
+// on_event must not grow a my_vector of the same element type, and cannot
+// throw: it runs inside my_vector's noexcept deallocation paths.
+class hook {
+public:
+    virtual ~hook() = default;
+    virtual void on_event(event kind, const counters& type, size_t bytes) noexcept = 0;
+};
+
+// Process-wide list of the counters of every element type seen so far. It is
+// never destroyed, vectors with static storage may still use it at exit.
+class registry {
+private:
+    mutable std::mutex mutex_;
+    std::deque<counters> counters_;
+    std::atomic<hook*> hook_{nullptr};
+    std::string dump_path_;
+
+    registry() {
+        if (const char* path = std::getenv("MY_VECTOR_TELEMETRY_JSON")) {
+            dump_at_exit(path);
+        }
+    }
+
+    static void write_string(std::ostream& out, std::string_view text) {
+        out << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+
+public:
+    registry(const registry&) = delete;
+    registry& operator=(const registry&) = delete;
+
+    static registry& instance() {
+        static registry* const global = new registry;
+        return *global;
+    }
+
+    counters& add(std::string_view type, size_t element_size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return counters_.emplace_back(type, element_size);
+    }
+
+    // f(const stats&) for every element type
+    template <typename F>
+    void for_each(F&& f) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const counters& type : counters_) {
+            f(type.snapshot());
+        }
+    }
+
+    // h must outlive its registration; nullptr removes it
+    void set_hook(hook* h) noexcept { hook_.store(h, std::memory_order_release); }
+
+    void notify(event kind, const counters& type, size_t bytes) const noexcept {
+        if (hook* h = hook_.load(std::memory_order_acquire)) {
+            h->on_event(kind, type, bytes);
+        }
+    }
+
+    void write_json(std::ostream& out) const {
+        out << "{\"types\": [";
+        bool first = true;
+        for_each([&](const stats& s) {
+            out << (first ? "\n" : ",\n") << "  {\"type\": ";
+            first = false;
+            write_string(out, s.type);
+            out << ", \"element_size\": " << s.element_size
+                << ", \"allocations\": " << s.allocations
+                << ", \"deallocations\": " << s.deallocations
+                << ", \"reallocations\": " << s.reallocations
+                << ", \"bytes_allocated\": " << s.bytes_allocated
+                << ", \"bytes_relocated\": " << s.bytes_relocated
+                << ", \"live_bytes\": " << s.live_bytes
+                << ", \"peak_live_bytes\": " << s.peak_live_bytes
+                << ", \"peak_capacity\": " << s.peak_capacity
+                << ", \"wasted_bytes\": " << s.wasted_bytes
+                << ", \"reallocation_ns\": " << s.reallocation_ns << "}";
+        });
+        out << "\n]}\n";
+    }
+
+    // writes the JSON to path when the program exits normally
+    void dump_at_exit(std::string path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const bool registered = !dump_path_.empty();
+        dump_path_ = std::move(path);
+        if (!registered) {
+            std::atexit([] {
+                registry& self = instance();
+                std::string path;
+                {
+                    std::lock_guard<std::mutex> lock(self.mutex_);
+                    path = self.dump_path_;
+                }
+                std::ofstream out(path);
+                if (out) {
+                    self.write_json(out);
+                } else {
+                    std::cerr << "my_telemetry: cannot write " << path << "\n";
+                }
+            });
+        }
+    }
+};
+
+inline void counters::record_allocate(size_t capacity) noexcept {
+    const uint64_t bytes = uint64_t(capacity) * element_size_;
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    raise(peak_live_bytes_, live_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    raise(peak_capacity_, capacity);
+    registry::instance().notify(event::allocate, *this, bytes);
+}
+
+inline void counters::record_deallocate(size_t capacity, size_t size) noexcept {
+    const uint64_t bytes = uint64_t(capacity) * element_size_;
+    deallocations_.fetch_add(1, std::memory_order_relaxed);
+    live_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    wasted_bytes_.fetch_add(uint64_t(capacity - size) * element_size_, std::memory_order_relaxed);
+    registry::instance().notify(event::deallocate, *this, bytes);
+}
+
+inline void counters::record_relocate(size_t count, uint64_t ns) noexcept {
+    const uint64_t bytes = uint64_t(count) * element_size_;
+    reallocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_relocated_.fetch_add(bytes, std::memory_order_relaxed);
+    reallocation_ns_.fetch_add(ns, std::memory_order_relaxed);
+    registry::instance().notify(event::relocate, *this, bytes);
+}
+
+// the type as the compiler spells it, e.g. "std::__cxx11::basic_string<char>"
+template <typename T>
+constexpr std::string_view type_name() noexcept {
+#if defined(__clang__) || defined(__GNUC__)
+    constexpr std::string_view function = __PRETTY_FUNCTION__;
+    constexpr std::string_view marker = "T = ";
+    constexpr size_t first = function.find(marker) + marker.size();
+    constexpr size_t last = function.find_first_of(";]", first);
+    return function.substr(first, last - first);
+#else
+    return typeid(T).name();
+#endif
+}
+
+template <typename T>
+counters& counters_for() {
+    static counters& type = registry::instance().add(type_name<T>(), sizeof(T));
+    return type;
+}
+
+// the time since construction, not measured in constant evaluation
+class stopwatch {
+private:
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    constexpr stopwatch() noexcept {
+        if (!std::is_constant_evaluated()) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    uint64_t elapsed_ns() const noexcept {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    }
+};
+
+#else
+inline constexpr bool enabled = false;
+
+// what my_vector names in the code if constexpr discards
+class counters {
+public:
+    void record_allocate(size_t) noexcept {}
+    void record_deallocate(size_t, size_t) noexcept {}
+    void record_relocate(size_t, uint64_t) noexcept {}
+};
+
+template <typename T>
+counters& counters_for() noexcept {
+    static counters type;
+    return type;
+}
+
+class stopwatch {
+public:
+    constexpr stopwatch() noexcept = default;
+    constexpr uint64_t elapsed_ns() const noexcept { return 0; }
+};
+#endif
+
+} // namespace my_telemetry
+
+#endif // MY_TELEMETRY_H
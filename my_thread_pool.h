@@ -0,0 +1,245 @@
+#ifndef MY_THREAD_POOL_H
+#define MY_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: tasks it submits go
+// to the back and it takes them from the back again, while idle workers
+// steal the oldest tasks from the front of the other deques. Threads outside
+// the pool submit to one shared deque.
+//
+// A thread waiting for tasks (my_task_group::wait) runs queued tasks itself
+// instead of blocking, so nested parallelism cannot deadlock and the waiting
+// thread adds to the worker count: a pool of hardware_concurrency() - 1
+// workers keeps every core busy.
+class my_thread_pool {
+public:
+    using task = std::function<void()>;
+
+private:
+    struct task_queue {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    static inline thread_local const my_thread_pool* current_pool_ = nullptr;
+    static inline thread_local size_t current_index_ = 0;
+
+    size_t size_;
+    std::unique_ptr<task_queue[]> queues_; // one per worker, the last one for other threads
+    std::vector<std::thread> threads_;
+
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+
+    size_t own_queue() const noexcept {
+        return current_pool_ == this ? current_index_ : size_;
+    }
+
+    bool pop_back(task_queue& queue, task& out) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        out = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool pop_front(task_queue& queue, task& out) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        out = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    bool take(task& out) {
+        if (queued_.load(std::memory_order_acquire) == 0) return false;
+
+        const size_t own = own_queue();
+        if (pop_back(queues_[own], out)) return true;
+
+        for (size_t i = 1; i <= size_; ++i) {
+            if (pop_front(queues_[(own + i) % (size_ + 1)], out)) return true;
+        }
+        return false;
+    }
+
+    void worker_loop(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+
+        while (true) {
+            if (run_one()) continue;
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleeping_.fetch_add(1);
+            wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+            sleeping_.fetch_sub(1);
+            if (stop_ && queued_.load() == 0) return;
+        }
+    }
+
+    void shutdown() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+
+        // tasks left in the shared queue when there are no workers
+        while (run_one()) {}
+    }
+
+public:
+    // one worker per core but the one the submitting thread runs on
+    static size_t default_size() noexcept {
+        return std::max(std::thread::hardware_concurrency(), 1u) - 1;
+    }
+
+    explicit my_thread_pool(size_t size = default_size()) : size_(size), queues_(new task_queue[size + 1]) {
+        threads_.reserve(size_);
+        try {
+            for (size_t i = 0; i < size_; ++i) {
+                threads_.emplace_back([this, i] { worker_loop(i); });
+            }
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+
+    my_thread_pool(const my_thread_pool&) = delete;
+    my_thread_pool& operator=(const my_thread_pool&) = delete;
+
+    // runs the tasks still queued, then joins the workers
+    ~my_thread_pool() {
+        shutdown();
+    }
+
+    // the pool shared by my_parallel::for_chunks, for_each, transform, reduce and sort
+    static my_thread_pool& global() {
+        static my_thread_pool pool;
+        return pool;
+    }
+
+    // number of worker threads
+    size_t size() const noexcept { return size_; }
+
+    // threads that run tasks while one of them waits: the workers plus the waiter
+    size_t concurrency() const noexcept { return size_ + 1; }
+
+    // t must not throw, use my_task_group to get exceptions back
+    void submit(task t) {
+        // counted first, so that queued_ never drops below the tasks in the queues
+        queued_.fetch_add(1);
+        try {
+            task_queue& queue = queues_[own_queue()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(t));
+        } catch (...) {
+            queued_.fetch_sub(1);
+            throw;
+        }
+
+        // pairs with the sleeping_ increment in worker_loop: either the
+        // worker sees the task or the submitter sees the sleeper
+        if (sleeping_.load() > 0) {
+            { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+            wake_.notify_one();
+        }
+    }
+
+    // runs one queued task on the calling thread; returns false if there was none
+    bool run_one() {
+        task t;
+        if (!take(t)) return false;
+
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        t();
+        return true;
+    }
+};
+
+// Fork-join over a my_thread_pool: run() queues a task, wait() returns once
+// every task of the group finished, running queued tasks meanwhile. The
+// first exception thrown by a task is rethrown from wait().
+class my_task_group {
+private:
+    my_thread_pool& pool_;
+    std::atomic<size_t> pending_{0};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+
+    void wait_for_tasks() noexcept {
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            if (!pool_.run_one()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    explicit my_task_group(my_thread_pool& pool = my_thread_pool::global()) noexcept : pool_(pool) {}
+
+    my_task_group(const my_task_group&) = delete;
+    my_task_group& operator=(const my_task_group&) = delete;
+
+    // tasks reference the group, it must outlive them
+    ~my_task_group() {
+        wait_for_tasks();
+    }
+
+    my_thread_pool& pool() const noexcept { return pool_; }
+
+    template <typename F>
+    void run(F&& f) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            pool_.submit([this, f = std::forward<F>(f)]() mutable {
+                try {
+                    f();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex_);
+                    if (!error_) error_ = std::current_exception();
+                }
+                pending_.fetch_sub(1, std::memory_order_release);
+            });
+        } catch (...) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+    void wait() {
+        wait_for_tasks();
+
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            error = std::exchange(error_, nullptr);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+#endif // MY_THREAD_POOL_H
@@ -2,456 +2,811 @@
 #define MY_VECTOR_H
 
 #include <algorithm>
+#include <concepts>
 #include <cstddef>
+#include <functional>
+#include <cstring>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <ranges>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
 
+#include "my_growth.h"
+#include "my_simd.h"
+#include "my_telemetry.h"
+
+// Customization point: a type is trivially relocatable when moving it to a new
+// address and ending the lifetime of the source is equivalent to copying its
+// bytes. Specialize to std::true_type for own types that qualify, e.g. ones
+// holding a std::unique_ptr or a pointer to heap storage.
+template <typename T>
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>> {};
+
 template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Tag for the constructor of my_vector that default-initializes the elements,
+// like std::make_unique_for_overwrite: trivial types are left uninitialized,
+// for buffers that are written right afterwards.
+struct my_for_overwrite_t {
+    explicit my_for_overwrite_t() = default;
+};
+
+inline constexpr my_for_overwrite_t my_for_overwrite{};
+
+namespace my_parallel::detail {
+struct vector_access;
+}
+
+// Allocators may additionally provide
+//   allocate_at_least(n) -> {ptr, count}, count >= n, to report usable slack,
+//   reallocate(ptr, old_n, new_n) -> {ptr, count} to resize a block in place
+//     (used only for trivially relocatable T), see my_malloc_allocator, and
+//   release_unused(ptr, used_n, n) to hand the memory past the first used_n
+//     elements back to the OS, see my_mmap_allocator.
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = my_growth_double>
 class my_vector {
 private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static constexpr bool has_allocate_at_least = requires(Allocator& alloc, size_t count) {
+        { alloc.allocate_at_least(count).ptr } -> std::convertible_to<T*>;
+    };
+
+    static constexpr bool can_reallocate = is_trivially_relocatable_v<T> &&
+        requires(Allocator& alloc, T* ptr, size_t count) {
+            { alloc.reallocate(ptr, count, count).ptr } -> std::convertible_to<T*>;
+        };
+
+    static constexpr bool has_release_unused = requires(Allocator& alloc, T* ptr, size_t count) {
+        alloc.release_unused(ptr, count, count);
+    };
+
+    struct allocation {
+        T* ptr;
+        size_t count;
+    };
+
+    // uninitialized room for one element, to build it aside
+    union spare {
+        T value;
+        constexpr spare() noexcept {}
+        constexpr ~spare() {}
+    };
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "my_vector: Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T*>,
+                  "my_vector: allocators with fancy pointers are not supported");
+
     T* data_;
     size_t capacity_;
     size_t size_;
+    [[no_unique_address]] Allocator alloc_;
 
-    size_t calc_cap(size_t new_min_capacity) const {
-        const size_t new_capacity = capacity_ ? capacity_ * 2 : 1;
-        return std::max(new_capacity, new_min_capacity);
+    constexpr size_t calc_cap(size_t new_min_capacity) const {
+        return GrowthPolicy::next_capacity(capacity_, new_min_capacity, sizeof(T));
     }
 
-public:
+    // calls f(counters) for the telemetry of T; compiled out unless
+    // MY_VECTOR_TELEMETRY is defined, skipped in constant evaluation
+    template <typename F>
+    static constexpr void report(F&& f) {
+        if constexpr (my_telemetry::enabled) {
+            if (!std::is_constant_evaluated()) {
+                f(my_telemetry::counters_for<T>());
+            }
+        }
+    }
 
-    my_vector() noexcept : data_(nullptr), capacity_(0), size_(0) {}
+    constexpr allocation allocate(size_t count) {
+        if (count == 0) {
+            return {nullptr, 0};
+        }
+        allocation block;
+        if constexpr (has_allocate_at_least) {
+            auto result = alloc_.allocate_at_least(count);
+            block = {result.ptr, static_cast<size_t>(result.count)};
+        } else {
+            block = {alloc_traits::allocate(alloc_, count), count};
+        }
+        report([&](my_telemetry::counters& stats) { stats.record_allocate(block.count); });
+        return block;
+    }
 
-    explicit my_vector(size_t count, const T& value = T()) : data_(nullptr), capacity_(count), size_(count) {
-        if (count > 0) {
-            data_ = new T[count];
-            try {
-                for (size_t i = 0; i < count; ++i) {
-                    data_[i] = value;
+    constexpr bool points_into(const T* ptr) const noexcept {
+        return std::less_equal<const T*>()(data_, ptr) && std::less<const T*>()(ptr, data_ + size_);
+    }
+
+    // points_into that also works in constant evaluation, where unrelated
+    // pointers can only be compared for equality
+    constexpr bool contains(const T* ptr) const noexcept {
+        if (std::is_constant_evaluated()) {
+            for (size_t i = 0; i < size_; ++i) {
+                if (data_ + i == ptr) {
+                    return true;
                 }
-            } catch (...) {
-                delete[] data_;
-                data_ = nullptr;
-                capacity_ = 0;
-                size_ = 0;
-                throw;
             }
+            return false;
         }
+        return points_into(ptr);
     }
 
-    template <typename InputIt,
-              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
-    my_vector(InputIt first, InputIt last) : data_(nullptr), capacity_(0), size_(0) {
-        size_t count = 0;
-        for (auto it = first; it != last; ++it) {
-            ++count;
+    // used is the number of elements the block held, for the telemetry
+    constexpr void deallocate(T* ptr, size_t count, size_t used) noexcept {
+        if (ptr) {
+            report([&](my_telemetry::counters& stats) { stats.record_deallocate(count, used); });
+            alloc_traits::deallocate(alloc_, ptr, count);
+        }
+    }
+
+    constexpr void destroy(T* first, T* last) noexcept {
+        for (; first != last; ++first) {
+            alloc_traits::destroy(alloc_, first);
         }
+    }
 
-        if (count > 0) {
-            data_ = new T[count];
-            capacity_ = count;
+    // constructs count objects in raw storage at dst, one make(ptr) call per slot;
+    // if a construction throws, the already constructed prefix is destroyed
+    template <typename Construct>
+    constexpr void construct_n(T* dst, size_t count, Construct&& make) {
+        size_t i = 0;
+        try {
+            for (; i < count; ++i) {
+                make(dst + i);
+            }
+        } catch (...) {
+            destroy(dst, dst + i);
+            throw;
+        }
+    }
 
-            try {
-                auto it = first;
-                for (size_t i = 0; it != last; ++i, ++it) {
-                    data_[i] = *it;
-                    ++size_;
+    // Default-initializes the element at ptr, leaving a trivial T
+    // uninitialized; the allocator's construct would value-initialize it.
+    // Any other T goes through the allocator, so that e.g. a pmr allocator
+    // still reaches the element. Constant evaluation has no uninitialized
+    // objects and value-initializes.
+    constexpr void construct_default(T* ptr) {
+        if constexpr (std::is_trivially_default_constructible_v<T>) {
+            if (!std::is_constant_evaluated()) {
+                ::new (static_cast<void*>(ptr)) T;
+                return;
+            }
+        }
+        alloc_traits::construct(alloc_, ptr);
+    }
+
+    // bitwise moves count live objects to dst, the source slots become raw storage;
+    // the ranges may overlap. Constant evaluation has no memmove and moves the
+    // objects one by one.
+    static constexpr void relocate_bytes(T* src, size_t count, T* dst) noexcept {
+        if (std::is_constant_evaluated()) {
+            // pointers into different blocks cannot be ordered here, only compared
+            bool dst_inside = false;
+            for (size_t i = 1; i < count; ++i) {
+                dst_inside = dst_inside || dst == src + i;
+            }
+            if (!dst_inside) {
+                for (size_t i = 0; i < count; ++i) {
+                    std::construct_at(dst + i, std::move(src[i]));
+                    std::destroy_at(src + i);
                 }
-            } catch (...) {
-                for (size_t i = 0; i < size_; ++i) {
-                    data_[i].~T();
+            } else {
+                for (size_t i = count; i-- > 0;) {
+                    std::construct_at(dst + i, std::move(src[i]));
+                    std::destroy_at(src + i);
                 }
-                delete[] data_;
-                data_ = nullptr;
-                size_ = 0;
-                capacity_ = 0;
-                throw;
             }
+        } else if (count) {
+            std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
         }
     }
 
-    my_vector(std::initializer_list<T> ilist) : data_(nullptr), capacity_(ilist.size()), size_(0) {
-        if (ilist.size() > 0) {
-            data_ = new T[capacity_];
+    // moves (or copies, if the move may throw) count live objects into raw storage at dst
+    constexpr void move_construct_n(T* src, size_t count, T* dst) {
+        construct_n(dst, count, [&](T* ptr) {
+            alloc_traits::construct(alloc_, ptr, std::move_if_noexcept(*src++));
+        });
+    }
+
+    // moves the contents into a fresh buffer of new_cap slots, leaving a gap of
+    // count slots at index that is filled by make. New elements are built first,
+    // so arguments referring into the old buffer stay valid, and the old buffer
+    // is released only once everything succeeded.
+    template <typename Construct>
+    constexpr void reallocate_with_gap(size_t new_cap, size_t index, size_t count, Construct&& make) {
+        const my_telemetry::stopwatch watch;
+        const allocation block = allocate(new_cap);
+        T* new_data = block.ptr;
+        new_cap = block.count;
+
+        if constexpr (is_trivially_relocatable_v<T>) {
+            try {
+                construct_n(new_data + index, count, make);
+            } catch (...) {
+                deallocate(new_data, new_cap, 0);
+                throw;
+            }
+
+            relocate_bytes(data_, index, new_data);
+            relocate_bytes(data_ + index, size_ - index, new_data + index + count);
+        } else {
+            T* live_first = new_data + index;
+            T* live_last = live_first;
 
             try {
-                auto it = ilist.begin();
-                for (size_t i = 0; it != ilist.end(); ++i, ++it) {
-                    data_[i] = *it;
-                    ++size_;
-                }
+                construct_n(new_data + index, count, make);
+                live_last += count;
+                move_construct_n(data_, index, new_data);
+                live_first = new_data;
+                move_construct_n(data_ + index, size_ - index, new_data + index + count);
             } catch (...) {
-                for (size_t i = 0; i < size_; ++i) {
-                    data_[i].~T();
-                }
-                delete[] data_;
-                data_ = nullptr;
-                size_ = 0;
-                capacity_ = 0;
+                destroy(live_first, live_last);
+                deallocate(new_data, new_cap, 0);
                 throw;
             }
+
+            destroy(data_, data_ + size_);
         }
+
+        deallocate(data_, capacity_, size_);
+        if (size_) {
+            report([&](my_telemetry::counters& stats) { stats.record_relocate(size_, watch.elapsed_ns()); });
+        }
+        data_ = new_data;
+        capacity_ = new_cap;
+        size_ += count;
     }
 
-    my_vector(const my_vector& other) : data_(nullptr), size_(0), capacity_(other.size_) {
-        if (other.size_ > 0) {
-            data_ = new T[other.size_];
+    // changes the capacity to at least new_cap (new_cap >= size_), letting the
+    // allocator resize the block in place when it supports that
+    constexpr void reallocate(size_t new_cap) {
+        if constexpr (can_reallocate) {
+            if (data_) {
+                const my_telemetry::stopwatch watch;
+                auto result = alloc_.reallocate(data_, capacity_, new_cap);
+                report([&](my_telemetry::counters& stats) {
+                    stats.record_deallocate(capacity_, size_);
+                    stats.record_allocate(static_cast<size_t>(result.count));
+                    stats.record_relocate(size_, watch.elapsed_ns());
+                });
+                data_ = result.ptr;
+                capacity_ = static_cast<size_t>(result.count);
+                return;
+            }
+        }
+        reallocate_with_gap(new_cap, size_, 0, [](T*) {});
+    }
 
-            try {
-                for (size_t i = 0; i < other.size_; ++i) {
-                    data_[i] = other.data_[i];
-                    ++size_;
+    template <typename... Args>
+    constexpr void emplace_at(size_t index, Args&&... args) {
+        if constexpr (can_reallocate) {
+            if (size_ >= capacity_ && index == size_ && data_) {
+                // built aside first, args may refer into the block being resized
+                spare aside;
+                T* value = &aside.value;
+                alloc_traits::construct(alloc_, value, std::forward<Args>(args)...);
+                try {
+                    reallocate(calc_cap(size_ + 1));
+                } catch (...) {
+                    alloc_traits::destroy(alloc_, value);
+                    throw;
                 }
+                relocate_bytes(value, 1, data_ + size_);
+                ++size_;
+                return;
+            }
+        }
+
+        if (size_ >= capacity_) {
+            reallocate_with_gap(calc_cap(size_ + 1), index, 1, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, std::forward<Args>(args)...);
+            });
+        } else if (index == size_) {
+            alloc_traits::construct(alloc_, data_ + size_, std::forward<Args>(args)...);
+            ++size_;
+        } else if constexpr (is_trivially_relocatable_v<T>) {
+            // args may refer to an element that is about to be shifted
+            spare aside;
+            T* value = &aside.value;
+            alloc_traits::construct(alloc_, value, std::forward<Args>(args)...);
+
+            relocate_bytes(data_ + index, size_ - index, data_ + index + 1);
+            relocate_bytes(value, 1, data_ + index);
+            ++size_;
+        } else {
+            // args may refer to an element that is about to be shifted
+            T value(std::forward<Args>(args)...);
+            alloc_traits::construct(alloc_, data_ + size_, std::move(data_[size_ - 1]));
+            ++size_;
+            std::move_backward(data_ + index, data_ + size_ - 2, data_ + size_ - 1);
+            data_[index] = std::move(value);
+        }
+    }
+
+    // inserts count elements read from first before index, growing the storage
+    // at most once
+    template <typename ForwardIt>
+    constexpr void insert_n(size_t index, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        if constexpr (std::contiguous_iterator<ForwardIt>) {
+            // a range over our own elements would be shifted or freed under it
+            if (contains(std::to_address(first))) {
+                const my_vector copy(first, first + count, alloc_);
+                insert_n(index, copy.begin(), count);
+                return;
+            }
+        }
+
+        if (can_reallocate && size_ + count > capacity_ && index == size_) {
+            reallocate(calc_cap(size_ + count));
+        }
+
+        if (size_ + count > capacity_) {
+            reallocate_with_gap(calc_cap(size_ + count), index, count, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, *first);
+                ++first;
+            });
+        } else if constexpr (is_trivially_relocatable_v<T>) {
+            T* gap = data_ + index;
+            const size_t elems_after = size_ - index;
+            relocate_bytes(gap, elems_after, gap + count);
+
+            try {
+                construct_n(gap, count, [&](T* ptr) {
+                    alloc_traits::construct(alloc_, ptr, *first);
+                    ++first;
+                });
             } catch (...) {
-                for (size_t i = 0; i < size_; ++i) {
-                    data_[i].~T();
-                }
-                delete[] data_;
-                data_ = nullptr;
-                size_ = 0;
-                capacity_ = 0;
+                relocate_bytes(gap + count, elems_after, gap);
                 throw;
             }
+
+            size_ += count;
+        } else {
+            T* old_end = end();
+            const size_t elems_after = size_ - index;
+
+            if (elems_after > count) {
+                move_construct_n(old_end - count, count, old_end);
+                size_ += count;
+                std::move_backward(data_ + index, old_end - count, old_end);
+                std::copy_n(first, count, data_ + index);
+            } else {
+                ForwardIt mid = first;
+                std::advance(mid, elems_after);
+                construct_n(old_end, count - elems_after, [&](T* ptr) {
+                    alloc_traits::construct(alloc_, ptr, *mid);
+                    ++mid;
+                });
+                size_ += count - elems_after;
+                move_construct_n(data_ + index, elems_after, end());
+                size_ += elems_after;
+                std::copy_n(first, elems_after, data_ + index);
+            }
+        }
+    }
+
+    // appends the elements one by one and rotates them into place: the only
+    // way for ranges that can be walked once
+    template <typename R>
+    constexpr void insert_single_pass(size_t index, R&& range) {
+        const size_t old_size = size_;
+        if constexpr (std::ranges::sized_range<R>) {
+            const size_t needed = size_ + static_cast<size_t>(std::ranges::size(range));
+            if (needed > capacity_) {
+                reallocate(calc_cap(needed));
+            }
         }
+
+        try {
+            for (auto&& value : range) {
+                emplace_back(std::forward<decltype(value)>(value));
+            }
+        } catch (...) {
+            destroy(data_ + old_size, data_ + size_);
+            size_ = old_size;
+            throw;
+        }
+        std::rotate(data_ + index, data_ + old_size, data_ + size_);
+    }
+
+    // resizes to count, building the new elements with make(ptr)
+    template <typename Construct>
+    constexpr void resize_with(size_t count, Construct&& make) {
+        if (can_reallocate && count > capacity_) {
+            reallocate(count);
+        }
+
+        if (count > capacity_) {
+            reallocate_with_gap(count, size_, count - size_, make);
+        } else if (count > size_) {
+            construct_n(data_ + size_, count - size_, make);
+            size_ = count;
+        } else {
+            destroy(data_ + count, data_ + size_);
+            size_ = count;
+        }
+    }
+
+    constexpr void release() noexcept {
+        destroy(data_, data_ + size_);
+        deallocate(data_, capacity_, size_);
+        data_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
     }
 
-    my_vector(my_vector&& other) noexcept
-        : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+    constexpr void steal(my_vector& other) noexcept {
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        size_ = other.size_;
+
         other.data_ = nullptr;
-        other.size_ = 0;
         other.capacity_ = 0;
+        other.size_ = 0;
+    }
+
+    // Grows by count elements that construct(first, count) builds in the raw
+    // storage at first, on several threads for my_parallel::resize. If
+    // construct throws, it must destroy the elements it built first.
+    template <typename Construct>
+    constexpr void append_constructed(size_t count, Construct&& construct) {
+        reserve(size_ + count);
+        construct(data_ + size_, count);
+        size_ += count;
     }
 
-    ~my_vector() {
-        if (data_) {
-            delete[] data_;
+    // appends the elements of an expression of my_expr.h, counting each one
+    // as soon as it is built so that a throwing T leaves a valid vector
+    template <typename E>
+    constexpr void append_expression(const E& expr) {
+        const size_t count = expr.size();
+        reserve(size_ + count);
+        for (size_t i = 0; i < count; ++i) {
+            alloc_traits::construct(alloc_, data_ + size_, expr[i]);
+            ++size_;
         }
     }
 
-    my_vector& operator=(const my_vector& other) {
+    friend struct my_parallel::detail::vector_access;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    constexpr my_vector() noexcept(noexcept(Allocator())) : my_vector(Allocator()) {}
+
+    constexpr explicit my_vector(const Allocator& alloc) noexcept
+        : data_(nullptr), capacity_(0), size_(0), alloc_(alloc) {}
+
+    constexpr explicit my_vector(size_t count, const Allocator& alloc = Allocator()) : my_vector(alloc) {
+        resize(count);
+    }
+
+    constexpr my_vector(size_t count, const T& value, const Allocator& alloc = Allocator()) : my_vector(alloc) {
+        resize(count, value);
+    }
+
+    // count default-initialized elements, uninitialized if T is trivial
+    constexpr my_vector(size_t count, my_for_overwrite_t, const Allocator& alloc = Allocator()) : my_vector(alloc) {
+        resize_default_init(count);
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    constexpr my_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator()) : my_vector(alloc) {
+        insert(end(), first, last);
+    }
+
+    constexpr my_vector(std::initializer_list<T> ilist, const Allocator& alloc = Allocator()) : my_vector(alloc) {
+        insert(end(), ilist.begin(), ilist.end());
+    }
+
+    // evaluates a lazy element-wise expression of my_expr.h in one pass
+    template <typename E>
+        requires requires { typename E::my_expression_tag; }
+    constexpr my_vector(const E& expr, const Allocator& alloc = Allocator()) : my_vector(alloc) {
+        append_expression(expr);
+    }
+
+    constexpr my_vector(const my_vector& other)
+        : my_vector(other, alloc_traits::select_on_container_copy_construction(other.alloc_)) {}
+
+    constexpr my_vector(const my_vector& other, const Allocator& alloc) : my_vector(alloc) {
+        insert(end(), other.begin(), other.end());
+    }
+
+    constexpr my_vector(my_vector&& other) noexcept
+        : data_(nullptr), capacity_(0), size_(0), alloc_(std::move(other.alloc_)) {
+        steal(other);
+    }
+
+    constexpr my_vector(my_vector&& other, const Allocator& alloc) : my_vector(alloc) {
+        if (alloc_traits::is_always_equal::value || alloc_ == other.alloc_) {
+            steal(other);
+        } else {
+            insert(end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        }
+    }
+
+    constexpr ~my_vector() {
+        release();
+    }
+
+    constexpr my_vector& operator=(const my_vector& other) {
         if (this != &other) {
-            my_vector temp(other);
-            swap(temp);
+            constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+            my_vector temp(other, propagate ? other.alloc_ : alloc_);
+            release();
+            if constexpr (propagate) {
+                alloc_ = temp.alloc_;
+            }
+            steal(temp);
         }
         return *this;
     }
 
-    my_vector& operator=(my_vector&& other) noexcept {
-        if (this != &other) {
+    // Evaluates an expression of my_expr.h in one pass. It may read this
+    // vector: each element is read before it is overwritten. An operand that
+    // is this vector has the expression's size, so when the sizes differ the
+    // old elements are dropped and the new ones built straight from the expression.
+    template <typename E>
+        requires requires { typename E::my_expression_tag; }
+    constexpr my_vector& operator=(const E& expr) {
+        const size_t count = expr.size();
+        if (count == size_) {
+            T* out = data_;
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = expr[i];
+            }
+        } else {
             clear();
-            delete[] data_;
-
-            data_ = other.data_;
-            size_ = other.size_;
-            capacity_ = other.capacity_;
+            append_expression(expr);
+        }
+        return *this;
+    }
 
-            other.data_ = nullptr;
-            other.size_ = 0;
-            other.capacity_ = 0;
+    constexpr my_vector& operator=(my_vector&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this != &other) {
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                release();
+                alloc_ = std::move(other.alloc_);
+                steal(other);
+            } else {
+                // unequal allocators cannot take over each other's storage
+                my_vector temp(std::move(other), alloc_);
+                release();
+                steal(temp);
+            }
         }
         return *this;
     }
 
-    T& operator[](size_t idx) noexcept { return data_[idx]; }
-    const T& operator[](size_t idx) const noexcept { return data_[idx]; }
+    constexpr allocator_type get_allocator() const noexcept { return alloc_; }
 
-    T& at(size_t idx) {
+    constexpr T& operator[](size_t idx) noexcept { return data_[idx]; }
+    constexpr const T& operator[](size_t idx) const noexcept { return data_[idx]; }
+
+    constexpr T& at(size_t idx) {
         if (idx >= size_) {
             throw std::out_of_range("my_vector::at: index out of range");
         }
         return data_[idx];
     }
 
-    const T& at(size_t idx) const {
+    constexpr const T& at(size_t idx) const {
         if (idx >= size_) {
             throw std::out_of_range("my_vector::at: index out of range");
         }
         return data_[idx];
     }
 
-    T& front() { return data_[0]; }
-    const T& front() const { return data_[0]; }
-
-    T& back() { return data_[size_ - 1]; }
-    const T& back() const { return data_[size_ - 1]; }
+    constexpr T& front() { return data_[0]; }
+    constexpr const T& front() const { return data_[0]; }
 
-    T* begin() noexcept { return data_; }
-    const T* begin() const noexcept { return data_; }
-    const T* cbegin() const noexcept { return data_; }
+    constexpr T& back() { return data_[size_ - 1]; }
+    constexpr const T& back() const { return data_[size_ - 1]; }
 
-    T* end() noexcept { return data_ + size_; }
-    const T* end() const noexcept { return data_ + size_; }
-    const T* cend() const noexcept { return data_ + size_; }
+    constexpr T* data() noexcept { return data_; }
+    constexpr const T* data() const noexcept { return data_; }
 
-    std::reverse_iterator<T*> rbegin() noexcept { return std::reverse_iterator<T*>(end()); }
-    std::reverse_iterator<const T*> rbegin() const noexcept { return std::reverse_iterator<const T*>(end()); }
-    std::reverse_iterator<const T*> crbegin() const noexcept { return std::reverse_iterator<const T*>(end()); }
+    constexpr T* begin() noexcept { return data_; }
+    constexpr const T* begin() const noexcept { return data_; }
+    constexpr const T* cbegin() const noexcept { return data_; }
 
-    std::reverse_iterator<T*> rend() noexcept { return std::reverse_iterator<T*>(begin()); }
-    std::reverse_iterator<const T*> rend() const noexcept { return std::reverse_iterator<const T*>(begin()); }
-    std::reverse_iterator<const T*> crend() const noexcept { return std::reverse_iterator<const T*>(begin()); }
+    constexpr T* end() noexcept { return data_ + size_; }
+    constexpr const T* end() const noexcept { return data_ + size_; }
+    constexpr const T* cend() const noexcept { return data_ + size_; }
 
-    bool is_empty() const noexcept { return size_ == 0; }
-    size_t size() const noexcept { return size_; }
-    size_t capacity() const noexcept { return capacity_; }
+    constexpr std::reverse_iterator<T*> rbegin() noexcept { return std::reverse_iterator<T*>(end()); }
+    constexpr std::reverse_iterator<const T*> rbegin() const noexcept { return std::reverse_iterator<const T*>(end()); }
+    constexpr std::reverse_iterator<const T*> crbegin() const noexcept { return std::reverse_iterator<const T*>(end()); }
 
-    void reserve(size_t new_cap) {
-        if (new_cap <= capacity_) return;
+    constexpr std::reverse_iterator<T*> rend() noexcept { return std::reverse_iterator<T*>(begin()); }
+    constexpr std::reverse_iterator<const T*> rend() const noexcept { return std::reverse_iterator<const T*>(begin()); }
+    constexpr std::reverse_iterator<const T*> crend() const noexcept { return std::reverse_iterator<const T*>(begin()); }
 
-        T* new_data = new T[new_cap];
+    constexpr bool is_empty() const noexcept { return size_ == 0; }
+    constexpr size_t size() const noexcept { return size_; }
+    constexpr size_t capacity() const noexcept { return capacity_; }
 
-        try {
-            for (size_t i = 0; i < size_; ++i) {
-                new_data[i] = std::move_if_noexcept(data_[i]);
-            }
-        } catch (...) {
-            delete[] new_data;
-            throw;
-        }
+    constexpr void reserve(size_t new_cap) {
+        if (new_cap <= capacity_) return;
 
-        delete[] data_;
-        data_ = new_data;
-        capacity_ = new_cap;
+        reallocate(new_cap);
     }
 
-    void shrink_to_fit() {
+    constexpr void shrink_to_fit() {
         if (size_ < capacity_) {
             if (size_ == 0) {
-                delete[] data_;
-                data_ = nullptr;
-                capacity_ = 0;
+                release();
             } else {
-                T* new_data = new T[size_];
-
-                try {
-                    for (size_t i = 0; i < size_; ++i) {
-                        new_data[i] = std::move_if_noexcept(data_[i]);
-                    }
-                } catch (...) {
-                    delete[] new_data;
-                    throw;
-                }
-
-                delete[] data_;
-                data_ = new_data;
-                capacity_ = size_;
+                reallocate(size_);
             }
         }
     }
 
-    void clear() noexcept {
-        for (size_t i = 0; i < size_; ++i) {
-            data_[i].~T();
-        }
+    constexpr void clear() noexcept {
+        destroy(data_, data_ + size_);
         size_ = 0;
+        if constexpr (has_release_unused) {
+            alloc_.release_unused(data_, 0, capacity_);
+        }
     }
 
-    void resize(size_t count, const T& value = T()) {
-        if (count > size_) {
-            if (count > capacity_) {
-                reserve(count);
-            }
-
-            for (size_t i = size_; i < count; ++i) {
-                data_[i] = value;
-            }
-        } else if (count < size_) {
-            for (size_t i = count; i < size_; ++i) {
-                data_[i].~T();
-            }
-        }
+    constexpr void resize(size_t count) {
+        resize_with(count, [&](T* ptr) { alloc_traits::construct(alloc_, ptr); });
+    }
 
-        size_ = count;
+    // like resize, but the new elements are default-initialized: a trivial T
+    // is left uninitialized instead of zeroed, and its pages are not touched
+    constexpr void resize_default_init(size_t count) {
+        resize_with(count, [this](T* ptr) { construct_default(ptr); });
     }
 
-    void push_back(const T& value) {
-        if (size_ >= capacity_) {
-            T value_copy = value;
-            reserve(calc_cap(size_ + 1));
-            data_[size_++] = std::move(value_copy);
+    constexpr void resize(size_t count, const T& value) {
+        if (can_reallocate && count > capacity_ && !points_into(&value)) {
+            reallocate(count);
+        }
+
+        if (count > capacity_) {
+            reallocate_with_gap(count, size_, count - size_, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, value);
+            });
+        } else if (count > size_) {
+            construct_n(data_ + size_, count - size_, [&](T* ptr) {
+                alloc_traits::construct(alloc_, ptr, value);
+            });
+            size_ = count;
         } else {
-            data_[size_++] = value;
+            destroy(data_ + count, data_ + size_);
+            size_ = count;
         }
     }
 
-    void push_back(T&& value) {
-        if (size_ >= capacity_) {
-            reserve(calc_cap(size_ + 1));
-        }
-        data_[size_++] = std::move(value);
+    constexpr void push_back(const T& value) {
+        emplace_back(value);
     }
 
-    void pop_back() {
+    constexpr void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    constexpr void pop_back() {
         if (size_ > 0) {
             --size_;
-            data_[size_].~T();
+            alloc_traits::destroy(alloc_, data_ + size_);
         }
     }
 
     template <typename... Args>
-    T& emplace_back(Args&&... args) {
-        if (size_ >= capacity_) {
-            reserve(calc_cap(size_ + 1));
-        }
+    constexpr T& emplace_back(Args&&... args) {
+        emplace_at(size_, std::forward<Args>(args)...);
+        return data_[size_ - 1];
+    }
 
-        new (&data_[size_]) T(std::forward<Args>(args)...);
+    // Appending without the capacity check, for fill loops after a reserve():
+    // with no reallocation branch in the loop the compiler can vectorize it.
+    // size() must be less than capacity().
+    template <typename... Args>
+    constexpr T& emplace_back_unchecked(Args&&... args) {
+        alloc_traits::construct(alloc_, data_ + size_, std::forward<Args>(args)...);
         return data_[size_++];
     }
 
-    T* insert(const T* pos, const T& value) {
-        const size_t index = pos - begin();
-        if (index > size_) {
-            throw std::out_of_range("my_vector::insert: iterator out of range");
-        }
-
-        if (size_ >= capacity_) {
-            T value_copy = value;
-            size_t new_capacity = calc_cap(size_ + 1);
-            T* new_data = new T[new_capacity];
-
-            try {
-                for (size_t i = 0; i < index; ++i) {
-                    new_data[i] = std::move_if_noexcept(data_[i]);
-                }
-
-                new_data[index] = value_copy;
-
-                for (size_t i = index; i < size_; ++i) {
-                    new_data[i + 1] = std::move_if_noexcept(data_[i]);
-                }
-
-                delete[] data_;
-                data_ = new_data;
-                capacity_ = new_capacity;
-                size_++;
+    constexpr void push_back_unchecked(const T& value) {
+        emplace_back_unchecked(value);
+    }
 
-            } catch (...) {
-                delete[] new_data;
-                throw;
-            }
-        } else {
-            for (size_t i = size_; i > index; --i) {
-                data_[i] = std::move_if_noexcept(data_[i - 1]);
-            }
+    constexpr void push_back_unchecked(T&& value) {
+        emplace_back_unchecked(std::move(value));
+    }
 
-            data_[index] = value;
-            size_++;
+    template <typename... Args>
+    constexpr T* emplace(const T* pos, Args&&... args) {
+        const size_t index = pos - begin();
+        if (index > size_) {
+            throw std::out_of_range("my_vector::emplace: iterator out of range");
         }
 
+        emplace_at(index, std::forward<Args>(args)...);
         return begin() + index;
     }
 
-    T* insert(const T* pos, T&& value) {
+    constexpr T* insert(const T* pos, const T& value) {
         const size_t index = pos - begin();
         if (index > size_) {
             throw std::out_of_range("my_vector::insert: iterator out of range");
         }
 
-        if (size_ >= capacity_) {
-            size_t new_capacity = calc_cap(size_ + 1);
-            T* new_data = new T[new_capacity];
-
-            try {
-                for (size_t i = 0; i < index; ++i) {
-                    new_data[i] = std::move_if_noexcept(data_[i]);
-                }
-
-                new_data[index] = std::move(value);
-
-                for (size_t i = index; i < size_; ++i) {
-                    new_data[i + 1] = std::move_if_noexcept(data_[i]);
-                }
-
-                delete[] data_;
-                data_ = new_data;
-                capacity_ = new_capacity;
-                size_++;
-
-            } catch (...) {
-                delete[] new_data;
-                throw;
-            }
-        } else {
-            for (size_t i = size_; i > index; --i) {
-                data_[i] = std::move_if_noexcept(data_[i - 1]);
-            }
+        emplace_at(index, value);
+        return begin() + index;
+    }
 
-            data_[index] = std::move(value);
-            size_++;
+    constexpr T* insert(const T* pos, T&& value) {
+        const size_t index = pos - begin();
+        if (index > size_) {
+            throw std::out_of_range("my_vector::insert: iterator out of range");
         }
 
+        emplace_at(index, std::move(value));
         return begin() + index;
     }
 
     template <typename InputIt,
               typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
-    T* insert(const T* pos, InputIt first, InputIt last) {
+    constexpr T* insert(const T* pos, InputIt first, InputIt last) {
+        return insert_range(pos, std::ranges::subrange(first, last));
+    }
+
+    // Inserts the elements of a range before pos. Sized and forward ranges
+    // grow the storage at most once and are read in a single pass when
+    // std::ranges::size is available; input ranges are read exactly once.
+    // A contiguous range may refer to this vector's own elements.
+    template <std::ranges::input_range R>
+    constexpr T* insert_range(const T* pos, R&& range) {
         const size_t index = pos - begin();
         if (index > size_) {
-            throw std::out_of_range("my_vector::insert: iterator out of range");
-        }
-
-        size_t count = 0;
-        for (auto it = first; it != last; ++it) {
-            ++count;
+            throw std::out_of_range("my_vector::insert_range: iterator out of range");
         }
 
-        if (count == 0) {
-            return begin() + index;
-        }
-
-        if (size_ + count > capacity_) {
-            size_t new_capacity = calc_cap(size_ + count);
-            T* new_data = new T[new_capacity];
-
-            try {
-                for (size_t i = 0; i < index; ++i) {
-                    new_data[i] = std::move_if_noexcept(data_[i]);
-                }
-
-                size_t i = index;
-                for (auto it = first; it != last; ++it, ++i) {
-                    new_data[i] = *it;
-                }
-
-                for (size_t i = index; i < size_; ++i) {
-                    new_data[i + count] = std::move_if_noexcept(data_[i]);
-                }
-
-                delete[] data_;
-                data_ = new_data;
-                capacity_ = new_capacity;
-                size_ += count;
-
-            } catch (...) {
-                delete[] new_data;
-                throw;
-            }
+        if constexpr (std::ranges::forward_range<R>) {
+            insert_n(index, std::ranges::begin(range), static_cast<size_t>(std::ranges::distance(range)));
         } else {
-            for (size_t i = size_ - 1; i >= index && i < size_; --i) {
-                data_[i + count] = std::move_if_noexcept(data_[i]);
-            }
-
-            size_t i = index;
-            for (auto it = first; it != last; ++it, ++i) {
-                data_[i] = *it;
-            }
-
-            size_ += count;
+            insert_single_pass(index, std::forward<R>(range));
         }
-
         return begin() + index;
     }
 
-    T* erase(const T* pos) {
+    template <std::ranges::input_range R>
+    constexpr void append_range(R&& range) {
+        insert_range(end(), std::forward<R>(range));
+    }
+
+    // replaces the contents with the elements of range
+    template <std::ranges::input_range R>
+    constexpr void assign_range(R&& range) {
+        clear();
+        insert_range(end(), std::forward<R>(range));
+    }
+
+    constexpr T* erase(const T* pos) {
         return erase(pos, pos + 1);
     }
 
-    T* erase(const T* first, const T* last) {
+    constexpr T* erase(const T* first, const T* last) {
         const size_t start_index = first - begin();
         const size_t end_index = last - begin();
 
@@ -464,29 +819,99 @@ public:
         }
 
         const size_t count = end_index - start_index;
-        for (size_t i = end_index; i < size_; ++i) {
-            data_[i - count] = std::move_if_noexcept(data_[i]);
-        }
-
-        for (size_t i = size_ - count; i < size_; ++i) {
-            data_[i].~T();
+        if constexpr (is_trivially_relocatable_v<T>) {
+            destroy(data_ + start_index, data_ + end_index);
+            relocate_bytes(data_ + end_index, size_ - end_index, data_ + start_index);
+        } else {
+            std::move(data_ + end_index, data_ + size_, data_ + start_index);
+            destroy(data_ + size_ - count, data_ + size_);
         }
 
         size_ -= count;
         return begin() + start_index;
     }
 
-    void swap(my_vector& other) noexcept {
+    // Erases the elements at the given indices in one pass: each run of kept
+    // elements between two of them moves down once. The indices must be in
+    // increasing order, repeats are ignored; otherwise, or if one is out of
+    // range, throws std::out_of_range before changing anything. Returns the
+    // number of elements erased.
+    template <std::ranges::forward_range R>
+        requires std::integral<std::ranges::range_value_t<R>>
+    constexpr size_t erase_indices(R&& indices) {
+        size_t next = 0;
+        for (auto idx : indices) {
+            const size_t index = static_cast<size_t>(idx);
+            if (index >= size_ || index + 1 < next) {
+                throw std::out_of_range("my_vector::erase_indices: index out of range or unsorted");
+            }
+            next = index + 1;
+        }
+
+        size_t dst = 0;
+        size_t src = 0;
+        for (auto idx : indices) {
+            const size_t index = static_cast<size_t>(idx);
+            if (index < src) {
+                continue;
+            }
+            if constexpr (is_trivially_relocatable_v<T>) {
+                alloc_traits::destroy(alloc_, data_ + index);
+                relocate_bytes(data_ + src, index - src, data_ + dst);
+            } else {
+                std::move(data_ + src, data_ + index, data_ + dst);
+            }
+            dst += index - src;
+            src = index + 1;
+        }
+        if (src == 0) {
+            return 0;
+        }
+
+        if constexpr (is_trivially_relocatable_v<T>) {
+            relocate_bytes(data_ + src, size_ - src, data_ + dst);
+        } else {
+            std::move(data_ + src, data_ + size_, data_ + dst);
+            destroy(data_ + dst + size_ - src, data_ + size_);
+        }
+        const size_t erased = src - dst;
+        size_ -= erased;
+        return erased;
+    }
+
+    // Erases the element at pos by moving the last element into its place;
+    // O(1), but does not keep the order. Returns pos.
+    constexpr T* unstable_erase(const T* pos) {
+        const size_t index = pos - begin();
+        if (index >= size_) {
+            throw std::out_of_range("my_vector::unstable_erase: iterator out of range");
+        }
+
+        if (index != size_ - 1) {
+            data_[index] = std::move(data_[size_ - 1]);
+        }
+        pop_back();
+        return begin() + index;
+    }
+
+    constexpr void swap(my_vector& other) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
         std::swap(data_, other.data_);
         std::swap(size_, other.size_);
         std::swap(capacity_, other.capacity_);
     }
 
-    bool operator==(const my_vector& other) const {
+    constexpr bool operator==(const my_vector& other) const {
         if (size_ != other.size_) {
             return false;
         }
 
+        if constexpr (my_simd::is_vectorizable_v<T>) {
+            return my_simd::equal(data_, other.data_, size_);
+        }
+
         for (size_t i = 0; i < size_; ++i) {
             if (!(data_[i] == other.data_[i])) {
                 return false;
@@ -496,30 +921,57 @@ public:
         return true;
     }
 
-    bool operator!=(const my_vector& other) const {
+    constexpr bool operator!=(const my_vector& other) const {
         return !(*this == other);
     }
 
-    bool operator<(const my_vector& other) const {
+    constexpr bool operator<(const my_vector& other) const {
+        if constexpr (my_simd::is_vectorizable_v<T>) {
+            return my_simd::less(data_, size_, other.data_, other.size_);
+        }
         return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
     }
 
-    bool operator<=(const my_vector& other) const {
+    constexpr bool operator<=(const my_vector& other) const {
         return !(other < *this);
     }
 
-    bool operator>(const my_vector& other) const {
+    constexpr bool operator>(const my_vector& other) const {
         return other < *this;
     }
 
-    bool operator>=(const my_vector& other) const {
+    constexpr bool operator>=(const my_vector& other) const {
         return !(*this < other);
     }
 };
 
-template <typename T>
-void swap(my_vector<T>& lhs, my_vector<T>& rhs) noexcept {
+template <typename T, typename Allocator, typename GrowthPolicy>
+constexpr void swap(my_vector<T, Allocator, GrowthPolicy>& lhs, my_vector<T, Allocator, GrowthPolicy>& rhs) noexcept {
     lhs.swap(rhs);
 }
 
-#endif // MY_VECTOR_H
\ No newline at end of file
+// Remove the elements equal to value, or matching pred, in one pass, keeping
+// the order of the others; return how many were removed.
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename U>
+constexpr size_t erase(my_vector<T, Allocator, GrowthPolicy>& vec, const U& value) {
+    T* const first = std::remove(vec.begin(), vec.end(), value);
+    const size_t removed = vec.end() - first;
+    vec.erase(first, vec.end());
+    return removed;
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Pred>
+constexpr size_t erase_if(my_vector<T, Allocator, GrowthPolicy>& vec, Pred pred) {
+    T* const first = std::remove_if(vec.begin(), vec.end(), pred);
+    const size_t removed = vec.end() - first;
+    vec.erase(first, vec.end());
+    return removed;
+}
+
+namespace pmr {
+template <typename T>
+using my_vector = ::my_vector<T, std::pmr::polymorphic_allocator<T>>;
+}
+
+#endif // MY_VECTOR_H
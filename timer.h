@@ -18,9 +18,21 @@ inline std::chrono::high_resolution_clock::time_point get_current_time_fenced()
 }
 
 template<class D>
-inline long long to_us(const D &d)
+inline long long to_ms(const D &d)
 {
     return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
 }
 
+template<class D>
+inline long long to_us(const D &d)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+template<class D>
+inline long long to_ns(const D &d)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
 #endif // TIME_CHECK_INCLUDE
\ No newline at end of file